@@ -191,6 +191,8 @@ bool IconView::Create(void)
             this, SLOT( UpdateText(MythUIButtonListItem*)));
     connect(m_imageList, SIGNAL(itemSelected( MythUIButtonListItem*)),
             this, SLOT( UpdateImage(MythUIButtonListItem*)));
+    connect(m_imageList, SIGNAL(itemVisible( MythUIButtonListItem*)),
+            this, SLOT( PrioritizeThumbnail(MythUIButtonListItem*)));
 
     if (m_noImagesText)
     {
@@ -412,6 +414,17 @@ void IconView::UpdateText(MythUIButtonListItem *item)
     }
 }
 
+void IconView::PrioritizeThumbnail(MythUIButtonListItem *item)
+{
+    if (!m_thumbGen)
+        return;
+
+    // get the thumbnails on screen made ahead of the rest
+    ThumbItem *thumbitem = qVariantValue<ThumbItem *>(item->GetData());
+    if (thumbitem)
+        m_thumbGen->prioritizeFile(thumbitem->GetName());
+}
+
 void IconView::UpdateImage(MythUIButtonListItem *item)
 {
     if (!m_selectedImage)
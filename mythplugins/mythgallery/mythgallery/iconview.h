@@ -154,6 +154,7 @@ class IconView : public MythScreenType
     void HandleItemSelect(MythUIButtonListItem *);
     void UpdateText(MythUIButtonListItem *);
     void UpdateImage(MythUIButtonListItem *);
+    void PrioritizeThumbnail(MythUIButtonListItem *);
 
     friend class FileCopyThread;
 };
@@ -27,12 +27,16 @@
 #include <QEvent>
 #include <QImageReader>
 #include <QSet>
+#include <QRunnable>
+#include <QThread>
+#include <QTextStream>
 
 // myth
 #include <mythuihelper.h>
 #include <mythcontext.h>
 #include <mythdirs.h>
 #include <mthread.h>
+#include <mthreadpool.h>
 #include <mythdate.h>
 
 // mythgallery
@@ -56,16 +60,37 @@
 QEvent::Type ThumbGenEvent::kEventType =
     (QEvent::Type) QEvent::registerEventType();
 
+#define THUMB_INDEX_FILE ".thumbindex"
+
+/// Helps the generator thread work through the queue
+class ThumbGenWorker : public QRunnable
+{
+  public:
+    ThumbGenWorker(ThumbGenerator *generator) : m_generator(generator) {}
+
+    void run(void)
+    {
+        m_generator->processQueue();
+    }
+
+  private:
+    ThumbGenerator *m_generator;
+};
+
 ThumbGenerator::ThumbGenerator(QObject *parent, int w, int h) :
     MThread("ThumbGenerator"), m_parent(parent),
-    m_isGallery(false), m_width(w), m_height(h), m_cancel(false)
+    m_isGallery(false), m_width(w), m_height(h), m_cancel(false),
+    m_pool(new MThreadPool("ThumbGenerator")), m_indexChanged(false)
 {
+    // the generator thread is one of the workers
+    m_pool->setMaxThreadCount(qMax(QThread::idealThreadCount() - 1, 1));
 }
 
 ThumbGenerator::~ThumbGenerator()
 {
     cancel();
     wait();
+    delete m_pool;
 }
 
 void ThumbGenerator::setSize(int w, int h)
@@ -91,6 +116,17 @@ void ThumbGenerator::addFile(const QString& filePath)
     m_mutex.unlock();
 }
 
+void ThumbGenerator::prioritizeFile(const QString& fileName)
+{
+    // Move a file that has become visible to the head of the queue,
+    // if its thumbnail is still to be made.
+    m_mutex.lock();
+    int index = m_fileList.indexOf(fileName);
+    if (index > 0)
+        m_fileList.move(index, 0);
+    m_mutex.unlock();
+}
+
 void ThumbGenerator::cancel()
 {
     m_mutex.lock();
@@ -104,6 +140,22 @@ void ThumbGenerator::run()
     RunProlog();
 
     m_cancel = false;
+
+    for (int i = 0; i < m_pool->maxThreadCount(); ++i)
+        m_pool->start(new ThumbGenWorker(this), "ThumbGenWorker");
+
+    processQueue();
+    m_pool->waitForDone();
+
+    m_mutex.lock();
+    saveIndex();
+    m_mutex.unlock();
+
+    RunEpilog();
+}
+
+void ThumbGenerator::processQueue()
+{
     while (moreWork() && !m_cancel)
     {
         QString file, dir;
@@ -112,9 +164,8 @@ void ThumbGenerator::run()
         m_mutex.lock();
         dir       = m_directory;
         isGallery = m_isGallery;
-        file = m_fileList.first();
         if (!m_fileList.isEmpty())
-            m_fileList.pop_front();
+            file = m_fileList.takeFirst();
         m_mutex.unlock();
         if (file.isEmpty())
             continue;
@@ -134,13 +185,33 @@ void ThumbGenerator::run()
 
         if (!isGallery)
         {
-            QString cachePath = QString("%1%2.jpg").arg(getThumbcacheDir(dir))
-                                                   .arg(file);
+            uint modified = fileInfo.lastModified().toTime_t();
+
+            m_mutex.lock();
+            if (m_indexDir != dir)
+                loadIndex(dir);
+            QString cacheDir = m_cacheDir;
+            bool current = m_index.value(file) == modified;
+            m_mutex.unlock();
+
+            // the index says the thumbnail was made from this version
+            if (current)
+                continue;
+
+            QString cachePath = QString("%1%2.jpg").arg(cacheDir).arg(file);
             QFileInfo cacheInfo(cachePath);
 
             if (cacheInfo.exists() &&
                 cacheInfo.lastModified() >= fileInfo.lastModified())
             {
+                // made before there was an index
+                m_mutex.lock();
+                if (m_indexDir == dir)
+                {
+                    m_index[file] = modified;
+                    m_indexChanged = true;
+                }
+                m_mutex.unlock();
                 continue;
             }
             else
@@ -164,7 +235,7 @@ void ThumbGenerator::run()
                 if (GalleryUtil::IsMovie(fileInfo.filePath()))
                 {
                     QString screenshotPath = QString("%1%2-screenshot.jpg")
-                            .arg(getThumbcacheDir(dir))
+                            .arg(cacheDir)
                             .arg(file);
                     image.save(screenshotPath, "JPEG", 95);
                 }
@@ -173,6 +244,14 @@ void ThumbGenerator::run()
                                 Qt::KeepAspectRatio, Qt::SmoothTransformation);
                 image.save(cachePath, "JPEG", 95);
 
+                m_mutex.lock();
+                if (m_indexDir == dir)
+                {
+                    m_index[file] = modified;
+                    m_indexChanged = true;
+                }
+                m_mutex.unlock();
+
                 // deep copies all over
                 ThumbData *td = new ThumbData;
                 td->directory = dir;
@@ -185,8 +264,55 @@ void ThumbGenerator::run()
             }
         }
     }
+}
 
-    RunEpilog();
+/// Read the thumbnail index of a directory, m_mutex must be held
+void ThumbGenerator::loadIndex(const QString& directory)
+{
+    saveIndex();
+
+    m_index.clear();
+    m_indexDir = directory;
+    m_cacheDir = getThumbcacheDir(directory);
+
+    QFile file(m_cacheDir + THUMB_INDEX_FILE);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    // one "<source mtime> <file name>" line per thumbnail
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine();
+        int space = line.indexOf(' ');
+        if (space > 0)
+            m_index[line.mid(space + 1)] = line.left(space).toUInt();
+    }
+}
+
+/// Write out the thumbnail index if it has changed, m_mutex must be held
+void ThumbGenerator::saveIndex()
+{
+    if (!m_indexChanged || m_indexDir.isEmpty())
+        return;
+
+    m_indexChanged = false;
+
+    QFile file(m_cacheDir + THUMB_INDEX_FILE);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                   QIODevice::Text))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Unable to write thumbnail index: " +
+            file.fileName());
+        return;
+    }
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    QMap<QString, uint>::const_iterator it = m_index.begin();
+    for (; it != m_index.end(); ++it)
+        stream << it.value() << ' ' << it.key() << '\n';
 }
 
 bool ThumbGenerator::moreWork()
@@ -281,7 +407,7 @@ void ThumbGenerator::loadDir(QImage& image, const QFileInfo& fi)
 
 void ThumbGenerator::loadFile(QImage& image, const QFileInfo& fi)
 {
-    static int sequence = 0;
+    static QAtomicInt sequence(0);
 
     if (GalleryUtil::IsMovie(fi.filePath()))
     {
@@ -300,7 +426,7 @@ void ThumbGenerator::loadFile(QImage& image, const QFileInfo& fi)
         if (tmpDir.exists())
         {
             QString thumbFile = QString("%1.png")
-                .arg(++sequence,8,10,QChar('0'));
+                .arg(sequence.fetchAndAddOrdered(1) + 1,8,10,QChar('0'));
 
             QString cmd = "mythpreviewgen";
             QStringList args;
@@ -371,7 +497,17 @@ void ThumbGenerator::loadFile(QImage& image, const QFileInfo& fi)
         }
 #endif
 
-        image.load(fi.absoluteFilePath());
+        // Let the reader scale while decoding, for JPEGs this makes libjpeg
+        // decode at a fraction of the size rather than decoding it all
+        QImageReader reader(fi.absoluteFilePath());
+        QSize size = reader.size();
+        if (size.isValid() && m_width > 0 && m_height > 0 &&
+            (size.width() > m_width || size.height() > m_height))
+        {
+            reader.setScaledSize(size.scaled(m_width, m_height,
+                                             Qt::KeepAspectRatio));
+        }
+        reader.read(&image);
     }
 }
 
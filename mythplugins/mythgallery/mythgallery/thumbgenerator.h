@@ -24,11 +24,13 @@
 
 #include <QStringList>
 #include <QImage>
+#include <QMap>
 
 #include <mthread.h>
 
 class QObject;
 class QImage;
+class MThreadPool;
 
 typedef struct {
     QImage  thumb;
@@ -57,6 +59,7 @@ public:
     void setSize(int w, int h);
     void setDirectory(const QString& directory, bool isGallery=false);
     void addFile(const QString& fileName);
+    void prioritizeFile(const QString& fileName);
     void cancel();
 
     static QString getThumbcacheDir(const QString& inDir);
@@ -67,7 +70,12 @@ protected:
     
 private:
 
+    friend class ThumbGenWorker;
+
+    void processQueue();
     bool moreWork();
+    void loadIndex(const QString& directory);
+    void saveIndex();
     bool checkGalleryDir(const QFileInfo& fi);
     bool checkGalleryFile(const QFileInfo& fi);
     void loadDir(QImage& image, const QFileInfo& fi);
@@ -81,6 +89,15 @@ private:
     int          m_width;
     int          m_height;
     bool         m_cancel;
+
+    MThreadPool *m_pool;
+
+    // modification time of the source file each cached thumbnail was
+    // made from, for the directory in m_indexDir
+    QMap<QString, uint> m_index;
+    QString      m_indexDir;
+    QString      m_cacheDir;
+    bool         m_indexChanged;
 };
 
 #endif /* THUMBGENERATOR_H */
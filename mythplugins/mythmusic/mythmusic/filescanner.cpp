@@ -4,9 +4,13 @@
 // Qt headers
 #include <QApplication>
 #include <QDir>
+#include <QRunnable>
+#include <QThread>
 
 // MythTV headers
 #include <mythdate.h>
+#include <mthreadpool.h>
+#include <mythtimer.h>
 #include <mythdb.h>
 #include <mythcontext.h>
 #include <mythdialogs.h>
@@ -19,6 +23,57 @@
 #include "metadata.h"
 #include "metaio.h"
 
+/// Reads the tags of a single file on a pool thread, the database work for
+/// the result is left to the thread running the scan
+class MusicTagReader : public QRunnable
+{
+  public:
+    MusicTagReader(FileScanner *scanner, const QString &filename,
+                   quint64 size, bool update) :
+        m_scanner(scanner), m_filename(filename), m_size(size),
+        m_update(update) {}
+
+    void run(void)
+    {
+        FileScanner::TagReadResult result;
+        result.filename = m_filename;
+        result.data = NULL;
+        result.update = m_update;
+
+        Decoder *decoder = Decoder::create(m_filename, NULL, NULL, true);
+
+        if (decoder)
+        {
+            LOG(VB_FILE, LOG_INFO,
+                QString("Reading metadata from %1").arg(m_filename));
+            result.data = decoder->readMetadata();
+
+            if (result.data)
+            {
+                result.data->setFileSize(m_size);
+
+                // embedded images are only picked up for new tracks, use a
+                // tagger of our own as Metadata::getTagger() shares them
+                MetaIO *tagger = m_update ? NULL : decoder->doCreateTagger();
+                if (tagger && tagger->supportsEmbeddedImages())
+                    result.artList =
+                        tagger->getAlbumArtList(result.data->Filename());
+                delete tagger;
+            }
+
+            delete decoder;
+        }
+
+        m_scanner->TagsRead(result);
+    }
+
+  private:
+    FileScanner *m_scanner;
+    QString      m_filename;
+    quint64      m_size;
+    bool         m_update;
+};
+
 FileScanner::FileScanner() : m_decoder(NULL)
 {
     MSqlQuery query(MSqlQuery::InitCon());
@@ -62,6 +117,12 @@ FileScanner::FileScanner() : m_decoder(NULL)
             m_albumid[query.value(1).toString() + "#" + query.value(2).toString()] = query.value(0).toInt();
         }
     }
+
+    m_artFilter = gCoreContext->GetSetting("AlbumArtFilter",
+                                           "*.png;*.jpg;*.jpeg;*.gif;*.bmp");
+
+    // register the decoder factories here, before the tag readers race to
+    Decoder::all();
 }
 
 FileScanner::~FileScanner ()
@@ -143,6 +204,11 @@ void FileScanner::BuildFileList(QString &directory, MusicLoadedMap &music_files,
             }
 
             music_files[filename] = FileScanner::kFileSystem;
+
+            MusicFileStat stat;
+            stat.size = fi->size();
+            stat.modified = fi->lastModified();
+            m_filestats[filename] = stat;
         }
     }
 }
@@ -194,22 +260,42 @@ int FileScanner::GetDirectoryId(const QString &directory, const int &parentid)
 }
 
 /*!
- * \brief Check if file has been modified since given date/time
+ * \brief Check if file has been modified since given date/time, or
+ *        has a different size to the one recorded
+ *
+ * Uses the details seen by BuildFileList() where there are any, so
+ * that unchanged files are not stat'ed a second time.
  *
  * \param filename File to examine
  * \param date_modified Date to use in comparison
+ * \param size Size recorded for the file, 0 if unknown
  *
  * \returns True if file has been modified, otherwise false
  */
 bool FileScanner::HasFileChanged(
-    const QString &filename, const QString &date_modified)
+    const QString &filename, const QString &date_modified, quint64 size)
 {
-    QFileInfo fi(filename);
-    QDateTime dt = fi.lastModified();
+    QDateTime dt;
+    quint64 disk_size;
+
+    MusicFileStatMap::const_iterator it = m_filestats.find(filename);
+    if (it != m_filestats.end())
+    {
+        dt = (*it).modified;
+        disk_size = (*it).size;
+    }
+    else
+    {
+        QFileInfo fi(filename);
+        dt = fi.lastModified();
+        disk_size = fi.size();
+    }
+
     if (dt.isValid())
     {
         QDateTime old_dt = MythDate::fromString(date_modified);
-        return !old_dt.isValid() || (dt > old_dt);
+        return !old_dt.isValid() || (dt > old_dt) ||
+               (size > 0 && size != disk_size);
     }
     else
     {
@@ -220,106 +306,106 @@ bool FileScanner::HasFileChanged(
 }
 
 /*!
- * \brief Insert file details into database.
- *        If it is an audio file, read the metadata and insert
- *        that information at the same time.
+ * \brief Check if a file is an image, going by the AlbumArtFilter setting
  *
- *        If it is an image file, just insert the filename and
- *        type.
+ * \param filename Full path to file.
+ *
+ * \returns True if the file should be treated as album art
+ */
+bool FileScanner::IsArtwork(const QString &filename) const
+{
+    QString extension = filename.section( '.', -1 ) ;
+    return m_artFilter.indexOf(extension.toLower()) > -1;
+}
+
+/*!
+ * \brief Insert the details of an image file into the music_albumart table.
  *
  * \param filename Full path to file.
  *
  * \returns Nothing.
  */
-void FileScanner::AddFileToDB(const QString &filename)
+void FileScanner::AddArtworkToDB(const QString &filename)
 {
-    QString extension = filename.section( '.', -1 ) ;
     QString directory = filename;
     directory.remove(0, m_startdir.length());
     directory = directory.section( '/', 0, -2);
 
-    QString nameFilter = gCoreContext->GetSetting("AlbumArtFilter", "*.png;*.jpg;*.jpeg;*.gif;*.bmp");
-
-    // If this file is an image, insert the details into the music_albumart table
-    if (nameFilter.indexOf(extension.toLower()) > -1)
-    {
-        QString name = filename.section( '/', -1);
-
-        MSqlQuery query(MSqlQuery::InitCon());
-        query.prepare("INSERT INTO music_albumart SET filename = :FILE, "
-                      "directory_id = :DIRID, imagetype = :TYPE;");
-        query.bindValue(":FILE", name);
-        query.bindValue(":DIRID", m_directoryid[directory]);
-        query.bindValue(":TYPE", AlbumArtImages::guessImageType(name));
-
-        if (!query.exec() || query.numRowsAffected() <= 0)
-        {
-            MythDB::DBError("music insert artwork", query);
-        }
-        return;
-    }
+    QString name = filename.section( '/', -1);
 
-    Decoder *decoder = Decoder::create(filename, NULL, NULL, true);
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("INSERT INTO music_albumart SET filename = :FILE, "
+                  "directory_id = :DIRID, imagetype = :TYPE;");
+    query.bindValue(":FILE", name);
+    query.bindValue(":DIRID", m_directoryid[directory]);
+    query.bindValue(":TYPE", AlbumArtImages::guessImageType(name));
 
-    if (decoder)
+    if (!query.exec() || query.numRowsAffected() <= 0)
     {
-        LOG(VB_FILE, LOG_INFO,
-            QString("Reading metadata from %1").arg(filename));
-        Metadata *data = decoder->readMetadata();
-        data->setFileSize((quint64)QFileInfo(filename).size());
-        if (data)
-        {
-            QString album_cache_string;
+        MythDB::DBError("music insert artwork", query);
+    }
+}
 
-            // Set values from cache
-            int did = m_directoryid[directory];
-            if (did > 0)
-                data->setDirectoryId(did);
+/*!
+ * \brief Insert the metadata read from an audio file into the database,
+ *        along with any images that were embedded in its tag.
+ *
+ * \param filename Full path to file.
+ * \param data The metadata read from the file
+ * \param artList The images embedded in the tag
+ *
+ * \returns Nothing.
+ */
+void FileScanner::AddFileToDB(const QString &filename, Metadata *data,
+                              AlbumArtList &artList)
+{
+    QString directory = filename;
+    directory.remove(0, m_startdir.length());
+    directory = directory.section( '/', 0, -2);
 
-            int aid = m_artistid[data->Artist().toLower()];
-            if (aid > 0)
-            {
-                data->setArtistId(aid);
+    QString album_cache_string;
 
-                // The album cache depends on the artist id
-                album_cache_string = data->getArtistId() + "#"
-                    + data->Album().toLower();
+    // Set values from cache
+    int did = m_directoryid[directory];
+    if (did > 0)
+        data->setDirectoryId(did);
 
-                if (m_albumid[album_cache_string] > 0)
-                    data->setAlbumId(m_albumid[album_cache_string]);
-            }
+    int aid = m_artistid[data->Artist().toLower()];
+    if (aid > 0)
+    {
+        data->setArtistId(aid);
 
-            int gid = m_genreid[data->Genre().toLower()];
-            if (gid > 0)
-                data->setGenreId(gid);
+        // The album cache depends on the artist id
+        album_cache_string = data->getArtistId() + "#"
+            + data->Album().toLower();
 
-            // Commit track info to database
-            data->dumpToDatabase();
+        if (m_albumid[album_cache_string] > 0)
+            data->setAlbumId(m_albumid[album_cache_string]);
+    }
 
-            // Update the cache
-            m_artistid[data->Artist().toLower()] =
-                data->getArtistId();
+    int gid = m_genreid[data->Genre().toLower()];
+    if (gid > 0)
+        data->setGenreId(gid);
 
-            m_genreid[data->Genre().toLower()] =
-                data->getGenreId();
+    // Commit track info to database
+    data->dumpToDatabase();
 
-            album_cache_string = data->getArtistId() + "#"
-                + data->Album().toLower();
-            m_albumid[album_cache_string] = data->getAlbumId();
+    // Update the cache
+    m_artistid[data->Artist().toLower()] =
+        data->getArtistId();
 
-            // read any embedded images from the tag
-            MetaIO *tagger = data->getTagger();
-            if (tagger && tagger->supportsEmbeddedImages())
-            {
-                AlbumArtList artList = tagger->getAlbumArtList(data->Filename());
-                data->setEmbeddedAlbumArt(artList);
-                data->getAlbumArtImages()->dumpToDatabase();
-            }
+    m_genreid[data->Genre().toLower()] =
+        data->getGenreId();
 
-            delete data;
-        }
+    album_cache_string = data->getArtistId() + "#"
+        + data->Album().toLower();
+    m_albumid[album_cache_string] = data->getAlbumId();
 
-        delete decoder;
+    // store any images embedded in the tag
+    if (!artList.isEmpty())
+    {
+        data->setEmbeddedAlbumArt(artList);
+        data->getAlbumArtImages()->dumpToDatabase();
     }
 }
 
@@ -444,10 +530,7 @@ void FileScanner::RemoveFileFromDB (const QString &filename)
 
     QString extension = sqlfilename.section( '.', -1 ) ;
 
-    QString nameFilter = gCoreContext->GetSetting("AlbumArtFilter",
-                                              "*.png;*.jpg;*.jpeg;*.gif;*.bmp");
-
-    if (nameFilter.indexOf(extension) > -1)
+    if (m_artFilter.indexOf(extension) > -1)
     {
         MSqlQuery query(MSqlQuery::InitCon());
         query.prepare("DELETE FROM music_albumart WHERE filename= :FILE AND "
@@ -470,90 +553,226 @@ void FileScanner::RemoveFileFromDB (const QString &filename)
                         query);
 }
 
+/*!
+ * \brief Removes a list of music files from the database, with one query
+ *        per batch of files rather than one per file.
+ *
+ * \param filenames Full paths to the files.
+ *
+ * \returns Nothing.
+ */
+void FileScanner::RemoveFilesFromDB(const QStringList &filenames)
+{
+    static const int kBatchSize = 500;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    for (int start = 0; start < filenames.size(); start += kBatchSize)
+    {
+        int count = qMin(kBatchSize, filenames.size() - start);
+
+        QStringList names;
+        for (int i = 0; i < count; ++i)
+            names << QString(":NAME%1").arg(i);
+
+        query.prepare(QString("DELETE FROM music_songs WHERE filename IN (%1);")
+                      .arg(names.join(",")));
+        for (int i = 0; i < count; ++i)
+            query.bindValue(names[i], filenames[start + i].section('/', -1));
+
+        if (!query.exec())
+            MythDB::DBError("FileScanner::RemoveFilesFromDB - "
+                            "deleting music_songs", query);
+    }
+}
+
 /*!
  * \brief Updates a file in the database.
  *
  * \param filename Full path to file.
+ * \param disk_meta The metadata read from the file
  *
  * \returns Nothing.
  */
-void FileScanner::UpdateFileInDB(const QString &filename)
+void FileScanner::UpdateFileInDB(const QString &filename, Metadata *disk_meta)
 {
     QString directory = filename;
     directory.remove(0, m_startdir.length());
     directory = directory.section( '/', 0, -2);
 
-    Decoder *decoder = Decoder::create(filename, NULL, NULL, true);
+    Metadata db_meta(filename);
 
-    if (decoder)
+    if (!db_meta.isInDatabase() || db_meta.ID() <= 0)
     {
-        Metadata *db_meta   = decoder->getMetadata();
-        Metadata *disk_meta = decoder->readMetadata();
+        LOG(VB_GENERAL, LOG_ERR, QString("Asked to update track with "
+                                         "invalid ID - %1")
+                                        .arg(db_meta.ID()));
+        return;
+    }
 
-        if (db_meta && disk_meta)
-        {
-            if (db_meta->ID() <= 0)
-            {
-                LOG(VB_GENERAL, LOG_ERR, QString("Asked to update track with "
-                                                 "invalid ID - %1")
-                                                .arg(db_meta->ID()));
-                delete disk_meta;
-                delete db_meta;
-                return;
-            }
-            
-            disk_meta->setID(db_meta->ID());
-            disk_meta->setRating(db_meta->Rating());
-            if (db_meta->PlayCount() > disk_meta->PlayCount())
-                disk_meta->setPlaycount(db_meta->Playcount());
+    disk_meta->setID(db_meta.ID());
+    disk_meta->setRating(db_meta.Rating());
+    if (db_meta.PlayCount() > disk_meta->PlayCount())
+        disk_meta->setPlaycount(db_meta.Playcount());
 
-            QString album_cache_string;
+    QString album_cache_string;
 
-            // Set values from cache
-            int did = m_directoryid[directory];
-            if (did > 0)
-                disk_meta->setDirectoryId(did);
+    // Set values from cache
+    int did = m_directoryid[directory];
+    if (did > 0)
+        disk_meta->setDirectoryId(did);
 
-            int aid = m_artistid[disk_meta->Artist().toLower()];
-            if (aid > 0)
-            {
-                disk_meta->setArtistId(aid);
+    int aid = m_artistid[disk_meta->Artist().toLower()];
+    if (aid > 0)
+    {
+        disk_meta->setArtistId(aid);
 
-                // The album cache depends on the artist id
-                album_cache_string = disk_meta->getArtistId() + "#" +
-                    disk_meta->Album().toLower();
+        // The album cache depends on the artist id
+        album_cache_string = disk_meta->getArtistId() + "#" +
+            disk_meta->Album().toLower();
 
-                if (m_albumid[album_cache_string] > 0)
-                    disk_meta->setAlbumId(m_albumid[album_cache_string]);
-            }
+        if (m_albumid[album_cache_string] > 0)
+            disk_meta->setAlbumId(m_albumid[album_cache_string]);
+    }
+
+    int gid = m_genreid[disk_meta->Genre().toLower()];
+    if (gid > 0)
+        disk_meta->setGenreId(gid);
+
+    // Commit track info to database
+    disk_meta->dumpToDatabase();
+
+    // Update the cache
+    m_artistid[disk_meta->Artist().toLower()]
+        = disk_meta->getArtistId();
+    m_genreid[disk_meta->Genre().toLower()]
+        = disk_meta->getGenreId();
+    album_cache_string = disk_meta->getArtistId() + "#" +
+        disk_meta->Album().toLower();
+    m_albumid[album_cache_string] = disk_meta->getAlbumId();
+}
+
+/*!
+ * \brief Called by the tag reader threads as each file has been read.
+ *
+ * \param result The tags read, ownership passes to the scanner
+ *
+ * \returns Nothing.
+ */
+void FileScanner::TagsRead(const TagReadResult &result)
+{
+    QMutexLocker locker(&m_resultsLock);
+    m_results.append(result);
+    m_resultsWait.wakeAll();
+}
+
+/*!
+ * \brief Read the tags of the given files on a pool of threads and store
+ *        them in the database as they come in.
+ *
+ *        The tags are read in parallel, which is where the time goes on
+ *        network shares, while all the database work stays on this thread.
+ *        Only a bounded number of reads is queued at a time so the results
+ *        cannot pile up faster than they are written.
+ *
+ * \param added Full paths of files new to the database
+ * \param updated Full paths of files that have changed since they were
+ *        last read
+ *
+ * \returns Nothing.
+ */
+void FileScanner::ReadAndStoreTags(const QStringList &added,
+                                   const QStringList &updated)
+{
+    int total = added.size() + updated.size();
+    if (total == 0)
+        return;
 
-            int gid = m_genreid[disk_meta->Genre().toLower()];
-            if (gid > 0)
-                disk_meta->setGenreId(gid);
-
-            disk_meta->setFileSize((quint64)QFileInfo(filename).size());
-            
-            // Commit track info to database
-            disk_meta->dumpToDatabase();
-
-            // Update the cache
-            m_artistid[disk_meta->Artist().toLower()]
-                = disk_meta->getArtistId();
-            m_genreid[disk_meta->Genre().toLower()]
-                = disk_meta->getGenreId();
-            album_cache_string = disk_meta->getArtistId() + "#" +
-                disk_meta->Album().toLower();
-            m_albumid[album_cache_string] = disk_meta->getAlbumId();
+    MythScreenStack *popupStack = GetMythMainWindow()->GetStack("popup stack");
+
+    QString message = QObject::tr("Reading music file tags");
+    MythUIProgressDialog *file_checking = new MythUIProgressDialog(message,
+                                                    popupStack,
+                                                    "scalingprogressdialog");
+
+    if (file_checking->Create())
+    {
+        popupStack->AddScreen(file_checking, false);
+        file_checking->SetTotal(total);
+    }
+    else
+    {
+        delete file_checking;
+        file_checking = NULL;
+    }
+
+    int threads = qMax(QThread::idealThreadCount(), 2);
+    int max_queued = threads * 4;
+
+    MThreadPool pool("MusicTagReader");
+    pool.setMaxThreadCount(threads);
+
+    MythTimer timer;
+    timer.start();
+
+    int next = 0, queued = 0, done = 0;
+    while (done < total)
+    {
+        while (next < total && queued < max_queued)
+        {
+            bool update = next >= added.size();
+            const QString &filename =
+                update ? updated[next - added.size()] : added[next];
+            pool.start(new MusicTagReader(this, filename,
+                                          m_filestats.value(filename).size,
+                                          update),
+                       "MusicTagReader");
+            ++next;
+            ++queued;
         }
 
-        if (disk_meta)
-            delete disk_meta;
+        m_resultsLock.lock();
+        if (m_results.isEmpty())
+            m_resultsWait.wait(&m_resultsLock, 100);
+        QList<TagReadResult> results = m_results;
+        m_results.clear();
+        m_resultsLock.unlock();
+
+        QList<TagReadResult>::iterator it = results.begin();
+        for (; it != results.end(); ++it)
+        {
+            if ((*it).data)
+            {
+                if ((*it).update)
+                    UpdateFileInDB((*it).filename, (*it).data);
+                else
+                    AddFileToDB((*it).filename, (*it).data, (*it).artList);
+            }
+
+            delete (*it).data;
+            while (!(*it).artList.isEmpty())
+                delete (*it).artList.takeFirst();
 
-        if (db_meta)
-            delete db_meta;
+            --queued;
+            ++done;
+        }
 
-        delete decoder;
+        if (file_checking)
+            file_checking->SetProgress(done);
+        qApp->processEvents();
     }
+
+    pool.waitForDone();
+
+    if (file_checking)
+        file_checking->Close();
+
+    int elapsed = qMax(timer.elapsed(), 1);
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Read tags of %1 music files in %2 seconds (%3 files/s) "
+                "using %4 threads")
+            .arg(total).arg(elapsed / 1000.0, 0, 'f', 1)
+            .arg(total * 1000.0 / elapsed, 0, 'f', 1).arg(threads));
 }
 
 /*!
@@ -569,6 +788,7 @@ void FileScanner::SearchDir(QString &directory)
 {
 
     m_startdir = directory;
+    m_filestats.clear();
 
     MusicLoadedMap music_files;
     MusicLoadedMap::Iterator iter;
@@ -593,53 +813,45 @@ void FileScanner::SearchDir(QString &directory)
     ScanMusic(music_files);
     ScanArtwork(music_files);
 
-    message = QObject::tr("Updating music database");
-    MythUIProgressDialog *file_checking = new MythUIProgressDialog(message,
-                                                    popupStack,
-                                                    "scalingprogressdialog");
+    QStringList added, updated, removed;
+    uint artwork = 0;
 
-    if (file_checking->Create())
-    {
-        popupStack->AddScreen(file_checking, false);
-        file_checking->SetTotal(music_files.size());
-    }
-    else
-    {
-        delete file_checking;
-        file_checking = NULL;
-    }
-
-     /*
-       This can be optimised quite a bit by consolidating all commands
-       via a lot of refactoring.
-
-       1) group all files of the same decoder type, and don't
-       create/delete a Decoder pr. AddFileToDB. Or make Decoders be
-       singletons, it should be a fairly simple change.
-
-       2) RemoveFileFromDB should group the remove into one big SQL.
-
-       3) UpdateFileInDB, same as 1.
-     */
-
-    uint counter = 0;
     for (iter = music_files.begin(); iter != music_files.end(); iter++)
     {
+        const QString &filename = iter.key();
+
         if (*iter == FileScanner::kFileSystem)
-            AddFileToDB(iter.key());
+        {
+            if (IsArtwork(filename))
+            {
+                AddArtworkToDB(filename);
+                artwork++;
+            }
+            else
+                added.append(filename);
+        }
         else if (*iter == FileScanner::kDatabase)
-            RemoveFileFromDB(iter.key ());
-        else if (*iter == FileScanner::kNeedUpdate)
-            UpdateFileInDB(iter.key());
-
-        if (file_checking)
         {
-            file_checking->SetProgress(++counter);
-            qApp->processEvents();
+            if (m_artFilter.indexOf(filename.section('.', -1)) > -1)
+            {
+                RemoveFileFromDB(filename);
+                artwork++;
+            }
+            else
+                removed.append(filename);
         }
+        else if (*iter == FileScanner::kNeedUpdate)
+            updated.append(filename);
     }
-    if (file_checking)
-        file_checking->Close();
+
+    RemoveFilesFromDB(removed);
+    ReadAndStoreTags(added, updated);
+
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Music scan of %1 files: %2 new, %3 changed, %4 removed, "
+                "%5 artwork changes, the rest unchanged")
+            .arg(m_filestats.size()).arg(added.size()).arg(updated.size())
+            .arg(removed.size()).arg(artwork));
 
     // Cleanup orphaned entries from the database
     cleanDB();
@@ -657,8 +869,8 @@ void FileScanner::ScanMusic(MusicLoadedMap &music_files)
     MusicLoadedMap::Iterator iter;
 
     MSqlQuery query(MSqlQuery::InitCon());
-    if (!query.exec("SELECT CONCAT_WS('/', path, filename), date_modified "
-                    "FROM music_songs LEFT JOIN music_directories ON "
+    if (!query.exec("SELECT CONCAT_WS('/', path, filename), date_modified, "
+                    "size FROM music_songs LEFT JOIN music_directories ON "
                     "music_songs.directory_id=music_directories.directory_id "
                     "WHERE filename NOT LIKE ('%://%')"))
         MythDB::DBError("FileScanner::ScanMusic", query);
@@ -704,7 +916,8 @@ void FileScanner::ScanMusic(MusicLoadedMap &music_files)
                         }
                         continue;
                     }
-                    else if (HasFileChanged(name, query.value(1).toString()))
+                    else if (HasFileChanged(name, query.value(1).toString(),
+                                            query.value(2).toULongLong()))
                         music_files[name] = FileScanner::kNeedUpdate;
                     else
                         music_files.erase(iter);
@@ -1,8 +1,16 @@
 #ifndef _FILESCANNER_H_
 #define _FILESCANNER_H_
 
+#include <QMap>
+#include <QList>
+#include <QDateTime>
+#include <QStringList>
+#include <QMutex>
+#include <QWaitCondition>
+
 class Metadata;
 class Decoder;
+class AlbumArtImage;
 
 typedef QMap<QString, int> IdCache;
 
@@ -17,29 +25,64 @@ class FileScanner
     };
 
     typedef QMap <QString, MusicFileLocation> MusicLoadedMap;
+
+    /// Size and modification time seen for a file when the directory
+    /// was listed, so the unchanged check does not have to stat it again
+    struct MusicFileStat
+    {
+        quint64   size;
+        QDateTime modified;
+    };
+    typedef QMap <QString, MusicFileStat> MusicFileStatMap;
+
     public:
+        /// Tags read from a file by a tag reader thread
+        struct TagReadResult
+        {
+            QString                filename;
+            Metadata              *data;
+            QList<AlbumArtImage*>  artList;
+            bool                   update;
+        };
+
         FileScanner ();
         ~FileScanner ();
 
         void SearchDir(QString &directory);
 
+        void TagsRead(const TagReadResult &result);
+
     private:
         void BuildFileList(QString &directory, MusicLoadedMap &music_files, int parentid);
         int  GetDirectoryId(const QString &directory, const int &parentid);
-        bool HasFileChanged(const QString &filename, const QString &date_modified);
-        void AddFileToDB(const QString &filename);
+        bool HasFileChanged(const QString &filename, const QString &date_modified,
+                            quint64 size);
+        bool IsArtwork(const QString &filename) const;
+        void AddArtworkToDB(const QString &filename);
+        void AddFileToDB(const QString &filename, Metadata *data,
+                         QList<AlbumArtImage*> &artList);
         void RemoveFileFromDB (const QString &filename);
-        void UpdateFileInDB(const QString &filename);
+        void RemoveFilesFromDB(const QStringList &filenames);
+        void UpdateFileInDB(const QString &filename, Metadata *disk_meta);
+        void ReadAndStoreTags(const QStringList &added,
+                              const QStringList &updated);
         void ScanMusic(MusicLoadedMap &music_files);
         void ScanArtwork(MusicLoadedMap &music_files);
         void cleanDB();
 
         QString  m_startdir;
+        QString  m_artFilter;
         IdCache  m_directoryid;
         IdCache  m_artistid;
         IdCache  m_genreid;
         IdCache  m_albumid;
 
+        MusicFileStatMap m_filestats;
+
+        QMutex                m_resultsLock;
+        QWaitCondition        m_resultsWait;
+        QList<TagReadResult>  m_results;
+
         Decoder *m_decoder;
 };
 
@@ -50,7 +50,11 @@ Metadata* MetaIOAVFComment::read(const QString &filename)
         return NULL;
     }
 
-    if (avformat_find_stream_info(p_context, NULL) < 0)
+    // opens the codecs, which has to be serialised with other threads
+    avcodeclock->lock();
+    int ret = avformat_find_stream_info(p_context, NULL);
+    avcodeclock->unlock();
+    if (ret < 0)
         return NULL;
 
     AVDictionaryEntry *tag = av_dict_get(p_context->metadata, "title", NULL, 0);
@@ -115,7 +119,10 @@ int MetaIOAVFComment::getTrackLength(const QString &filename)
         return 0;
     }
 
-    if (avformat_find_stream_info(p_context, NULL) < 0)
+    avcodeclock->lock();
+    int ret = avformat_find_stream_info(p_context, NULL);
+    avcodeclock->unlock();
+    if (ret < 0)
         return 0;
 
     int rv = getTrackLength(p_context);
@@ -95,7 +95,11 @@ Metadata* MetaIOMP4::read(const QString &filename)
         return NULL;
     }
 
-    if (avformat_find_stream_info(p_context, NULL) < 0)
+    // opens the codecs, which has to be serialised with other threads
+    avcodeclock->lock();
+    int ret = avformat_find_stream_info(p_context, NULL);
+    avcodeclock->unlock();
+    if (ret < 0)
         return NULL;
 
 #if 0
@@ -191,7 +195,10 @@ int MetaIOMP4::getTrackLength(const QString &filename)
         return 0;
     }
 
-    if (avformat_find_stream_info(p_context, NULL) < 0)
+    avcodeclock->lock();
+    int ret = avformat_find_stream_info(p_context, NULL);
+    avcodeclock->unlock();
+    if (ret < 0)
         return 0;
 
     int rv = getTrackLength(p_context);
@@ -27,6 +27,7 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <errno.h>
 
 #include "zmserver.h"
 
@@ -36,6 +37,9 @@
 // default location of zoneminders config file
 #define ZM_CONFIG "/etc/zm.conf"
 
+// how often to look for new frames for live frame subscribers, in usecs
+#define LIVE_FRAME_POLL 40000
+
 // Care should be taken to keep these in sync with the exit codes in
 // libmythbase/exitcodes.h (which is not included here to keep this code 
 // separate from mythtv libraries).
@@ -47,10 +51,26 @@
 
 using namespace std;
 
+static void closeConnection(int fd, fd_set &master,
+                            map<int, ZMServer*> &serverList)
+{
+    close(fd);
+
+    // remove from master set
+    FD_CLR(fd, &master);
+
+    // remove from server list
+    ZMServer *server = serverList[fd];
+    if (server)
+        delete server;
+    serverList.erase(fd);
+}
+
 int main(int argc, char **argv)
 {
     fd_set master;                  // master file descriptor list
     fd_set read_fds;                // temp file descriptor list for select()
+    fd_set write_fds;               // clients with output still to send
     struct sockaddr_in myaddr;      // server address
     struct sockaddr_in remoteaddr;  // client address
     struct timeval timeout;         // maximum time to wait for data
@@ -215,6 +235,7 @@ int main(int argc, char **argv)
     // clear the master and temp sets
     FD_ZERO(&master);
     FD_ZERO(&read_fds);
+    FD_ZERO(&write_fds);
 
     // get the listener
     if ((listener = socket(AF_INET, SOCK_STREAM, 0)) == -1)
@@ -260,23 +281,68 @@ int main(int argc, char **argv)
     // main loop
     while (!quit)
     {
+        // does anyone want live frames pushed to them, and is anyone
+        // still waiting to be sent something?
+        bool liveFrames = false;
+        FD_ZERO(&write_fds);
+        map<int, ZMServer*>::iterator it = serverList.begin();
+        for (; it != serverList.end(); ++it)
+        {
+            if (!it->second)
+                continue;
+            if (it->second->hasLiveSubscriptions())
+                liveFrames = true;
+            if (it->second->hasPendingOutput())
+                FD_SET(it->first, &write_fds);
+        }
+
         // the maximum time select() should wait
-        timeout.tv_sec = DB_CHECK_TIME;
-        timeout.tv_usec = 0;
+        if (liveFrames)
+        {
+            timeout.tv_sec = 0;
+            timeout.tv_usec = LIVE_FRAME_POLL;
+        }
+        else
+        {
+            timeout.tv_sec = DB_CHECK_TIME;
+            timeout.tv_usec = 0;
+        }
 
         read_fds = master; // copy it
-        res = select(fdmax+1, &read_fds, NULL, NULL, &timeout);
+        res = select(fdmax+1, &read_fds, &write_fds, NULL, &timeout);
 
         if (res == -1)
         {
+            if (errno == EINTR)
+                continue;
             perror("select");
             return EXIT_SOCKET_ERROR;
         }
-        else if (res == 0)
+
+        // send whatever we can to the clients that were held up
+        for (i = 0; i <= fdmax && res > 0; i++)
+        {
+            if (FD_ISSET(i, &write_fds) && !serverList[i]->flushOutput())
+            {
+                perror("send");
+                closeConnection(i, master, serverList);
+                FD_CLR(i, &read_fds);
+            }
+        }
+
+        if (liveFrames)
+        {
+            for (it = serverList.begin(); it != serverList.end(); ++it)
+                if (it->second && it->second->hasLiveSubscriptions())
+                    it->second->sendLiveFrames();
+        }
+
+        if (res == 0)
         {
             // select timed out
             // just kick the DB connection to keep it alive
-            kickDatabase(debug);
+            if (time(NULL) - g_lastDBKick >= DB_CHECK_TIME)
+                kickDatabase(debug);
             continue;
         }
 
@@ -318,6 +384,13 @@ int main(int argc, char **argv)
                     // handle data from a client
                     if ((nbytes = recv(i, buf, sizeof(buf), 0)) <= 0)
                     {
+                        // the socket is non-blocking, so there may be
+                        // nothing to read after all
+                        if (nbytes == -1 &&
+                            (errno == EINTR || errno == EAGAIN ||
+                             errno == EWOULDBLOCK))
+                            continue;
+
                         // got error or connection closed by client
                         if (nbytes == 0)
                         {
@@ -329,16 +402,7 @@ int main(int argc, char **argv)
                             perror("recv");
                         }
 
-                        close(i);
-
-                        // remove from master set
-                        FD_CLR(i, &master);
-
-                        // remove from server list
-                        ZMServer *server = serverList[i];
-                        if (server)
-                            delete server;
-                        serverList.erase(i);
+                        closeConnection(i, master, serverList);
                     }
                     else
                     {
@@ -15,6 +15,7 @@
 
 
 #include <iostream>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -25,6 +26,7 @@
 #include <sys/stat.h>
 #include <sys/shm.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 
 #ifdef linux
 #  include <sys/vfs.h>
@@ -54,6 +56,12 @@
 // the maximum image size we are ever likely to get from ZM
 #define MAX_IMAGE_SIZE  (2048*1536*3)
 
+// the largest downscale a live frame subscription can ask for
+#define MAX_LIVE_SCALE  8
+
+// the most unsent output we will hold for a client before giving up on it
+#define MAX_OUTPUT_SIZE (MAX_IMAGE_SIZE * 2)
+
 #define ADD_STR(list,s)  list += s; list += "[]:[]";
 
 // error messages
@@ -66,6 +74,17 @@
 #define ERROR_INVALID_MONITOR_FUNCTION  "Invalid Monitor Function"
 #define ERROR_INVALID_MONITOR_ENABLE_VALUE "Invalid Monitor Enable Value"
 
+// Downscaled live frames are made once per captured frame and shared by
+// every client watching that monitor at that scale
+typedef struct
+{
+    int index;
+    time_t time;
+    vector<unsigned char> data;
+} SCALED_FRAME;
+
+static map<pair<int, int>, SCALED_FRAME> s_scaledFrames;
+
 MYSQL   g_dbConn;
 string  g_zmversion = "";
 string  g_password = "";
@@ -205,6 +224,13 @@ ZMServer::ZMServer(int sock, bool debug)
 
     m_sock = sock;
     m_debug = debug;
+    m_outPos = 0;
+
+    // we never block writing to a client, anything that can't be sent
+    // straight away is queued until the socket is writable again
+    int flags = fcntl(m_sock, F_GETFL, 0);
+    if (flags == -1 || fcntl(m_sock, F_SETFL, flags | O_NONBLOCK) == -1)
+        cout << "Failed to make socket " << m_sock << " non-blocking\n";
 
     // get the shared memory key
     char buf[100];
@@ -318,6 +344,10 @@ void ZMServer::processRequest(char* buf, int nbytes)
         handleGetAnalyseFrame(tokens);
     else if (tokens[0] == "GET_LIVE_FRAME")
         handleGetLiveFrame(tokens);
+    else if (tokens[0] == "SUBSCRIBE_LIVE_FRAMES")
+        handleSubscribeLiveFrames(tokens);
+    else if (tokens[0] == "UNSUBSCRIBE_LIVE_FRAMES")
+        handleUnsubscribeLiveFrames(tokens);
     else if (tokens[0] == "GET_FRAME_LIST")
         handleGetFrameList(tokens);
     else if (tokens[0] == "GET_CAMERA_LIST")
@@ -336,43 +366,117 @@ void ZMServer::processRequest(char* buf, int nbytes)
         send("UNKNOWN_COMMAND");
 }
 
-bool ZMServer::send(const string s) const
+bool ZMServer::send(const string s)
 {
-    // send length
-    uint32_t len = s.size();
+    // send length and message with one write
     char buf[9];
-    sprintf(buf, "%8d", len);
-    int status = ::send(m_sock, buf, 8, MSG_NOSIGNAL);
-    if (status == -1)
-        return false;
+    sprintf(buf, "%8d", (int)s.size());
 
-    // send message
-    status = ::send(m_sock, s.c_str(), s.size(), MSG_NOSIGNAL);
-    if ( status == -1 )
-        return false;
-    else
-        return true;
+    struct iovec iov[2];
+    iov[0].iov_base = buf;
+    iov[0].iov_len = 8;
+    iov[1].iov_base = (void*) s.c_str();
+    iov[1].iov_len = s.size();
+
+    return sendv(iov, 2);
 }
 
-bool ZMServer::send(const string s, const unsigned char *buffer, int dataLen) const
+bool ZMServer::send(const string s, const unsigned char *buffer, int dataLen)
 {
-    // send length
-    uint32_t len = s.size();
+    // send length, message and data with one write, the data is sent
+    // from where it is rather than being copied in after the message
     char buf[9];
-    sprintf(buf, "%8d", len);
-    int status = ::send(m_sock, buf, 8, MSG_NOSIGNAL);
-    if (status == -1)
-        return false;
+    sprintf(buf, "%8d", (int)s.size());
 
-    // send message
-    status = ::send(m_sock, s.c_str(), s.size(), MSG_NOSIGNAL);
-    if ( status == -1 )
-        return false;
+    struct iovec iov[3];
+    iov[0].iov_base = buf;
+    iov[0].iov_len = 8;
+    iov[1].iov_base = (void*) s.c_str();
+    iov[1].iov_len = s.size();
+    iov[2].iov_base = (void*) buffer;
+    iov[2].iov_len = dataLen;
+
+    return sendv(iov, 3);
+}
 
-    // send data
-    status = ::send(m_sock, buffer, dataLen, MSG_NOSIGNAL);
-    if ( status == -1 )
+bool ZMServer::sendv(struct iovec *iov, int iovcnt)
+{
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++)
+        total += iov[i].iov_len;
+
+    // a client that stops reading must not hold up everyone else, so
+    // once too much is queued for it drop the connection, shutting it
+    // down makes the main loop see it as hung up and tidy up
+    if (m_outBuf.size() - m_outPos + total > MAX_OUTPUT_SIZE)
+    {
+        cout << "Too much unsent data for socket " << m_sock
+             << ", closing the connection" << endl;
+        shutdown(m_sock, SHUT_RDWR);
         return false;
+    }
+
+    // send what we can straight away, but only if nothing is already
+    // queued or the messages would be sent out of order
+    while (m_outPos == m_outBuf.size() && iovcnt > 0)
+    {
+        ssize_t status = writev(m_sock, iov, iovcnt);
+        if (status == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return false;
+        }
+
+        // writev() may stop part way through, so step past whatever
+        // it managed to send
+        while (iovcnt > 0 && (size_t) status >= iov->iov_len)
+        {
+            status -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (char*) iov->iov_base + status;
+            iov->iov_len -= status;
+        }
+    }
+
+    // queue the rest for flushOutput()
+    for (int i = 0; i < iovcnt; i++)
+        m_outBuf.append((const char*) iov[i].iov_base, iov[i].iov_len);
+
+    return true;
+}
+
+/*
+ * Called from the main loop when the socket is writable to send
+ * whatever is still queued. Returns false if the connection has failed.
+ */
+bool ZMServer::flushOutput(void)
+{
+    while (m_outPos < m_outBuf.size())
+    {
+        ssize_t status = ::send(m_sock, m_outBuf.data() + m_outPos,
+                                m_outBuf.size() - m_outPos, MSG_NOSIGNAL);
+        if (status == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true;
+            return false;
+        }
+
+        m_outPos += status;
+    }
+
+    m_outBuf.clear();
+    m_outPos = 0;
 
     return true;
 }
@@ -948,7 +1052,7 @@ void ZMServer::handleGetAnalyseFrame(vector<string> tokens)
 
 void ZMServer::handleGetLiveFrame(vector<string> tokens)
 {
-    static unsigned char buffer[MAX_IMAGE_SIZE];
+    unsigned char *buffer = NULL;
     char str[100];
 
     // we need to periodically kick the DB connection here to make sure it
@@ -993,8 +1097,8 @@ void ZMServer::handleGetLiveFrame(vector<string> tokens)
         return;
     }
 
-    // read a frame from the shared memory
-    int dataSize = getFrame(buffer, sizeof(buffer), monitor);
+    // find the latest frame in the shared memory
+    int dataSize = getFrame(buffer, monitor);
 
     if (m_debug)
         cout << "Frame size: " <<  dataSize << endl;
@@ -1019,6 +1123,134 @@ void ZMServer::handleGetLiveFrame(vector<string> tokens)
     send(outStr, buffer, dataSize);
 }
 
+void ZMServer::handleSubscribeLiveFrames(vector<string> tokens)
+{
+    if (tokens.size() != 2 && tokens.size() != 3)
+    {
+        sendError(ERROR_TOKEN_COUNT);
+        return;
+    }
+
+    int monitorID = atoi(tokens[1].c_str());
+    int scale = (tokens.size() == 3) ? atoi(tokens[2].c_str()) : 1;
+    scale = max(1, min(scale, MAX_LIVE_SCALE));
+
+    if (m_debug)
+        cout << "Subscribing to live frames from monitor: " << monitorID
+             << " at 1/" << scale << " size" << endl;
+
+    if (m_monitors.find(monitorID) == m_monitors.end())
+    {
+        sendError(ERROR_INVALID_MONITOR);
+        return;
+    }
+
+    MONITOR *monitor = m_monitors[monitorID];
+    if (monitor->shared_data == NULL ||  monitor->shared_images == NULL)
+    {
+        sendError(ERROR_INVALID_POINTERS);
+        return;
+    }
+
+    // From now on LIVE_FRAME messages can arrive at any time, see
+    // sendLiveFrames(). Every message, pushed or not, is still sent whole
+    // as an 8 character length, the [] separated message and any data, so
+    // the client just needs to look at the first token of each message to
+    // tell a LIVE_FRAME from the reply to its last command. Replies are
+    // always sent in the order the commands were received.
+    LIVE_SUBSCRIPTION subscription;
+    subscription.scale = scale;
+    subscription.last_read = -1;
+    subscription.last_time = 0;
+    m_liveSubscriptions[monitorID] = subscription;
+
+    string outStr("");
+    ADD_STR(outStr, "OK")
+    send(outStr);
+}
+
+void ZMServer::handleUnsubscribeLiveFrames(vector<string> tokens)
+{
+    // with no monitor id all the subscriptions are dropped
+    if (tokens.size() == 1)
+        m_liveSubscriptions.clear();
+    else if (tokens.size() == 2)
+        m_liveSubscriptions.erase(atoi(tokens[1].c_str()));
+    else
+    {
+        sendError(ERROR_TOKEN_COUNT);
+        return;
+    }
+
+    string outStr("");
+    ADD_STR(outStr, "OK")
+    send(outStr);
+}
+
+/*
+ * Called from the main loop to push a frame to the client for each
+ * subscribed monitor whose shared memory frame index has moved on since
+ * the last one sent.
+ *
+ * Sent as:- LIVE_FRAME, monitor id, status, width, height, data size
+ * followed by the raw frame data.
+ *
+ * Frames are only sent once everything queued for the client has gone,
+ * so a slow client just gets fewer frames rather than a growing backlog.
+ */
+void ZMServer::sendLiveFrames(void)
+{
+    char str[100];
+
+    map<int, LIVE_SUBSCRIPTION>::iterator it = m_liveSubscriptions.begin();
+    for (; it != m_liveSubscriptions.end(); ++it)
+    {
+        // still sending the last one, try again next time round
+        if (hasPendingOutput())
+            return;
+
+        MONITOR *monitor = m_monitors[it->first];
+        LIVE_SUBSCRIPTION &subscription = it->second;
+
+        int index = getLatestFrame(monitor);
+        if (index < 0)
+            continue;
+
+        time_t frameTime = monitor->shared_data->last_image_time;
+        if (index == subscription.last_read &&
+            frameTime == subscription.last_time)
+            continue;
+
+        subscription.last_read = index;
+        subscription.last_time = frameTime;
+
+        int width, height, dataSize;
+        const unsigned char *data =
+            getScaledFrame(monitor, index, subscription.scale,
+                           width, height, dataSize);
+
+        string outStr("");
+        ADD_STR(outStr, "LIVE_FRAME")
+
+        sprintf(str, "%d", monitor->mon_id);
+        ADD_STR(outStr, str)
+
+        ADD_STR(outStr, monitor->status)
+
+        sprintf(str, "%d", width);
+        ADD_STR(outStr, str)
+
+        sprintf(str, "%d", height);
+        ADD_STR(outStr, str)
+
+        sprintf(str, "%d", dataSize);
+        ADD_STR(outStr, str)
+
+        if (!send(outStr, data, dataSize))
+            return;
+    }
+}
+
 void ZMServer::handleGetFrameList(vector<string> tokens)
 {
     string eventID;
@@ -1442,20 +1674,13 @@ void ZMServer::initMonitor(MONITOR *monitor)
             ((monitor->image_buffer_count) * sizeof(struct timeval));
 }
 
-int ZMServer::getFrame(unsigned char *buffer, int bufferSize, MONITOR *monitor)
+int ZMServer::getLatestFrame(MONITOR *monitor)
 {
-    (void) bufferSize;
+    int index = monitor->shared_data->last_write_index;
 
-    // is there a new frame available?
-    if (monitor->shared_data->last_write_index == monitor->last_read)
-        return 0;
-
-    // sanity check last_read
-    if (monitor->shared_data->last_write_index < 0 ||
-            monitor->shared_data->last_write_index >= monitor->image_buffer_count)
-        return 0;
-
-    monitor->last_read = monitor->shared_data->last_write_index;
+    // sanity check the index
+    if (index < 0 || index >= monitor->image_buffer_count)
+        return -1;
 
     switch (monitor->shared_data->state)
     {
@@ -1479,17 +1704,85 @@ int ZMServer::getFrame(unsigned char *buffer, int bufferSize, MONITOR *monitor)
             break;
     }
 
-    unsigned char *data = monitor->shared_images +
-            monitor->frame_size * monitor->last_read;
+    return index;
+}
 
-    // FIXME: should do some sort of compression JPEG??
-    // just copy the data to our buffer for now
-    memcpy(buffer, data, monitor->frame_size);
+int ZMServer::getFrame(unsigned char *&data, MONITOR *monitor)
+{
+    // is there a new frame available?
+    if (monitor->shared_data->last_write_index == monitor->last_read)
+        return 0;
+
+    int index = getLatestFrame(monitor);
+    if (index < 0)
+        return 0;
 
+    monitor->last_read = index;
+
+    // the frame is sent straight from the shared memory
+    data = monitor->shared_images + monitor->frame_size * index;
 
     return monitor->frame_size;
 }
 
+const unsigned char *ZMServer::getScaledFrame(MONITOR *monitor, int index,
+                                              int scale, int &width,
+                                              int &height, int &dataSize)
+{
+    const unsigned char *frame =
+        monitor->shared_images + monitor->frame_size * index;
+
+    if (scale <= 1)
+    {
+        width = monitor->width;
+        height = monitor->height;
+        dataSize = monitor->frame_size;
+        return frame;
+    }
+
+    int bpp = (monitor->palette == 1) ? 1 : 3;
+    width = monitor->width / scale;
+    height = monitor->height / scale;
+    dataSize = width * height * bpp;
+
+    SCALED_FRAME &scaled = s_scaledFrames[make_pair(monitor->mon_id, scale)];
+    time_t frameTime = monitor->shared_data->last_image_time;
+
+    if ((int) scaled.data.size() == dataSize && scaled.index == index &&
+        scaled.time == frameTime)
+    {
+        // another client has already had this one
+        return dataSize ? &scaled.data[0] : NULL;
+    }
+
+    scaled.data.resize(dataSize);
+    scaled.index = index;
+    scaled.time = frameTime;
+
+    // average each scale x scale block of pixels
+    int stride = monitor->width * bpp;
+    int area = scale * scale;
+    unsigned char *out = dataSize ? &scaled.data[0] : NULL;
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char *row = frame + y * scale * stride;
+        for (int x = 0; x < width; x++)
+        {
+            for (int c = 0; c < bpp; c++)
+            {
+                int sum = 0;
+                const unsigned char *p = row + x * scale * bpp + c;
+                for (int j = 0; j < scale; j++, p += stride)
+                    for (int i = 0; i < scale; i++)
+                        sum += p[i * bpp];
+                *out++ = sum / area;
+            }
+        }
+    }
+
+    return dataSize ? &scaled.data[0] : NULL;
+}
+
 string ZMServer::getZMSetting(const string &setting)
 {
     string result;
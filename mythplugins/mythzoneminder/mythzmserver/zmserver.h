@@ -18,6 +18,7 @@
 
 
 #include <unistd.h>
+#include <sys/uio.h>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -146,6 +147,14 @@ typedef struct
 
 } MONITOR;
 
+// a client's subscription to the live frames of a monitor
+typedef struct
+{
+    int scale;                  // frames are sent at 1/scale of full size
+    int last_read;              // index of the last frame sent
+    time_t last_time;           // and the time it was captured
+} LIVE_SUBSCRIPTION;
+
 class ZMServer
 {
   public:
@@ -154,14 +163,23 @@ class ZMServer
 
     void processRequest(char* buf, int nbytes);
 
+    bool hasLiveSubscriptions(void) const { return !m_liveSubscriptions.empty(); }
+    void sendLiveFrames(void);
+    bool hasPendingOutput(void) const { return m_outPos < m_outBuf.size(); }
+    bool flushOutput(void);
+
   private:
     string getZMSetting(const string &setting);
-    bool send(const string s) const;
-    bool send(const string s, const unsigned char *buffer, int dataLen) const;
+    bool send(const string s);
+    bool send(const string s, const unsigned char *buffer, int dataLen);
+    bool sendv(struct iovec *iov, int iovcnt);
     void sendError(string error);
     void getMonitorList(void);
     void initMonitor(MONITOR *monitor);
-    int  getFrame(unsigned char *buffer, int bufferSize, MONITOR *monitor);
+    int  getLatestFrame(MONITOR *monitor);
+    int  getFrame(unsigned char *&data, MONITOR *monitor);
+    const unsigned char *getScaledFrame(MONITOR *monitor, int index, int scale,
+                                        int &width, int &height, int &dataSize);
     long long getDiskSpace(const string &filename, long long &total, long long &used);
     void tokenize(const string &command, vector<string> &tokens);
     void handleHello(void);
@@ -177,6 +195,8 @@ class ZMServer
     void handleGetEventFrame(vector<string> tokens);
     void handleGetAnalyseFrame(vector<string> tokens);
     void handleGetLiveFrame(vector<string> tokens);
+    void handleSubscribeLiveFrames(vector<string> tokens);
+    void handleUnsubscribeLiveFrames(vector<string> tokens);
     void handleGetFrameList(vector<string> tokens);
     void handleDeleteEvent(vector<string> tokens);
     void handleDeleteEventList(vector<string> tokens);
@@ -194,6 +214,9 @@ class ZMServer
     string               m_analyseFileFormat;
     key_t                m_shmKey;
     string               m_mmapPath;
+    map<int, LIVE_SUBSCRIPTION> m_liveSubscriptions;
+    string               m_outBuf;      // data waiting for the socket
+    string::size_type    m_outPos;      // how much of it has been sent
 };
 
 
@@ -125,6 +125,26 @@ bool ZMClient::connectToHost(const QString &lhostname, unsigned int lport)
         m_bConnected = false;
     }
 
+    // a new connection starts without any live frame subscriptions
+    m_liveFrames.clear();
+    if (m_bConnected)
+    {
+        QMap<int, int>::const_iterator it = m_liveSubscriptions.begin();
+        for (; it != m_liveSubscriptions.end(); ++it)
+        {
+            QStringList strList("SUBSCRIBE_LIVE_FRAMES");
+            strList << QString::number(it.key());
+            strList << QString::number(it.value());
+            m_socket->writeStringList(strList);
+            if (!readReply(strList) || strList[0] != "OK")
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    QString("Failed to renew the live frame subscription "
+                            "for monitor %1").arg(it.key()));
+            }
+        }
+    }
+
     if (m_bConnected == false)
         m_server_unavailable = true;
 
@@ -133,11 +153,13 @@ bool ZMClient::connectToHost(const QString &lhostname, unsigned int lport)
 
 bool ZMClient::sendReceiveStringList(QStringList &strList)
 {
+    QStringList command = strList;
+
     bool ok = false;
     if (m_bConnected)
     {
         m_socket->writeStringList(strList);
-        ok = m_socket->readStringList(strList, false);
+        ok = readReply(strList);
     }
 
     if (!ok)
@@ -151,8 +173,9 @@ bool ZMClient::sendReceiveStringList(QStringList &strList)
         }
 
         // try to resend 
+        strList = command;
         m_socket->writeStringList(strList);
-        ok = m_socket->readStringList(strList, false);
+        ok = readReply(strList);
         if (!ok)
         {
             m_bConnected = false;
@@ -184,6 +207,25 @@ bool ZMClient::sendReceiveStringList(QStringList &strList)
     return true;
 }
 
+/*
+ * Reads the reply to the last command sent. While we have a live frame
+ * subscription the server can push a LIVE_FRAME message at any time, so
+ * any that arrive ahead of the reply are kept for getPushedLiveFrame().
+ */
+bool ZMClient::readReply(QStringList &strList)
+{
+    while (m_socket->readStringList(strList, false))
+    {
+        if (strList.empty() || strList[0] != "LIVE_FRAME")
+            return true;
+
+        if (!readLiveFrame(strList))
+            return false;
+    }
+
+    return false;
+}
+
 bool ZMClient::checkProtoVersion(void)
 {
     QStringList strList("HELLO");
@@ -631,6 +673,116 @@ int ZMClient::getLiveFrame(int monitorID, QString &status, unsigned char* buffer
     return imageSize;
 }
 
+bool ZMClient::subscribeLiveFrames(int monitorID, int scale)
+{
+    QStringList strList("SUBSCRIBE_LIVE_FRAMES");
+    strList << QString::number(monitorID);
+    strList << QString::number(scale);
+    if (!sendReceiveStringList(strList))
+        return false;
+
+    m_liveSubscriptions[monitorID] = scale;
+    return true;
+}
+
+void ZMClient::unsubscribeLiveFrames(void)
+{
+    if (m_liveSubscriptions.empty())
+        return;
+
+    // forget them first so a reconnect doesn't renew them
+    m_liveSubscriptions.clear();
+
+    QStringList strList("UNSUBSCRIBE_LIVE_FRAMES");
+    sendReceiveStringList(strList);
+
+    // nothing more is pushed once the reply has arrived
+    m_liveFrames.clear();
+}
+
+bool ZMClient::getPushedLiveFrame(int monitorID, LiveFrame &frame)
+{
+    readPendingLiveFrames();
+
+    QMap<int, LiveFrame>::iterator it = m_liveFrames.find(monitorID);
+    if (it == m_liveFrames.end())
+        return false;
+
+    frame = *it;
+    m_liveFrames.erase(it);
+
+    return true;
+}
+
+/*
+ * Reads any LIVE_FRAME messages that have already arrived, without waiting
+ * for more. Only the newest frame from each monitor is kept.
+ */
+void ZMClient::readPendingLiveFrames(void)
+{
+    QMutexLocker locker(&m_socketLock);
+
+    while (m_bConnected && m_socket->bytesAvailable() > 0)
+    {
+        QStringList strList;
+        if (!m_socket->readStringList(strList, false) || strList.empty() ||
+            strList[0] != "LIVE_FRAME" || !readLiveFrame(strList))
+        {
+            // we've lost our place in the stream so start again
+            LOG(VB_GENERAL, LOG_ERR,
+                "ZMClient::readPendingLiveFrames(): Unexpected message "
+                "from the server");
+            m_socket->close();
+            m_bConnected = false;
+            return;
+        }
+    }
+}
+
+/*
+ * Reads the frame data following a LIVE_FRAME message.
+ *
+ * Sent as:- LIVE_FRAME, monitor id, status, width, height, data size
+ * followed by the raw frame data.
+ */
+bool ZMClient::readLiveFrame(const QStringList &strList)
+{
+    if (strList.size() < 6)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "ZMClient received a bad LIVE_FRAME message");
+        return false;
+    }
+
+    int monitorID = strList[1].toInt();
+    int dataSize = strList[5].toInt();
+
+    if (dataSize < 0 || dataSize > BUFFER_SIZE)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("ZMClient received a bad live frame size (%1)")
+                .arg(dataSize));
+        return false;
+    }
+
+    LiveFrame &frame = m_liveFrames[monitorID];
+    frame.status = strList[2];
+    frame.width = strList[3].toInt();
+    frame.height = strList[4].toInt();
+    frame.data.resize(dataSize);
+
+    if (dataSize > 0 &&
+        !readData((unsigned char*) frame.data.data(), dataSize))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "ZMClient::readLiveFrame(): Failed to get image data");
+        m_liveFrames.remove(monitorID);
+        return false;
+    }
+
+    return true;
+}
+
 void ZMClient::getCameraList(QStringList &cameraList)
 {
     cameraList.clear();
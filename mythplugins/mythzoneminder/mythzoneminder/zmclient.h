@@ -5,6 +5,9 @@
 #include <vector>
 using namespace std;
 
+// qt
+#include <QMap>
+
 // myth
 #include <mythsocket.h>
 #include <mythexp.h>
@@ -46,6 +49,9 @@ class MPUBLIC ZMClient : public QObject
     void getEventFrame(Event *event, int frameNo, MythImage **image);
     void getAnalyseFrame(Event *event, int frameNo, QImage &image);
     int  getLiveFrame(int monitorID, QString &status, unsigned char* buffer, int bufferSize);
+    bool subscribeLiveFrames(int monitorID, int scale = 1);
+    void unsubscribeLiveFrames(void);
+    bool getPushedLiveFrame(int monitorID, LiveFrame &frame);
     void getFrameList(int eventID, vector<Frame*> *frameList);
     void deleteEvent(int eventID);
     void deleteEventList(vector<Event*> *eventList);
@@ -62,6 +68,9 @@ class MPUBLIC ZMClient : public QObject
   private:
     bool readData(unsigned char *data, int dataSize);
     bool sendReceiveStringList(QStringList &strList);
+    bool readReply(QStringList &strList);
+    bool readLiveFrame(const QStringList &strList);
+    void readPendingLiveFrames(void);
 
     MythSocket       *m_socket;
     QMutex            m_socketLock;
@@ -70,6 +79,9 @@ class MPUBLIC ZMClient : public QObject
     bool              m_bConnected;
     QTimer           *m_retryTimer;
     bool              m_zmclientReady;
+
+    QMap<int, int>       m_liveSubscriptions; // monitor id -> scale
+    QMap<int, LiveFrame> m_liveFrames;        // newest pushed frame
 };
 
 #endif
@@ -20,6 +20,7 @@
 // qt
 #include <QString>
 #include <QDateTime>
+#include <QByteArray>
 
 // event details
 typedef struct
@@ -73,4 +74,19 @@ class Monitor
     bool isV4L2;
 };
 
+// a live frame pushed by the server to a subscribed client
+class LiveFrame
+{
+  public:
+    LiveFrame() : width(0), height(0)
+    {
+    }
+
+  public:
+    QString    status;
+    int        width;
+    int        height;
+    QByteArray data;
+};
+
 #endif
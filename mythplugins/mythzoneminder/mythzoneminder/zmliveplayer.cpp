@@ -36,6 +36,7 @@ ZMLivePlayer::ZMLivePlayer(MythScreenStack *parent)
              :MythScreenType(parent, "zmliveview")
 {
     m_paused = false;
+    m_pushedFrames = false;
 
     m_players = NULL;
     m_monitors = NULL;
@@ -134,6 +135,9 @@ bool ZMLivePlayer::initMonitorLayout()
 
 ZMLivePlayer::~ZMLivePlayer()
 {
+    if (class ZMClient *zm = ZMClient::get())
+        zm->unsubscribeLiveFrames();
+
     gCoreContext->SaveSetting("ZoneMinderLiveLayout", m_monitorLayout);
 
     GetMythUI()->DoRestoreScreensaver();
@@ -182,13 +186,15 @@ bool ZMLivePlayer::keyPressEvent(QKeyEvent *event)
         {
             if (m_paused)
             {
-                m_frameTimer->start(FRAME_UPDATE_TIME);
                 m_paused = false;
+                subscribeLiveFrames();
+                m_frameTimer->start(FRAME_UPDATE_TIME);
             }
             else
             {
                 m_frameTimer->stop();
                 m_paused = true;
+                subscribeLiveFrames();
             }
         }
         else if (action == "INFO")
@@ -246,9 +252,54 @@ void ZMLivePlayer::changePlayerMonitor(int playerNo)
     m_players->at(playerNo - 1)->setMonitor(mon);
     m_players->at(playerNo - 1)->updateCamera();
 
+    subscribeLiveFrames();
+
     m_frameTimer->start(FRAME_UPDATE_TIME);
 }
 
+/*
+ * Asks the server to push frames from each monitor being shown, scaled
+ * down to fit the largest frame showing it. Nothing is pushed while we
+ * are paused. Falls back to polling for frames if the server can't push.
+ */
+void ZMLivePlayer::subscribeLiveFrames(void)
+{
+    m_pushedFrames = false;
+
+    class ZMClient *zm = ZMClient::get();
+    if (!zm)
+        return;
+
+    zm->unsubscribeLiveFrames();
+
+    if (m_paused || !m_players)
+        return;
+
+    QMap<int, int> scales;
+    vector<Player*>::iterator i = m_players->begin();
+    for (; i != m_players->end(); ++i)
+    {
+        int monID = (*i)->getMonitor()->id;
+        int scale = (*i)->getFrameScale();
+        if (!scales.contains(monID) || scale < scales[monID])
+            scales[monID] = scale;
+    }
+
+    QMap<int, int>::const_iterator it = scales.begin();
+    for (; it != scales.end(); ++it)
+    {
+        if (!zm->subscribeLiveFrames(it.key(), it.value()))
+        {
+            LOG(VB_GENERAL, LOG_NOTICE,
+                "Server can't push live frames, polling for them instead");
+            zm->unsubscribeLiveFrames();
+            return;
+        }
+    }
+
+    m_pushedFrames = true;
+}
+
 void ZMLivePlayer::updateFrame()
 {
     class ZMClient *zm = ZMClient::get();
@@ -269,10 +320,27 @@ void ZMLivePlayer::updateFrame()
             monList.append(p->getMonitor()->id);
     }
 
+    LiveFrame frame;
     for (int x = 0; x < monList.count(); x++)
     {
         QString status;
-        int frameSize = zm->getLiveFrame(monList[x], status, buffer, sizeof(buffer));
+        const unsigned char *data = buffer;
+        int frameSize, width = 0, height = 0;
+
+        if (m_pushedFrames)
+        {
+            // just picks up whatever the server has pushed since last time
+            if (!zm->getPushedLiveFrame(monList[x], frame))
+                continue;
+
+            status = frame.status;
+            data = (const unsigned char *) frame.data.constData();
+            frameSize = frame.data.size();
+            width = frame.width;
+            height = frame.height;
+        }
+        else
+            frameSize = zm->getLiveFrame(monList[x], status, buffer, sizeof(buffer));
 
         if (frameSize > 0 && !status.startsWith("ERROR"))
         {
@@ -289,7 +357,13 @@ void ZMLivePlayer::updateFrame()
                         p->getMonitor()->status = status;
                         p->updateStatus();
                     }
-                    p->updateFrame(buffer);
+                    // polled frames are always full size
+                    if (m_pushedFrames)
+                        p->updateFrame(data, frameSize, width, height);
+                    else
+                        p->updateFrame(data, frameSize,
+                                       p->getMonitor()->width,
+                                       p->getMonitor()->height);
                 }
             }
         }
@@ -372,6 +446,8 @@ void ZMLivePlayer::setMonitorLayout(int layout, bool restore)
             monitorNo = 1;
     }
 
+    subscribeLiveFrames();
+
     updateFrame();
 }
 
@@ -426,16 +502,29 @@ void Player::setWidgets(MythUIImage *image, MythUIText *status, MythUIText  *cam
         m_cameraText->SetVisible(true);
 }
 
-void Player::updateFrame(const unsigned char* buffer)
+void Player::updateFrame(const unsigned char* buffer, int dataSize,
+                         int width, int height)
 {
     unsigned int pos_data;
     unsigned int pos_rgba = 0;
     unsigned int r,g,b;
 
+    // pushed frames may have been scaled down but are never bigger
+    int bpp = (m_monitor.palette == MP_GREY) ? 1 : 3;
+    if (width <= 0 || height <= 0 ||
+        width > m_monitor.width || height > m_monitor.height ||
+        dataSize < width * height * bpp)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Got a bad live frame from monitor %1 (%2x%3)")
+                .arg(m_monitor.id).arg(width).arg(height));
+        return;
+    }
+
     if (m_monitor.palette == MP_GREY)
     {
         // grey palette
-        for (pos_data = 0; pos_data < (unsigned int) (m_monitor.width * m_monitor.height); )
+        for (pos_data = 0; pos_data < (unsigned int) (width * height); )
         {
             m_rgba[pos_rgba++] = buffer[pos_data];   //b
             m_rgba[pos_rgba++] = buffer[pos_data];   //g
@@ -446,7 +535,7 @@ void Player::updateFrame(const unsigned char* buffer)
     else
     {
         // all other color palettes
-        for (pos_data = 0; pos_data < (unsigned int) (m_monitor.width * m_monitor.height * 3); )
+        for (pos_data = 0; pos_data < (unsigned int) (width * height * 3); )
         {
             r = buffer[pos_data++];
             g = buffer[pos_data++];
@@ -468,7 +557,7 @@ void Player::updateFrame(const unsigned char* buffer)
         }
     }
 
-    QImage image(m_rgba, m_monitor.width, m_monitor.height, QImage::Format_ARGB32);
+    QImage image(m_rgba, width, height, QImage::Format_ARGB32);
 
     MythImage *img = GetMythMainWindow()->GetCurrentPainter()->GetFormatImage();
     img->Assign(image);
@@ -476,6 +565,25 @@ void Player::updateFrame(const unsigned char* buffer)
     img->DecrRef();
 }
 
+/*
+ * How many times smaller the frames from our monitor can be and still
+ * fill the frame image.
+ */
+int Player::getFrameScale(void)
+{
+    if (!m_frameImage)
+        return 1;
+
+    QRect area = m_frameImage->GetArea();
+    if (area.width() <= 0 || area.height() <= 0)
+        return 1;
+
+    int scale = qMin(m_monitor.width / area.width(),
+                     m_monitor.height / area.height());
+
+    return qMax(scale, 1);
+}
+
 void Player::updateStatus(void)
 {
     if (m_statusText)
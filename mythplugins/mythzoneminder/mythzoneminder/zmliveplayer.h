@@ -36,7 +36,8 @@ class Player
     Player(void);
     ~Player(void);
 
-    void updateFrame(const uchar* buffer);
+    void updateFrame(const uchar* buffer, int dataSize,
+                     int width, int height);
     void updateStatus(void);
     void updateCamera();
 
@@ -45,6 +46,7 @@ class Player
                     MythUIText  *camera);
 
     Monitor *getMonitor(void) { return &m_monitor; }
+    int getFrameScale(void);
 
   private:
     void getMonitorList(void);
@@ -82,9 +84,11 @@ class ZMLivePlayer : public MythScreenType
     bool hideAll();
     void stopPlayers(void);
     void changePlayerMonitor(int playerNo);
+    void subscribeLiveFrames(void);
 
     QTimer               *m_frameTimer;
     bool                  m_paused;
+    bool                  m_pushedFrames;
     int                   m_monitorLayout;
     int                   m_monitorCount;
 
@@ -136,59 +136,75 @@ static void adjustRegionMMX(uint8_t *buf, uint8_t *end, const uint8_t *table,
 }
 #endif /* HAVE_MMX */
 
-static int adjustFilter (VideoFilter *vf, VideoFrame *frame, int field)
+static void adjustRows (ThisFilter *filter, VideoFrame *frame,
+                        int begin, int end)
 {
-    (void)field;
-    ThisFilter *filter = (ThisFilter *) vf;
-    TF_VARS;
-
-    TF_START;
-    {
-        unsigned char *ybeg = frame->buf + frame->offsets[0];
-        unsigned char *yend = ybeg + (frame->pitches[0] * frame->height);
-        int cheight = (frame->codec == FMT_YV12) ?
-            (frame->height >> 1) : frame->height;
-        unsigned char *ubeg = frame->buf + frame->offsets[1];
-        unsigned char *uend = ubeg + (frame->pitches[1] * cheight);
-        unsigned char *vbeg = frame->buf + frame->offsets[2];
-        unsigned char *vend = ubeg + (frame->pitches[2] * cheight);
+    int vshift = (frame->codec == FMT_YV12) ? 1 : 0;
+    int cbegin = begin >> vshift;
+    int cend = end >> vshift;
+    unsigned char *ybeg = frame->buf + frame->offsets[0] +
+                          (frame->pitches[0] * begin);
+    unsigned char *yend = ybeg + (frame->pitches[0] * (end - begin));
+    unsigned char *ubeg = frame->buf + frame->offsets[1] +
+                          (frame->pitches[1] * cbegin);
+    unsigned char *uend = ubeg + (frame->pitches[1] * (cend - cbegin));
+    unsigned char *vbeg = frame->buf + frame->offsets[2] +
+                          (frame->pitches[2] * cbegin);
+    unsigned char *vend = vbeg + (frame->pitches[2] * (cend - cbegin));
 
 #if HAVE_MMX
-        if (filter->yfilt)
-            adjustRegionMMX(ybeg, yend, filter->ytable,
-                            &(filter->yshift), &(filter->yscale),
-                            &(filter->ymin), mm_cpool + 1, mm_cpool + 2);
-        else
-            adjustRegion(ybeg, yend, filter->ytable);
-
-        if (filter->cfilt)
-        {
-            adjustRegionMMX(ubeg, uend, filter->ctable,
-                            &(filter->cshift), &(filter->cscale),
-                            &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
-            adjustRegionMMX(vbeg, vend, filter->ctable,
-                            &(filter->cshift), &(filter->cscale),
-                            &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
-        }
-        else
-        {
-            adjustRegion(ubeg, uend, filter->ctable);
-            adjustRegion(vbeg, vend, filter->ctable);
-        }
-
-        if (filter->yfilt || filter->cfilt)
-            emms();
-
-#else /* HAVE_MMX */
+    if (filter->yfilt)
+        adjustRegionMMX(ybeg, yend, filter->ytable,
+                        &(filter->yshift), &(filter->yscale),
+                        &(filter->ymin), mm_cpool + 1, mm_cpool + 2);
+    else
         adjustRegion(ybeg, yend, filter->ytable);
+
+    if (filter->cfilt)
+    {
+        adjustRegionMMX(ubeg, uend, filter->ctable,
+                        &(filter->cshift), &(filter->cscale),
+                        &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
+        adjustRegionMMX(vbeg, vend, filter->ctable,
+                        &(filter->cshift), &(filter->cscale),
+                        &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
+    }
+    else
+    {
         adjustRegion(ubeg, uend, filter->ctable);
         adjustRegion(vbeg, vend, filter->ctable);
-#endif /* HAVE_MMX */
     }
+
+    if (filter->yfilt || filter->cfilt)
+        emms();
+
+#else /* HAVE_MMX */
+    adjustRegion(ybeg, yend, filter->ytable);
+    adjustRegion(ubeg, uend, filter->ctable);
+    adjustRegion(vbeg, vend, filter->ctable);
+#endif /* HAVE_MMX */
+}
+
+static int adjustFilter (VideoFilter *vf, VideoFrame *frame, int field)
+{
+    (void)field;
+    ThisFilter *filter = (ThisFilter *) vf;
+    TF_VARS;
+
+    TF_START;
+    adjustRows(filter, frame, 0, frame->height);
     TF_END(filter, "Adjust: ");
     return 0;
 }
 
+static int adjustSlice (VideoFilter *vf, VideoFrame *frame, int field,
+                        int begin, int end)
+{
+    (void)field;
+    adjustRows((ThisFilter *) vf, frame, begin, end);
+    return 0;
+}
+
 static void fillTable(uint8_t *table, int in_min, int in_max, int out_min,
                 int out_max, float gamma)
 {
@@ -319,7 +335,8 @@ const FilterInfo filter_table[] =
         name:       "adjust",
         descript:   "adjust range and gamma of video",
         formats:    FmtList,
-        libname:    NULL
+        libname:    NULL,
+        filter_slice: &adjustSlice
     },
     FILT_NULL
 };
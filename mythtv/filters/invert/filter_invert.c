@@ -15,26 +15,48 @@ typedef struct ThisFilter
     TF_STRUCT;
 } ThisFilter;
 
+static void invertRegion(unsigned char *buf, int size)
+{
+    while (size--)
+    {
+        *buf = 255 - (*buf);
+        buf++;
+    }
+}
+
 int invert(VideoFilter *vf, VideoFrame *frame, int field)
 {
     (void)field;
-    int size = frame->size;
-    unsigned char *buf = frame->buf;
     TF_VARS;
 
     (void)vf;
 
     TF_START;
 
+    invertRegion(frame->buf, frame->size);
 
-    while (size--)
+    TF_END((ThisFilter *)vf, "Invert");
+
+    return 0;
+}
+
+static int invertSlice(VideoFilter *vf, VideoFrame *frame, int field,
+                       int begin, int end)
+{
+    int planes = (frame->codec == FMT_RGB24) ? 1 : 3;
+    int vshift = (frame->codec == FMT_YV12) ? 1 : 0;
+    int i;
+    (void)vf;
+    (void)field;
+
+    for (i = 0; i < planes; i++)
     {
-        *buf = 255 - (*buf);
-        buf++;
+        int b = (i) ? (begin >> vshift) : begin;
+        int e = (i) ? (end >> vshift) : end;
+        invertRegion(frame->buf + frame->offsets[i] + frame->pitches[i] * b,
+                     frame->pitches[i] * (e - b));
     }
 
-    TF_END((ThisFilter *)vf, "Invert");
-
     return 0;
 }
 
@@ -83,7 +105,8 @@ const FilterInfo filter_table[] =
         name:       "invert",
         descript:   "inverts the colors of the input video",
         formats:    FmtList,
-        libname:    NULL
+        libname:    NULL,
+        filter_slice: &invertSlice
     },
     FILT_NULL
 };
@@ -127,6 +127,10 @@ class MPUBLIC AudioOutput : public VolumeBase, public OutputListeners
     virtual void GetBufferStatus(uint &fill, uint &total)
         { fill = total = 0; }
 
+    /// report output buffering in milliseconds and underruns since opening
+    virtual void GetLatencyStats(int &target, int &current, uint &underruns)
+        { target = current = 0; underruns = 0; }
+
     //  Only really used by the AudioOutputNULL object
     virtual void bufferOutputData(bool y) = 0;
     virtual int readOutputData(unsigned char *read_buffer,
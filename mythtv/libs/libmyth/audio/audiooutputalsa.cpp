@@ -588,6 +588,7 @@ void AudioOutputALSA::WriteAudio(uchar *aubuf, int size)
                  if (snd_pcm_state(pcm_handle) == SND_PCM_STATE_XRUN)
                  {
                     VBAUDIO("WriteAudio: buffer underrun");
+                    ReportUnderrun();
                     if ((err = snd_pcm_prepare(pcm_handle)) < 0)
                     {
                         AERROR("WriteAudio: unable to recover from xrun");
@@ -104,7 +104,11 @@ AudioOutputBase::AudioOutputBase(const AudioSettings &settings) :
     memory_corruption_test2(0xdeadbeef),
     memory_corruption_test3(0xdeadbeef),
     m_configure_succeeded(false),m_length_last_data(0),
-    m_spdifenc(NULL),           m_forcedprocessing(false)
+    m_spdifenc(NULL),           m_forcedprocessing(false),
+    m_adaptive_latency(false),  m_latency_target(0),
+    m_latency_min(0),           m_latency_max(0),
+    m_sink_primed(false),       m_underruns(0),
+    m_underruns_seen(0)
 {
     src_in = (float *)AOALIGN(src_in_buf);
     memset(&src_data,          0, sizeof(SRC_DATA));
@@ -807,6 +811,8 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
 
     VBAUDIO(QString("Audio fragment size: %1").arg(fragment_size));
 
+    InitLatencyControl();
+
     // Only used for software volume
     if (set_initial_vol && internal_vol && SWVolume())
     {
@@ -997,10 +1003,13 @@ void AudioOutputBase::SetEffDsp(int dsprate)
  */
 inline int AudioOutputBase::audiolen()
 {
-    if (waud >= raud)
-        return waud - raud;
+    int w = waud.fetchAndAddAcquire(0);
+    int r = raud.fetchAndAddAcquire(0);
+
+    if (w >= r)
+        return w - r;
     else
-        return kAudioRingBufferSize - (raud - waud);
+        return kAudioRingBufferSize - (r - w);
 }
 
 /**
@@ -1215,10 +1224,13 @@ int AudioOutputBase::CheckFreeSpace(int &frames)
 /**
  * Copy frames into the audiobuffer, upmixing en route if necessary
  *
+ * gain is applied to float samples while copying when not upmixing
+ *
  * Returns the number of frames written, which may be less than requested
  * if the upmixer buffered some (or all) of them
  */
-int AudioOutputBase::CopyWithUpmix(char *buffer, int frames, uint &org_waud)
+int AudioOutputBase::CopyWithUpmix(char *buffer, int frames, uint &org_waud,
+                                   float gain)
 {
     int len   = CheckFreeSpace(frames);
     int bdiff = kAudioRingBufferSize - org_waud;
@@ -1231,13 +1243,22 @@ int AudioOutputBase::CopyWithUpmix(char *buffer, int frames, uint &org_waud)
 
         if (bdiff <= num)
         {
-            memcpy(WPOS, buffer, bdiff);
+            if (gain != 1.0f)
+                AudioOutputUtil::CopyAdjustVolume(WPOS, buffer, bdiff, gain);
+            else
+                memcpy(WPOS, buffer, bdiff);
             num -= bdiff;
             off = bdiff;
             org_waud = 0;
         }
         if (num > 0)
-            memcpy(WPOS, buffer + off, num);
+        {
+            if (gain != 1.0f)
+                AudioOutputUtil::CopyAdjustVolume(WPOS, buffer + off, num,
+                                                  gain);
+            else
+                memcpy(WPOS, buffer + off, num);
+        }
         org_waud = (org_waud + num) % kAudioRingBufferSize;
         return len;
     }
@@ -1396,6 +1417,16 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
                        output_settings->FormatToBits(format));
     }
 
+    // Apply software volume while downmixing or copying into the
+    // audiobuffer instead of in another pass over it. The upmixer and
+    // timestretch hold on to samples, so with those it is still applied
+    // to their output below.
+    bool  fused_volume = internal_vol && SWVolume() && processing &&
+                         !needs_upmix && !pSoundStretch;
+    float gain         = 1.0f;
+    if (fused_volume)
+        gain = AudioOutputUtil::VolumeGain(volume, music, false);
+
     // Calculate amount of free space required in ringbuffer
     if (processing)
     {
@@ -1459,7 +1490,8 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
         if (needs_downmix)
             if(AudioOutputDownmix::DownmixFrames(source_channels,
                                                  configured_channels,
-                                                 src_in, src_in, frames) < 0)
+                                                 src_in, src_in, frames,
+                                                 gain) < 0)
                 VBERROR("Error occurred while downmixing");
 
         // Resample if necessary
@@ -1483,7 +1515,8 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
            represent */
 
         // Copy samples into audiobuffer, with upmix if necessary
-        if ((len = CopyWithUpmix((char *)buffer, frames, org_waud)) <= 0)
+        if ((len = CopyWithUpmix((char *)buffer, frames, org_waud,
+                                 needs_downmix ? 1.0f : gain)) <= 0)
         {
             continue;
         }
@@ -1538,7 +1571,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
             org_waud = (org_waud + nFrames * bpf) % kAudioRingBufferSize;
         }
 
-        if (internal_vol && SWVolume())
+        if (internal_vol && SWVolume() && !fused_volume)
         {
             org_waud    = waud;
             int num     = len;
@@ -1585,7 +1618,8 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
             org_waud = (org_waud + to_get) % kAudioRingBufferSize;
         }
 
-        waud = org_waud;
+        // publish the new samples to the output thread
+        waud.fetchAndStoreRelease(org_waud);
     }
 
     SetAudiotime(frames_final, timecode);
@@ -1658,7 +1692,10 @@ void AudioOutputBase::OutputAudioLoop(void)
             actually_paused = true;
             audiotime = 0; // mark 'audiotime' as invalid.
 
-            WriteAudio(zeros, zero_fragment_size);
+            // keep only the latency target of silence queued, so
+            // unpausing after a seek isn't stuck behind it
+            if (!HoldOutput(false))
+                WriteAudio(zeros, zero_fragment_size);
             continue;
         }
         else
@@ -1683,10 +1720,15 @@ void AudioOutputBase::OutputAudioLoop(void)
                                   "have %1 want %2")
                           .arg(ready).arg(fragment_size));
 
+            // the device running dry now is our fault, not its
+            m_sink_primed = false;
             usleep(10000);
             continue;
         }
 
+        if (HoldOutput(true))
+            continue;
+
 #ifdef AUDIOTSTESTING
         VBAUDIOTS("WriteAudio Start");
 #endif
@@ -1695,14 +1737,14 @@ void AudioOutputBase::OutputAudioLoop(void)
         // delay setting raud until after phys buffer is filled
         // so GetAudiotime will be accurate without locking
         reset_active.TestAndDeref();
-        volatile uint next_raud = raud;
+        uint next_raud = raud;
         if (GetAudioData(fragment, fragment_size, true, &next_raud))
         {
             if (!reset_active.TestAndDeref())
             {
                 WriteAudio(fragment, fragment_size);
                 if (!reset_active.TestAndDeref())
-                    raud = next_raud;
+                    raud.fetchAndStoreRelease(next_raud);
             }
         }
 #ifdef AUDIOTSTESTING
@@ -1727,18 +1769,19 @@ void AudioOutputBase::OutputAudioLoop(void)
  * available. Returns the number of bytes copied.
  */
 int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
-                                  volatile uint *local_raud)
+                                  uint *local_raud)
 {
 
-#define LRPOS audiobuffer + *local_raud
+#define LRPOS audiobuffer + read_pos
     // re-check audioready() in case things changed.
     // for example, ClearAfterSeek() might have run
     int avail_size   = audioready();
     int frag_size    = size;
     int written_size = size;
 
-    if (local_raud == NULL)
-        local_raud = &raud;
+    // Work on a private copy of the read position; raud is only published
+    // once the data has been copied out so AddData can't overwrite it
+    uint read_pos = local_raud ? *local_raud : (uint)raud.fetchAndAddAcquire(0);
 
     if (!full_buffer && (size > avail_size))
     {
@@ -1750,7 +1793,7 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
     if (!avail_size || (frag_size > avail_size))
         return 0;
 
-    int bdiff = kAudioRingBufferSize - raud;
+    int bdiff = kAudioRingBufferSize - read_pos;
 
     int obytes = output_settings->SampleSize(output_format);
     bool fromFloats = processing && !enc && output_format != FORMAT_FLT;
@@ -1773,7 +1816,7 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
         }
 
         frag_size -= bdiff;
-        *local_raud = 0;
+        read_pos = 0;
     }
     if (frag_size > 0)
     {
@@ -1784,7 +1827,12 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
             memcpy(buffer + off, LRPOS, frag_size);
     }
 
-    *local_raud += frag_size;
+    read_pos += frag_size;
+
+    if (local_raud)
+        *local_raud = read_pos;
+    else
+        raud.fetchAndStoreRelease(read_pos);
 
     // Mute individual channels through mono->stereo duplication
     MuteState mute_state = GetMuteState();
@@ -1800,6 +1848,127 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
     return written_size;
 }
 
+/**
+ * Set up the adaptive output latency for a newly opened device
+ *
+ * The target starts at three fragments, bounded by two fragments (or 20ms)
+ * at the bottom and the device buffer at the top.  Devices that can't
+ * report their fill level, or whose buffer is too small to matter, are
+ * filled as before.
+ */
+void AudioOutputBase::InitLatencyControl(void)
+{
+    int bytes_per_ms = samplerate * output_bytes_per_frame / 1000;
+
+    m_latency_max      = soundcard_buffer_size;
+    m_latency_min      = max(fragment_size * 2, bytes_per_ms * 20);
+    m_latency_target   = min(m_latency_max, max(m_latency_min,
+                                                fragment_size * 3));
+    m_sink_primed      = false;
+    m_underruns        = 0;
+    m_underruns_seen   = 0;
+    m_adaptive_latency =
+        gCoreContext->GetNumSetting("AudioAdaptiveLatency", 1) &&
+        bytes_per_ms > 0 && m_latency_max > m_latency_min;
+    m_stable_timer.start();
+
+    if (m_adaptive_latency)
+        VBAUDIO(QString("Adaptive latency: target %1ms (%2ms - %3ms)")
+                .arg(BytesToMs(m_latency_target))
+                .arg(BytesToMs(m_latency_min))
+                .arg(BytesToMs(m_latency_max)));
+}
+
+/**
+ * Decide whether the output thread should hold off writing to the device
+ *
+ * Returns true, after sleeping for roughly the excess, when the device
+ * already holds the latency target.  Underruns grow the target, while a
+ * long enough stretch without one trims it back towards the minimum.
+ */
+bool AudioOutputBase::HoldOutput(bool playing)
+{
+    if (!m_adaptive_latency)
+        return false;
+
+    int buffered = GetBufferedOnSoundcard();
+
+    if (buffered > 0)
+        m_sink_primed = true;
+    else if (playing && m_sink_primed)
+    {
+        // the device ran dry while we had audio waiting for it
+        m_sink_primed = false;
+        ReportUnderrun();
+    }
+
+    uint underruns = m_underruns;
+    if (underruns != m_underruns_seen)
+    {
+        m_underruns_seen = underruns;
+        if (m_latency_target < m_latency_max)
+        {
+            m_latency_target = min(m_latency_max, m_latency_target * 2);
+            VBAUDIO(QString("Underrun, raising latency target to %1ms")
+                    .arg(BytesToMs(m_latency_target)));
+        }
+        m_stable_timer.restart();
+    }
+    else if (m_latency_target > m_latency_min &&
+             m_stable_timer.elapsed() > 10000)
+    {
+        m_latency_target = max(m_latency_min,
+                               m_latency_target - m_latency_target / 8);
+        m_latency_target -= m_latency_target % output_bytes_per_frame;
+        VBAUDIO(QString("Lowering latency target to %1ms")
+                .arg(BytesToMs(m_latency_target)));
+        m_stable_timer.restart();
+    }
+
+    if (buffered < m_latency_target)
+        return false;
+
+    int excess = BytesToMs(buffered - m_latency_target);
+    usleep(max(1, min(10, excess)) * 1000);
+    return true;
+}
+
+/**
+ * Note that the device ran out of audio to play
+ *
+ * May be called from the device's own callback thread
+ */
+void AudioOutputBase::ReportUnderrun(void)
+{
+    m_underruns.ref();
+}
+
+/**
+ * Convert a number of bytes of output audio into milliseconds
+ */
+int AudioOutputBase::BytesToMs(int bytes) const
+{
+    int bytes_per_sec = samplerate * output_bytes_per_frame;
+
+    if (bytes_per_sec <= 0)
+        return 0;
+
+    return (int)((int64_t)bytes * 1000 / bytes_per_sec);
+}
+
+/**
+ * Fill in the output latency target and current device fill level in
+ * milliseconds, and the number of underruns since the device was opened
+ */
+void AudioOutputBase::GetLatencyStats(int &target, int &current,
+                                      uint &underruns)
+{
+    target    = BytesToMs(m_adaptive_latency ? m_latency_target :
+                          soundcard_buffer_size);
+    current   = BytesToMs(GetBufferedOnSoundcard());
+    underruns = m_underruns;
+}
+
 /**
  * Block until all available frames have been written to the device
  */
@@ -12,6 +12,8 @@ using namespace std;
 #include <QString>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QAtomicInt>
+#include <QTime>
 
 // MythTV headers
 #include "audiooutput.h"
@@ -106,6 +108,7 @@ class AudioOutputBase : public AudioOutput, public MThread
     virtual void SetSourceBitrate(int rate);
 
     virtual void GetBufferStatus(uint &fill, uint &total);
+    virtual void GetLatencyStats(int &target, int &current, uint &underruns);
 
     //  Only really used by the AudioOutputNULL object
     virtual void bufferOutputData(bool y){ buffer_output_data_for_use = y; }
@@ -140,7 +143,10 @@ class AudioOutputBase : public AudioOutput, public MThread
     virtual void StopOutputThread(void);
 
     int GetAudioData(uchar *buffer, int buf_size, bool fill_buffer,
-                     volatile uint *local_raud = NULL);
+                     uint *local_raud = NULL);
+
+    // Call when the device reports it ran out of audio to play
+    void ReportUnderrun(void);
 
     void OutputAudioLoop(void);
 
@@ -201,8 +207,12 @@ class AudioOutputBase : public AudioOutput, public MThread
     bool SetupPassthrough(int codec, int codec_profile,
                           int &samplerate_tmp, int &channels_tmp);
     AudioOutputSettings* OutputSettings(bool digital = true);
-    int CopyWithUpmix(char *buffer, int frames, uint &org_waud);
+    int CopyWithUpmix(char *buffer, int frames, uint &org_waud,
+                      float gain = 1.0f);
     void SetAudiotime(int frames, int64_t timecode);
+    void InitLatencyControl(void);
+    bool HoldOutput(bool playing);
+    int  BytesToMs(int bytes) const;
     AudioOutputSettings *output_settingsraw;
     AudioOutputSettings *output_settings;
     AudioOutputSettings *output_settingsdigitalraw;
@@ -248,9 +258,15 @@ class AudioOutputBase : public AudioOutput, public MThread
     int64_t audiotime;
 
     /**
-     * Audio circular buffer
+     * Audio circular buffer read and write positions
+     *
+     * The buffer has a single writer (AddData, under audio_buflock) and a
+     * single reader (the output thread, which takes no lock).  Each side
+     * publishes its position with release semantics once it is done with
+     * the data and loads the other's with acquire semantics, so the reader
+     * never sees waud move before the samples behind it are in memory.
      */
-    volatile uint raud, waud;     // read and write positions
+    QAtomicInt raud, waud;
     /**
      * timecode of audio most recently placed into buffer
      */
@@ -286,6 +302,22 @@ class AudioOutputBase : public AudioOutput, public MThread
     // Flag indicating if SetStretchFactor enabled audio float processing
     bool m_forcedprocessing;
     int m_previousbpf;
+
+    /**
+     * Adaptive output latency, all sizes in bytes of output audio
+     *
+     * The output thread only keeps m_latency_target bytes queued in the
+     * device rather than filling all of its buffer.  The target doubles
+     * on an underrun and is trimmed back while the device keeps up.
+     */
+    bool  m_adaptive_latency;
+    int   m_latency_target;
+    int   m_latency_min;
+    int   m_latency_max;
+    bool  m_sink_primed;
+    QAtomicInt m_underruns;
+    uint  m_underruns_seen;
+    QTime m_stable_timer;
 };
 
 #endif
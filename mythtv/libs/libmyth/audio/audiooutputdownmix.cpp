@@ -164,48 +164,68 @@ static const float s51_matrix[3][8][6] =
     }
 };
 
+/**
+ * Downmix frames from channels_in to channels_out (2 or 6)
+ *
+ * dst may be the same buffer as src. gain is folded into the mixing
+ * coefficients so software volume costs nothing extra here.
+ */
 int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
-                                      float *dst, float *src, int frames)
+                                      float *dst, float *src, int frames,
+                                      float gain)
 {
-    if (channels_in < channels_out)
+    if (channels_in < channels_out || channels_in > 8)
         return -1;
 
     //VBAUDIO(LOC + QString("Downmixing %1 frames (in:%2 out:%3)")
     //    .arg(frames).arg(channels_in).arg(channels_out));
+    const float *matrix;
+    if (channels_out == 2)
+        matrix = &stereo_matrix[channels_in - 1][0][0];
+    else if (channels_out == 6)
+        matrix = &s51_matrix[channels_in - 6][0][0];
+    else
+        return -1;
+
+    // coefficients for this layout, [in][out]
+    float m[8 * 6];
+    for (int k = 0; k < channels_in * channels_out; k++)
+        m[k] = matrix[k] * gain;
+
     if (channels_out == 2)
     {
-        float tmp;
-        int index = channels_in - 1;
         for (int n=0; n < frames; n++)
         {
-            for (int i=0; i < channels_out; i++)
+            float l = 0.0f, r = 0.0f;
+            for (int j=0; j < channels_in; j++)
             {
-                tmp = 0.0f;
-                for (int j=0; j < channels_in; j++)
-                    tmp += src[j] * stereo_matrix[index][j][i];
-                *dst++ = tmp;
+                l += src[j] * m[j * 2];
+                r += src[j] * m[j * 2 + 1];
             }
+            // all inputs are read before writing, dst may alias src
+            *dst++ = l;
+            *dst++ = r;
             src += channels_in;
         }
     }
-    else if (channels_out == 6)
+    else
     {
-        float tmp;
-        int index = channels_in - 6;
+        float tmp[6];
         for (int n=0; n < frames; n++)
         {
-            for (int i=0; i < channels_out; i++)
+            for (int i=0; i < 6; i++)
+                tmp[i] = 0.0f;
+            for (int j=0; j < channels_in; j++)
             {
-                tmp = 0.0f;
-                for (int j=0; j < channels_in; j++)
-                    tmp += src[j] * s51_matrix[index][j][i];
-                *dst++ = tmp;
+                const float *mj = m + j * 6;
+                for (int i=0; i < 6; i++)
+                    tmp[i] += src[j] * mj[i];
             }
+            for (int i=0; i < 6; i++)
+                *dst++ = tmp[i];
             src += channels_in;
         }
     }
-    else
-        return -1;
 
     return frames;
 }
@@ -357,6 +357,7 @@ int AudioOutputJACK::JackCallback(jack_nframes_t nframes)
     int t_jack_xruns = jack_xruns;
     for (i = 0; i < t_jack_xruns; i++)
     {
+        ReportUnderrun();
         bytes_read = GetAudioData(aubuf, fragment_size, true);
         VBERROR("Discarded one audio fragment to compensate for xrun");
     }
@@ -536,18 +536,14 @@ void AudioOutputUtil::MonoToStereo(void *dst, void *src, int samples)
 }
 
 /**
- * Adjust the volume of samples
+ * Returns the gain AdjustVolume applies for the given settings
  *
  * Makes a crude attempt to normalise the relative volumes of
  * PCM from mythmusic, PCM from video and upmixed AC-3
  */
-void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
-                                   bool music, bool upmix)
+float AudioOutputUtil::VolumeGain(int volume, bool music, bool upmix)
 {
-    float g     = volume / 100.0f;
-    float *fptr = (float *)buf;
-    int samples = len >> 2;
-    int i       = 0;
+    float g = volume / 100.0f;
 
     // Should be exponential - this'll do
     g *= g;
@@ -560,6 +556,20 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
     if (music)
         g *= 0.4f;
 
+    return g;
+}
+
+/**
+ * Adjust the volume of samples
+ */
+void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
+                                   bool music, bool upmix)
+{
+    float g     = VolumeGain(volume, music, upmix);
+    float *fptr = (float *)buf;
+    int samples = len >> 2;
+    int i       = 0;
+
     if (g == 1.0f)
         return;
 
@@ -598,6 +608,56 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
         *fptr++ *= g;
 }
 
+/**
+ * Copy len bytes of float samples from src to dst, applying gain g
+ *
+ * Lets the caller apply software volume while copying instead of
+ * making a second pass over the output
+ */
+void AudioOutputUtil::CopyAdjustVolume(void *dst, void *src, int len, float g)
+{
+    float *d    = (float *)dst;
+    float *s    = (float *)src;
+    int samples = len >> 2;
+    int i       = 0;
+
+#if ARCH_X86
+    if (sse_check() && samples >= 16)
+    {
+        int loops = samples >> 4;
+        i = loops << 4;
+
+        __asm__ volatile (
+            "movss      %3, %%xmm0          \n\t"
+            "punpckldq  %%xmm0, %%xmm0      \n\t"
+            "punpckldq  %%xmm0, %%xmm0      \n\t"
+            "1:                             \n\t"
+            "movups     (%0), %%xmm1        \n\t"
+            "movups     16(%0), %%xmm2      \n\t"
+            "mulps      %%xmm0, %%xmm1      \n\t"
+            "movups     32(%0), %%xmm3      \n\t"
+            "mulps      %%xmm0, %%xmm2      \n\t"
+            "movups     48(%0), %%xmm4      \n\t"
+            "mulps      %%xmm0, %%xmm3      \n\t"
+            "movups     %%xmm1, (%1)        \n\t"
+            "mulps      %%xmm0, %%xmm4      \n\t"
+            "movups     %%xmm2, 16(%1)      \n\t"
+            "movups     %%xmm3, 32(%1)      \n\t"
+            "movups     %%xmm4, 48(%1)      \n\t"
+            "add        $64,    %0          \n\t"
+            "add        $64,    %1          \n\t"
+            "sub        $1, %%ecx           \n\t"
+            "jnz        1b                  \n\t"
+            :"+r"(s), "+r"(d), "+c"(loops)
+            :"m"(g)
+            :"memory"
+        );
+    }
+#endif //ARCH_X86
+    for (; i < samples; i++)
+        *d++ = *s++ * g;
+}
+
 template <class AudioDataType>
 void _MuteChannel(AudioDataType *buffer, int channels, int ch, int frames)
 {
@@ -15,6 +15,8 @@ using namespace std;
 // Qt headers
 #include <QRegExp>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
 #include <QUrl>
 #include <QFile>
 #include <QFileInfo>
@@ -41,6 +43,11 @@ using namespace std;
 
 static int init_tr(void);
 
+// Pool of values shared by many programs, see ProgramInfo::InternStrings()
+static QMutex internLock;
+static QHash<QString,QString> internPool;
+static const int kMaxInternedStrings = 65536;
+
 int pginfo_init_statics() { return ProgramInfo::InitStatics(); }
 QMutex ProgramInfo::staticDataLock;
 ProgramInfoUpdater *ProgramInfo::updater;
@@ -376,6 +383,7 @@ ProgramInfo::ProgramInfo(
         originalAirDate = QDate();
 
     SetPathname(_pathname);
+    InternStrings();
 }
 
 ProgramInfo::ProgramInfo(
@@ -481,6 +489,7 @@ ProgramInfo::ProgramInfo(
     inUseForWhat(),
     positionMapDBReplacement(NULL)
 {
+    InternStrings();
 }
 
 ProgramInfo::ProgramInfo(
@@ -640,6 +649,8 @@ ProgramInfo::ProgramInfo(
             chanid = s.chanid;
         }
     }
+
+    InternStrings();
 }
 
 ProgramInfo::ProgramInfo(
@@ -739,6 +750,7 @@ ProgramInfo::ProgramInfo(
     inUseForWhat(),
     positionMapDBReplacement(NULL)
 {
+    InternStrings();
 }
 
 ProgramInfo::ProgramInfo(const QString &_pathname) :
@@ -1329,6 +1341,8 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
         positionMapDBReplacement = NULL;
     }
 
+    InternStrings();
+
     return true;
 }
 
@@ -1885,9 +1899,51 @@ bool ProgramInfo::LoadProgramFromRecorded(
     /**/// inUseForWhat
     /**/// postitionMapDBReplacement
 
+    InternStrings();
+
     return true;
 }
 
+/// \brief Returns the pooled copy of str, caller must hold internLock.
+static inline QString intern_string(const QString &str)
+{
+    if (str.isEmpty())
+        return str;
+
+    QHash<QString,QString>::const_iterator it = internPool.find(str);
+    if (it != internPool.end())
+        return *it;
+
+    if (internPool.size() < kMaxInternedStrings)
+        internPool.insert(str, str);
+
+    return str;
+}
+
+/** \fn ProgramInfo::InternStrings(void)
+ *  \brief Makes the fields which repeat across programs, such as the
+ *         channel, category and recording group, share their string data
+ *         with every other ProgramInfo holding the same value.
+ *
+ *  Large program lists otherwise hold thousands of separately allocated
+ *  copies of the same few callsigns and group names.
+ */
+void ProgramInfo::InternStrings(void)
+{
+    QMutexLocker locker(&internLock);
+
+    category            = intern_string(category);
+    chansign            = intern_string(chansign);
+    channame            = intern_string(channame);
+    chanplaybackfilters = intern_string(chanplaybackfilters);
+    recgroup            = intern_string(recgroup);
+    playgroup           = intern_string(playgroup);
+    hostname            = intern_string(hostname);
+    storagegroup        = intern_string(storagegroup);
+    inetref             = intern_string(inetref);
+    catType             = intern_string(catType);
+}
+
 /** \fn ProgramInfo::GetRecordingTypeRecPriority(RecordingType)
  *  \brief Returns recording priority change needed due to RecordingType.
  */
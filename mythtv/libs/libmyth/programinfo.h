@@ -626,6 +626,8 @@ class MPUBLIC ProgramInfo
     bool FromStringList(QStringList::const_iterator &it,
                         QStringList::const_iterator  end);
 
+    void InternStrings(void);
+
     static void QueryMarkupMap(
         const QString &video_pathname,
         frm_dir_map_t&, MarkTypes type, bool merge = false);
@@ -38,6 +38,7 @@ class AutoDeleteDeque
             delete *it;
         return list.erase(it);
     }
+    iterator insert(iterator it, T info) { return list.insert(it, info); }
     void clear(void)
     {
         while (autodelete && !list.empty())
@@ -2331,6 +2331,15 @@ void MythCommandLineParser::addUPnP(void)
     add("--noupnp", "noupnp", false, "Disable use of UPnP.", "");
 }
 
+/** \brief Canned argument definition for --startup-trace
+ */
+void MythCommandLineParser::addStartupTrace(void)
+{
+    add("--startup-trace", "startuptrace", false,
+        "Log how long each phase of startup takes.", "")
+                ->SetGroup("Logging");
+}
+
 /** \brief Canned argument definition for all logging options, including
  *  --verbose, --logpath, --quiet, --loglevel, --syslog
  *  and --nodblog
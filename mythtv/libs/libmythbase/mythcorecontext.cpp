@@ -1113,8 +1113,18 @@ void MythCoreContext::readyRead(MythSocket *sock)
         else if (message == "CLEAR_SETTINGS_CACHE")
         {
             // No need to dispatch this message to ourself, so handle it
-            LOG(VB_GENERAL, LOG_INFO, "Received remote 'Clear Cache' request");
-            ClearSettingsCache();
+            if (strlist.size() > 2 && strlist[2] != "empty")
+            {
+                // Only the listed settings changed
+                for (int i = 2; i < strlist.size(); ++i)
+                    ClearSettingsCache(strlist[i]);
+            }
+            else
+            {
+                LOG(VB_GENERAL, LOG_INFO,
+                    "Received remote 'Clear Cache' request");
+                ClearSettingsCache();
+            }
         }
         else
         {
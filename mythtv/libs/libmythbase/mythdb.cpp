@@ -4,21 +4,28 @@ using namespace std;
 #include <QReadWriteLock>
 #include <QTextStream>
 #include <QSqlError>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QFile>
 #include <QHash>
+#include <QTime>
+#include <QSet>
 #include <QDir>
+#include <QRunnable>
 
 #include "mythdb.h"
 #include "mythdbcon.h"
 #include "mythlogging.h"
 #include "mythdirs.h"
 #include "mythcorecontext.h"
+#include "mythevent.h"
+#include "mthreadpool.h"
 
 static MythDB *mythdb = NULL;
 static QMutex dbLock;
 
 // For thread safety reasons this is not a QString
+// In the settings cache it marks a setting which is not in the database
 const char *kSentinelValue = "<settings_sentinel_value>";
 const char *kClearSettingValue = "<clear_setting_value>";
 
@@ -68,6 +75,9 @@ class MythDBPrivate
     MythDBPrivate();
    ~MythDBPrivate();
 
+    void PreloadSettings(void);
+    void SendChangedSettings(void);
+
     DatabaseParams  m_DBparams;  ///< Current database host & WOL details
     QString m_localhostname;
     MDBManager m_dbmanager;
@@ -81,10 +91,23 @@ class MythDBPrivate
     SettingsMap settingsCache;
     /// Overridden this session only
     SettingsMap overriddenSettings;
+    /// True once every setting for this host has been loaded, after that
+    /// a setting missing from the cache is not in the database
+    volatile bool settingsPreloaded;
+    /// Settings cleared since the preload, these must be looked up again
+    QSet<QString> staleSettings;
+    /// Bumped whenever cached settings may have changed
+    QAtomicInt settingsGeneration;
+    QMutex preloadLock;
     /// Settings which should be written to the database as soon as it becomes
     /// available
     QList<SingleSetting> delayedSettings;
 
+    /// Settings saved here which other hosts haven't been told about yet
+    QMutex changedSettingsLock;
+    QSet<QString> changedSettings;
+    bool changedSettingsQueued;
+
     bool haveDBConnection;
     bool haveSchema;
 };
@@ -93,6 +116,8 @@ static const int settings_reserve = 61;
 
 MythDBPrivate::MythDBPrivate() :
     ignoreDatabase(false), suppressDBMessages(true), useSettingsCache(false),
+    settingsPreloaded(false), settingsGeneration(1),
+    changedSettingsQueued(false),
     haveDBConnection(false), haveSchema(false)
 {
     m_localhostname.clear();
@@ -104,6 +129,133 @@ MythDBPrivate::~MythDBPrivate()
     LOG(VB_DATABASE, LOG_INFO, "Destroying MythDBPrivate");
 }
 
+/// Sends CLEAR_SETTINGS_CACHE for settings saved on this host
+class ChangedSettingsSender : public QRunnable
+{
+  public:
+    ChangedSettingsSender(MythDBPrivate *d) : m_d(d) {}
+
+    void run(void)
+    {
+        m_d->SendChangedSettings();
+    }
+
+  private:
+    MythDBPrivate *m_d;
+};
+
+/**
+ *  \brief Tells other hosts which settings were saved, in as few
+ *         CLEAR_SETTINGS_CACHE events as possible.
+ *
+ *  Runs until no more settings are waiting, so settings saved while an
+ *  event is being sent are picked up by the next one.
+ */
+void MythDBPrivate::SendChangedSettings(void)
+{
+    while (true)
+    {
+        changedSettingsLock.lock();
+        QStringList keys = changedSettings.toList();
+        changedSettings.clear();
+        if (keys.empty())
+            changedSettingsQueued = false;
+        changedSettingsLock.unlock();
+
+        if (keys.empty())
+            return;
+
+        gCoreContext->SendEvent(MythEvent("CLEAR_SETTINGS_CACHE", keys));
+    }
+}
+
+/**
+ *  \brief Loads every setting for this host and every global setting into
+ *         the settings cache with one query.
+ */
+void MythDBPrivate::PreloadSettings(void)
+{
+    QMutexLocker locker(&preloadLock);
+
+    if (settingsPreloaded)
+        return;
+
+    int generation = settingsGeneration;
+
+    QTime timer;
+    timer.start();
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.isConnected())
+        return;
+
+    query.prepare(
+        "SELECT value, data, hostname "
+        "FROM settings "
+        "WHERE hostname = :HOSTNAME OR hostname IS NULL");
+    query.bindValue(":HOSTNAME", m_localhostname);
+
+    if (!query.exec())
+    {
+        if (!suppressDBMessages)
+            MythDB::DBError("PreloadSettings", query);
+        return;
+    }
+
+    SettingsMap hostSettings, globalSettings;
+    while (query.next())
+    {
+        QString key   = query.value(0).toString().toLower();
+        QString value = query.value(1).toString();
+        key.squeeze();
+        value.squeeze();
+
+        if (query.value(2).isNull())
+            globalSettings[key] = value;
+        else
+            hostSettings[key] = value;
+    }
+
+    settingsCacheLock.lockForWrite();
+
+    // Something was cleared while we were loading, try again later
+    if (!useSettingsCache || generation != settingsGeneration)
+    {
+        settingsCacheLock.unlock();
+        return;
+    }
+
+    SettingsMap::const_iterator it = hostSettings.begin();
+    for (; it != hostSettings.end(); ++it)
+    {
+        if (overriddenSettings.contains(it.key()))
+            continue;
+
+        QString mk2 = m_localhostname + ' ' + it.key();
+        mk2.squeeze();
+
+        settingsCache[it.key()] = *it;
+        settingsCache[mk2]      = *it;
+    }
+
+    // Host specific settings take precedence over global ones
+    for (it = globalSettings.begin(); it != globalSettings.end(); ++it)
+    {
+        if (!settingsCache.contains(it.key()))
+            settingsCache[it.key()] = *it;
+    }
+
+    staleSettings.clear();
+    settingsPreloaded = true;
+
+    settingsCacheLock.unlock();
+
+    LOG(VB_DATABASE, LOG_INFO,
+        QString("Preloaded %1 host and %2 global settings in %3 ms")
+            .arg(hostSettings.size()).arg(globalSettings.size())
+            .arg(timer.elapsed()));
+}
+
 MythDB::MythDB()
 {
     d = new MythDBPrivate();
@@ -348,6 +500,22 @@ bool MythDB::SaveSettingOnHost(const QString &key,
 
     ClearSettingsCache(host + ' ' + key);
 
+    // Let other processes drop their cached copy of the setting. Sending
+    // is a round trip to the master backend, so it is done in the
+    // background and settings saved meanwhile go out together.
+    if (success && gCoreContext &&
+        (gCoreContext->IsBackend() || gCoreContext->IsConnectedToMaster()))
+    {
+        QMutexLocker locker(&d->changedSettingsLock);
+        d->changedSettings.insert(host + ' ' + key);
+        if (!d->changedSettingsQueued)
+        {
+            d->changedSettingsQueued = true;
+            MThreadPool::globalInstance()->start(
+                new ChangedSettingsSender(d), "ChangedSettingsSender");
+        }
+    }
+
     return success;
 }
 
@@ -366,13 +534,25 @@ QString MythDB::GetSetting(const QString &_key, const QString &defaultval)
     QString key = _key.toLower();
     QString value = defaultval;
 
+    if (d->useSettingsCache && !d->settingsPreloaded &&
+        !d->ignoreDatabase && HaveValidDatabase())
+    {
+        d->PreloadSettings();
+    }
+
     d->settingsCacheLock.lockForRead();
     if (d->useSettingsCache)
     {
         SettingsMap::const_iterator it = d->settingsCache.find(key);
         if (it != d->settingsCache.end())
         {
-            value = *it;
+            if (*it != kSentinelValue)
+                value = *it;
+            d->settingsCacheLock.unlock();
+            return value;
+        }
+        if (d->settingsPreloaded && !d->staleSettings.contains(key))
+        {
             d->settingsCacheLock.unlock();
             return value;
         }
@@ -393,40 +573,33 @@ QString MythDB::GetSetting(const QString &_key, const QString &defaultval)
     if (!query.isConnected())
         return value;
 
+    // The host specific setting sorts before the global one
     query.prepare(
         "SELECT data "
         "FROM settings "
-        "WHERE value = :KEY AND hostname = :HOSTNAME");
+        "WHERE value = :KEY AND "
+        "      (hostname = :HOSTNAME OR hostname IS NULL) "
+        "ORDER BY hostname DESC "
+        "LIMIT 1");
     query.bindValue(":KEY", key);
     query.bindValue(":HOSTNAME", d->m_localhostname);
 
-    if (query.exec() && query.next())
-    {
+    bool found = query.exec() && query.next();
+    if (found)
         value = query.value(0).toString();
-    }
-    else
-    {
-        query.prepare(
-            "SELECT data "
-            "FROM settings "
-            "WHERE value = :KEY AND hostname IS NULL");
-        query.bindValue(":KEY", key);
 
-        if (query.exec() && query.next())
-        {
-            value = query.value(0).toString();
-        }
-    }
-
-    if (d->useSettingsCache && value != kSentinelValue)
+    if (d->useSettingsCache)
     {
+        // Cache misses too, so unset settings are only looked up once
+        QString cached = (found) ? value : QString(kSentinelValue);
         key.squeeze();
-        value.squeeze();
+        cached.squeeze();
         d->settingsCacheLock.lockForWrite();
+        d->staleSettings.remove(key);
         // another thread may have inserted a value into the cache
         // while we did not have the lock, check first then save
         if (d->settingsCache.find(key) == d->settingsCache.end())
-            d->settingsCache[key] = value;
+            d->settingsCache[key] = cached;
         d->settingsCacheLock.unlock();
     }
 
@@ -441,6 +614,12 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
     for (; kvit != _key_value_pairs.end(); ++kvit)
         done[kvit.key().toLower()] = false;
 
+    if (d->useSettingsCache && !d->settingsPreloaded &&
+        !d->ignoreDatabase && HaveValidDatabase())
+    {
+        d->PreloadSettings();
+    }
+
     QMap<QString,bool>::iterator dit = done.begin();
     kvit = _key_value_pairs.begin();
 
@@ -454,7 +633,14 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
                 SettingsMap::const_iterator it = d->settingsCache.find(dit.key());
                 if (it != d->settingsCache.end())
                 {
-                    *kvit = *it;
+                    if (*it != kSentinelValue)
+                        *kvit = *it;
+                    *dit = true;
+                    done_cnt++;
+                }
+                else if (d->settingsPreloaded &&
+                         !d->staleSettings.contains(dit.key()))
+                {
                     *dit = true;
                     done_cnt++;
                 }
@@ -522,12 +708,17 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
         return false;
     }
 
+    QSet<QString> found;
     while (query.next())
     {
         QString key = query.value(0).toString().toLower();
         QMap<QString,KVIt>::const_iterator it = keymap.find(key);
-        if (it != keymap.end())
+        // host specific values come first and win over global ones
+        if (it != keymap.end() && !found.contains(key))
+        {
             **it = query.value(1).toString();
+            found.insert(key);
+        }
     }
 
     if (d->useSettingsCache)
@@ -536,7 +727,10 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
         QMap<QString,KVIt>::const_iterator it = keymap.begin();
         for (; it != keymap.end(); ++it)
         {
-            QString key = it.key(), value = **it;
+            QString key = it.key();
+            QString value = (found.contains(key)) ? **it :
+                QString(kSentinelValue);
+            d->staleSettings.remove(key);
 
             // another thread may have inserted a value into the cache
             // while we did not have the lock, check first then save
@@ -605,7 +799,14 @@ QString MythDB::GetSettingOnHost(const QString &_key, const QString &_host,
         SettingsMap::const_iterator it = d->settingsCache.find(myKey);
         if (it != d->settingsCache.end())
         {
-            value = *it;
+            if (*it != kSentinelValue)
+                value = *it;
+            d->settingsCacheLock.unlock();
+            return value;
+        }
+        if (d->settingsPreloaded && host == d->m_localhostname &&
+            !d->staleSettings.contains(myKey))
+        {
             d->settingsCacheLock.unlock();
             return value;
         }
@@ -639,18 +840,19 @@ QString MythDB::GetSettingOnHost(const QString &_key, const QString &_host,
     query.bindValue(":VALUE", key);
     query.bindValue(":HOSTNAME", host);
 
-    if (query.exec() && query.next())
-    {
+    bool found = query.exec() && query.next();
+    if (found)
         value = query.value(0).toString();
-    }
 
-    if (d->useSettingsCache && value != kSentinelValue)
+    if (d->useSettingsCache)
     {
+        QString cached = (found) ? value : QString(kSentinelValue);
         myKey.squeeze();
-        value.squeeze();
+        cached.squeeze();
         d->settingsCacheLock.lockForWrite();
+        d->staleSettings.remove(myKey);
         if (d->settingsCache.find(myKey) == d->settingsCache.end())
-            d->settingsCache[myKey] = value;
+            d->settingsCache[myKey] = cached;
         d->settingsCacheLock.unlock();
     }
 
@@ -787,6 +989,7 @@ void MythDB::OverrideSettingForSession(
     d->overriddenSettings[mk] = mv;
     d->settingsCache[mk]      = mv;
     d->settingsCache[mk2]     = mv;
+    d->settingsGeneration.ref();
     d->settingsCacheLock.unlock();
 }
 
@@ -810,6 +1013,10 @@ void MythDB::ClearOverrideSettingForSession(const QString &key)
     if (sit != d->settingsCache.end())
         d->settingsCache.erase(sit);
 
+    d->staleSettings.insert(mk);
+    d->staleSettings.insert(mk2);
+    d->settingsGeneration.ref();
+
     d->settingsCacheLock.unlock();
 }
 
@@ -845,6 +1052,8 @@ void MythDB::ClearSettingsCache(const QString &_key)
         LOG(VB_DATABASE, LOG_INFO, "Clearing Settings Cache.");
         d->settingsCache.clear();
         d->settingsCache.reserve(settings_reserve);
+        d->staleSettings.clear();
+        d->settingsPreloaded = false;
 
         SettingsMap::const_iterator it = d->overriddenSettings.begin();
         for (; it != d->overriddenSettings.end(); ++it)
@@ -860,16 +1069,29 @@ void MythDB::ClearSettingsCache(const QString &_key)
     {
         QString myKey = _key.toLower();
         clear(d->settingsCache, d->overriddenSettings, myKey);
+        d->staleSettings.insert(myKey);
 
         // To be safe always clear any local[ized] version too
         QString mkl = myKey.section(QChar(' '), 1);
         if (!mkl.isEmpty())
+        {
             clear(d->settingsCache, d->overriddenSettings, mkl);
+            d->staleSettings.insert(mkl);
+        }
     }
 
+    d->settingsGeneration.ref();
+
     d->settingsCacheLock.unlock();
 }
 
+/// \brief Returns a counter which changes whenever cached settings may
+///        have changed.
+uint MythDB::GetSettingsGeneration(void) const
+{
+    return (uint)(int)d->settingsGeneration;
+}
+
 void MythDB::ActivateSettingsCache(bool activate)
 {
     if (activate)
@@ -936,3 +1158,50 @@ bool MythDB::HaveValidDatabase(void) const
 {
     return (d->haveDBConnection && d->haveSchema);
 }
+
+MythSettingHandle::MythSettingHandle(
+    const QString &key, const QString &defaultval) :
+    m_key(key.toLower()), m_default(defaultval),
+    m_generation(0), m_num(0), m_float(0.0)
+{
+}
+
+MythSettingHandle::MythSettingHandle(const QString &key, int defaultval) :
+    m_key(key.toLower()), m_default(QString::number(defaultval)),
+    m_generation(0), m_num(0), m_float(0.0)
+{
+}
+
+QString MythSettingHandle::GetString(void)
+{
+    QMutexLocker locker(&m_lock);
+    Update();
+    return m_value;
+}
+
+int MythSettingHandle::GetNum(void)
+{
+    QMutexLocker locker(&m_lock);
+    Update();
+    return m_num;
+}
+
+double MythSettingHandle::GetFloat(void)
+{
+    QMutexLocker locker(&m_lock);
+    Update();
+    return m_float;
+}
+
+void MythSettingHandle::Update(void)
+{
+    MythDB *db = GetMythDB();
+    uint generation = db->GetSettingsGeneration();
+    if (generation == m_generation)
+        return;
+
+    m_value      = db->GetSetting(m_key, m_default);
+    m_num        = m_value.toInt();
+    m_float      = m_value.toDouble();
+    m_generation = generation;
+}
@@ -2,6 +2,7 @@
 #define MYTHDB_H_
 
 #include <QMap>
+#include <QMutex>
 #include <QString>
 #include <QVariant>
 #include "mythbaseexp.h"
@@ -35,6 +36,7 @@ class MBASE_PUBLIC MythDB
 
     void ClearSettingsCache(const QString &key = QString());
     void ActivateSettingsCache(bool activate = true);
+    uint GetSettingsGeneration(void) const;
     void OverrideSettingForSession(const QString &key, const QString &newValue);
     void ClearOverrideSettingForSession(const QString &key);
 
@@ -95,4 +97,34 @@ class MBASE_PUBLIC MythDB
  MBASE_PUBLIC  MythDB *GetMythDB();
  MBASE_PUBLIC  void DestroyMythDB();
 
+/** \class MythSettingHandle
+ *  \brief A setting looked up once and then read without touching the
+ *         settings cache until the cache is next cleared.
+ *
+ *  Meant for settings read on hot paths, e.g. as a function level static.
+ */
+class MBASE_PUBLIC MythSettingHandle
+{
+  public:
+    MythSettingHandle(const QString &key,
+                      const QString &defaultval = QString());
+    MythSettingHandle(const QString &key, int defaultval);
+
+    QString GetString(void);
+    int     GetNum(void);
+    double  GetFloat(void);
+
+  private:
+    void Update(void);
+
+    QString m_key;
+    QString m_default;
+
+    QMutex  m_lock;
+    uint    m_generation;
+    QString m_value;
+    int     m_num;
+    double  m_float;
+};
+
 #endif
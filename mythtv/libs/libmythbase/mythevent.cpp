@@ -1,3 +1,5 @@
+#include <QMutex>
+
 #include "mythevent.h"
 
 QEvent::Type MythEvent::MythEventMessage =
@@ -30,3 +32,35 @@ QEvent::Type MythEvent::kEnableUDPListenerEventType =
     (QEvent::Type) QEvent::registerEventType();
 QEvent::Type ExternalKeycodeEvent::kEventType =
     (QEvent::Type) QEvent::registerEventType();
+
+static QMutex            topicLock;
+static QHash<QString,int> topicIds;
+
+/** \fn MythEvent::RegisterTopic(const QString&)
+ *  \brief Returns the topic id for an event name, the first word of
+ *         the message, e.g. "RECORDING_LIST_CHANGE".
+ */
+int MythEvent::RegisterTopic(const QString &name)
+{
+    QMutexLocker locker(&topicLock);
+
+    QHash<QString,int>::const_iterator it = topicIds.find(name);
+    if (it != topicIds.end())
+        return *it;
+
+    int id = topicIds.size();
+    topicIds[name] = id;
+    return id;
+}
+
+/// \brief Returns the topic id of this event's message.
+int MythEvent::Topic(void) const
+{
+    if (topic == kTopicUnknown)
+    {
+        int space = message.indexOf(' ');
+        topic = RegisterTopic((space < 0) ? message : message.left(space));
+    }
+
+    return topic;
+}
@@ -2,6 +2,7 @@
 #define MYTHEVENT_H_
 
 #include <QStringList>
+#include <QSharedPointer>
 #include <QEvent>
 #include <QHash>
 
@@ -16,11 +17,12 @@
 class MBASE_PUBLIC MythEvent : public QEvent
 {
   public:
-    MythEvent(int t) : QEvent((QEvent::Type)t)
+    MythEvent(int t) : QEvent((QEvent::Type)t), topic(kTopicUnknown)
     { }
 
     // lmessage is passed by value for thread safety reasons per DanielK
-    MythEvent(int t, const QString lmessage) : QEvent((QEvent::Type)t)
+    MythEvent(int t, const QString lmessage) : QEvent((QEvent::Type)t),
+        topic(kTopicUnknown)
     {
         message = lmessage;
         extradata.append( "empty" );
@@ -28,14 +30,15 @@ class MBASE_PUBLIC MythEvent : public QEvent
 
     // lmessage is passed by value for thread safety reasons per DanielK
     MythEvent(int t, const QString lmessage, const QStringList &lextradata)
-           : QEvent((QEvent::Type)t)
+           : QEvent((QEvent::Type)t), topic(kTopicUnknown)
     {
         message = lmessage;
         extradata = lextradata;
     }
 
     // lmessage is passed by value for thread safety reasons per DanielK
-    MythEvent(const QString lmessage) : QEvent(MythEventMessage)
+    MythEvent(const QString lmessage) : QEvent(MythEventMessage),
+        topic(kTopicUnknown)
     {
         message = lmessage;
         extradata.append( "empty" );
@@ -43,7 +46,7 @@ class MBASE_PUBLIC MythEvent : public QEvent
 
     // lmessage is passed by value for thread safety reasons per DanielK
     MythEvent(const QString lmessage, const QStringList &lextradata)
-           : QEvent((QEvent::Type)MythEventMessage)
+           : QEvent((QEvent::Type)MythEventMessage), topic(kTopicUnknown)
     {
         message = lmessage;
         extradata = lextradata;
@@ -51,7 +54,7 @@ class MBASE_PUBLIC MythEvent : public QEvent
 
     // lmessage is passed by value for thread safety reasons per DanielK
     MythEvent(const QString lmessage, const QString lextradata)
-           : QEvent((QEvent::Type)MythEventMessage)
+           : QEvent((QEvent::Type)MythEventMessage), topic(kTopicUnknown)
     {
         message = lmessage;
         extradata.append( lextradata );
@@ -65,9 +68,14 @@ class MBASE_PUBLIC MythEvent : public QEvent
     const QStringList& ExtraDataList() const { return extradata; }
     int ExtraDataCount() const { return extradata.size(); }
 
+    int Topic(void) const;
+    static int RegisterTopic(const QString &name);
+
     virtual MythEvent *clone() const
     { return new MythEvent(message, extradata); }
 
+    static const int kTopicUnknown = -1;
+
     static Type MythEventMessage;
     static Type MythUserMessage;
     static Type kUpdateTvProgressEventType;
@@ -86,6 +94,36 @@ class MBASE_PUBLIC MythEvent : public QEvent
   private:
     QString message;
     QStringList extradata;
+    mutable int topic;
+};
+
+/** \class MythTypedEvent
+ *  \brief A MythEvent carrying a typed payload.
+ *
+ *  The payload is shared by every copy made while dispatching, so
+ *  listeners in this process get it without any copying or parsing.
+ *  The message and extra data are still set, so string based listeners
+ *  and listeners in other processes see an ordinary MythEvent.
+ */
+template <typename T>
+class MythTypedEvent : public MythEvent
+{
+  public:
+    MythTypedEvent(const QString &lmessage, const QStringList &lextradata,
+                   const T &lpayload) :
+        MythEvent(lmessage, lextradata), payload(new T(lpayload)) { }
+
+    const T &Payload(void) const { return *payload; }
+
+    virtual MythEvent *clone() const
+    { return new MythTypedEvent<T>(Message(), ExtraDataList(), payload); }
+
+  private:
+    MythTypedEvent(const QString &lmessage, const QStringList &lextradata,
+                   const QSharedPointer<const T> &lpayload) :
+        MythEvent(lmessage, lextradata), payload(lpayload) { }
+
+    QSharedPointer<const T> payload;
 };
 
 class MBASE_PUBLIC ExternalKeycodeEvent : public QEvent
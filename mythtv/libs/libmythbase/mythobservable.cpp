@@ -11,6 +11,9 @@
  *  listeners and iterating across them. It is typically used to post
  *  events to listening QObjects.
  *
+ *  Listeners may subscribe to only some topics, the first word of the
+ *  event message, in which case they are never sent other events.
+ *
  *  MythEvents can be dispatched to all listeners by calling dispatch
  *  or dispatchNow. The former is much preferred as it uses
  *  QCoreApplication::postEvent() while the latter uses the blocking
@@ -30,6 +33,7 @@ MythObservable::~MythObservable()
 {
     m_lock->lock();
     m_listeners.clear();
+    m_topicListeners.clear();
     m_lock->unlock();
     delete m_lock;
     m_lock = NULL;
@@ -52,6 +56,29 @@ void MythObservable::addListener(QObject *listener)
 }
 
 
+/** \brief Add a listener for some topics to the observable
+ *
+ *  Adds the given QObject to the list of objects that observe
+ *  this observable, it is only sent events whose message starts
+ *  with one of the given topics, e.g. "SCHEDULE_CHANGE".
+ *
+ *  \param listener the QObject that will listen to this observable
+ *  \param topics   the event names the listener wants
+ */
+void MythObservable::addListener(QObject *listener, const QStringList &topics)
+{
+    if (!listener)
+        return;
+
+    QList<int> ids;
+    for (int i = 0; i < topics.size(); ++i)
+        ids.push_back(MythEvent::RegisterTopic(topics[i]));
+
+    QMutexLocker locker(m_lock);
+    for (int i = 0; i < ids.size(); ++i)
+        m_topicListeners[ids[i]].insert(listener);
+}
+
 /** \brief Remove a listener to the observable
  *
  *  Remove the given QObject from the list of objects that
@@ -65,6 +92,17 @@ void MythObservable::removeListener(QObject *listener)
     {
         QMutexLocker locker(m_lock);
         m_listeners.remove(listener);
+
+        QHash<int, QSet<QObject*> >::iterator it = m_topicListeners.begin();
+        while (it != m_topicListeners.end())
+        {
+            it->remove(listener);
+            if (it->isEmpty())
+                it = m_topicListeners.erase(it);
+            else
+                ++it;
+        }
+
         QCoreApplication::removePostedEvents(listener);
     }
 }
@@ -79,11 +117,24 @@ void MythObservable::removeListener(QObject *listener)
  */
 void MythObservable::dispatch(const MythEvent &event)
 {
+    int topic = event.Topic();
+
     QMutexLocker locker(m_lock);
 
     QSet<QObject*>::const_iterator it = m_listeners.begin();
     for (; it != m_listeners.end() ; ++it)
         QCoreApplication::postEvent(*it, event.clone());
+
+    QHash<int, QSet<QObject*> >::const_iterator tit =
+        m_topicListeners.find(topic);
+    if (tit == m_topicListeners.end())
+        return;
+
+    for (it = tit->begin(); it != tit->end(); ++it)
+    {
+        if (!m_listeners.contains(*it))
+            QCoreApplication::postEvent(*it, event.clone());
+    }
 }
 
 /** \brief Dispatch an event to all listeners
@@ -96,10 +147,23 @@ void MythObservable::dispatch(const MythEvent &event)
  */
 void MythObservable::dispatchNow(const MythEvent &event)
 {
+    int topic = event.Topic();
+
     QMutexLocker locker(m_lock);
 
     QSet<QObject*>::const_iterator it = m_listeners.begin();
     for (; it != m_listeners.end() ; ++it)
         QCoreApplication::sendEvent(*it, event.clone());
+
+    QHash<int, QSet<QObject*> >::const_iterator tit =
+        m_topicListeners.find(topic);
+    if (tit == m_topicListeners.end())
+        return;
+
+    for (it = tit->begin(); it != tit->end(); ++it)
+    {
+        if (!m_listeners.contains(*it))
+            QCoreApplication::sendEvent(*it, event.clone());
+    }
 }
 
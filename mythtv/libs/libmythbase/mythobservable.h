@@ -2,6 +2,8 @@
 #define MYTHOBSERVABLE_H_
 
 #include <QSet>
+#include <QHash>
+#include <QStringList>
 #include "mythevent.h"
 #include "mythbaseexp.h"
 
@@ -15,17 +17,21 @@ class MBASE_PUBLIC MythObservable
     virtual ~MythObservable();
 
     void addListener(QObject *listener);
+    void addListener(QObject *listener, const QStringList &topics);
     void removeListener(QObject *listener);
 
     void dispatch(const MythEvent &event);
 
     void dispatchNow(const MythEvent &event); // MDEPRECATED;
 
-    bool hasListeners(void) { return !m_listeners.isEmpty(); }
+    bool hasListeners(void)
+        { return !m_listeners.isEmpty() || !m_topicListeners.isEmpty(); }
 
   protected:
     QMutex         *m_lock;
     QSet<QObject*>  m_listeners;
+    /// Listeners which only want events on some topics, by topic id
+    QHash<int, QSet<QObject*> > m_topicListeners;
 };
 
 #endif /* MYTHOBSERVABLE_H */
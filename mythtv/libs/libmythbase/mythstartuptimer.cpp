@@ -0,0 +1,71 @@
+// Qt headers
+#include <QMutexLocker>
+#include <QMutex>
+#include <QTime>
+
+// MythTV headers
+#include "mythstartuptimer.h"
+#include "mythlogging.h"
+
+#define LOC QString("Startup: ")
+
+static QMutex s_lock;
+static bool   s_enabled  = false;
+static QTime  s_timer;
+static int    s_lastMark = 0;
+
+/** \brief Starts or stops tracing. The timeline is measured from the
+ *         first call that enables it.
+ */
+void MythStartupTimer::Enable(bool enable)
+{
+    QMutexLocker locker(&s_lock);
+
+    if (enable && !s_enabled)
+    {
+        s_timer.start();
+        s_lastMark = 0;
+    }
+    s_enabled = enable;
+}
+
+bool MythStartupTimer::IsEnabled(void)
+{
+    QMutexLocker locker(&s_lock);
+    return s_enabled;
+}
+
+/// Logs the time taken since the previous mark by the named phase.
+void MythStartupTimer::Mark(const QString &phase)
+{
+    QMutexLocker locker(&s_lock);
+
+    if (!s_enabled)
+        return;
+
+    int now = s_timer.elapsed();
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("%1 took %2 ms, at %3 ms")
+        .arg(phase).arg(now - s_lastMark).arg(now));
+    s_lastMark = now;
+}
+
+MythStartupTimer::MythStartupTimer(const QString &phase) :
+    m_phase(phase), m_start(-1)
+{
+    QMutexLocker locker(&s_lock);
+
+    if (s_enabled)
+        m_start = s_timer.elapsed();
+}
+
+MythStartupTimer::~MythStartupTimer()
+{
+    QMutexLocker locker(&s_lock);
+
+    if (!s_enabled || m_start < 0)
+        return;
+
+    int now = s_timer.elapsed();
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("%1 took %2 ms, from %3 to %4 ms")
+        .arg(m_phase).arg(now - m_start).arg(m_start).arg(now));
+}
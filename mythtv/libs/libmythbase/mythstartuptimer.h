@@ -0,0 +1,34 @@
+#ifndef MYTHSTARTUPTIMER_H_
+#define MYTHSTARTUPTIMER_H_
+
+#include <QString>
+
+#include "mythbaseexp.h"
+
+/** \class MythStartupTimer
+ *  \brief Logs a timeline of application startup.
+ *
+ *  Tracing is off unless Enable() is called, normally because the
+ *  --startup-trace option was given, and costs nothing when it is off.
+ *
+ *  Sequential startup code calls Mark() at the end of each phase, which
+ *  logs the time since the previous mark. Work that runs out of line,
+ *  such as deferred initialization, is timed by a scoped instance that
+ *  logs when it is destroyed.
+ */
+class MBASE_PUBLIC MythStartupTimer
+{
+  public:
+    MythStartupTimer(const QString &phase);
+   ~MythStartupTimer();
+
+    static void Enable(bool enable);
+    static bool IsEnabled(void);
+    static void Mark(const QString &phase);
+
+  private:
+    QString m_phase;
+    int     m_start;
+};
+
+#endif
@@ -23,6 +23,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <cmath>
 #include <vector>
 #ifdef USE_FFTW3
+#include <map>
+#include <QMutex>
 #include "fftw3.h"
 #else
 extern "C" {
@@ -43,6 +45,39 @@ static const float PI = 3.141592654;
 static const float epsilon = 0.000001;
 static const float center_level = 0.5*sqrt(0.5);
 
+#ifdef USE_FFTW3
+// FFTW_MEASURE planning takes far longer than decoding a block, so the
+// plans are made once per block size and shared by every decoder; they are
+// run through the new-array execute functions on each decoder's own buffers,
+// which fftwf_malloc() aligns the same way as the planning buffers.
+struct fftw_plans
+{
+    fftwf_plan load;   // real to complex, used for both input channels
+    fftwf_plan store;  // complex to real, used for every output channel
+};
+
+static QMutex plan_lock;
+static std::map<unsigned, fftw_plans> plan_cache;
+
+static fftw_plans get_plans(unsigned N)
+{
+    QMutexLocker locker(&plan_lock);
+    std::map<unsigned, fftw_plans>::iterator it = plan_cache.find(N);
+    if (it != plan_cache.end())
+        return it->second;
+
+    float *t = (float*)fftwf_malloc(sizeof(float)*N);
+    fftwf_complex *c = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
+    fftw_plans plans;
+    plans.load = fftwf_plan_dft_r2c_1d(N, t, c, FFTW_MEASURE);
+    plans.store = fftwf_plan_dft_c2r_1d(N, c, t, FFTW_MEASURE);
+    fftwf_free(c);
+    fftwf_free(t);
+    plan_cache[N] = plans;
+    return plans;
+}
+#endif
+
 // private implementation of the surround decoder
 class decoder_impl {
 public:
@@ -57,9 +92,7 @@ public:
         dftL = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
         dftR = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
         src = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
-        loadL = fftwf_plan_dft_r2c_1d(N, lt, dftL,FFTW_MEASURE);
-        loadR = fftwf_plan_dft_r2c_1d(N, rt, dftR,FFTW_MEASURE);
-        store = fftwf_plan_dft_c2r_1d(N, src, dst,FFTW_MEASURE);    
+        plans = get_plans(N);
 #else
         // create lavc fft buffers
         lt = (float*)av_malloc(sizeof(FFTSample)*N);
@@ -71,8 +104,11 @@ public:
         memset(fftContextForward, 0, sizeof(FFTContext));
         fftContextReverse = (FFTContext*)av_malloc(sizeof(FFTContext));
         memset(fftContextReverse, 0, sizeof(FFTContext));
-        ff_fft_init(fftContextForward, 13, 0);
-        ff_fft_init(fftContextReverse, 13, 1);
+        int nbits = 0;
+        while ((1U << nbits) < N)
+            nbits++;
+        ff_fft_init(fftContextForward, nbits, 0);
+        ff_fft_init(fftContextReverse, nbits, 1);
 #endif
         // resize our own buffers
         frontR.resize(N);
@@ -107,10 +143,7 @@ public:
     // destructor
     ~decoder_impl() {
 #ifdef USE_FFTW3
-        // clean up the FFTW stuff
-        fftwf_destroy_plan(store);
-        fftwf_destroy_plan(loadR);
-        fftwf_destroy_plan(loadL);
+        // clean up the FFTW stuff, the plans stay in the cache
         fftwf_free(src); 
         fftwf_free(dftR);
         fftwf_free(dftL);
@@ -204,6 +237,8 @@ public:
         const float modes[4][2] = {{0,0},{0,PI},{PI,0},{-PI/2,PI/2}};
         phase_offsetL = modes[mode][0];
         phase_offsetR = modes[mode][1];
+        phase_rotL = polar(1,phase_offsetL);
+        phase_rotR = polar(1,phase_offsetR);
     }
 
     // what steering mode should be chosen
@@ -220,6 +255,10 @@ private:
     static inline float amplitude(const float cf[2]) { return sqrt(cf[0]*cf[0] + cf[1]*cf[1]); }
     static inline float phase(const float cf[2]) { return atan2(cf[1],cf[0]); }
     static inline cfloat polar(float a, float p) { return cfloat(a*cos(p),a*sin(p)); }
+    // complex product, without the inf/nan recovery of operator*
+    static inline cfloat rotate(const cfloat &a, const cfloat &r) {
+        return cfloat(a.real()*r.real() - a.imag()*r.imag(), a.real()*r.imag() + a.imag()*r.real());
+    }
     static inline float sqr(float x) { return x*x; }
     // the dreaded min/max
     static inline float min(float a, float b) { return a<b?a:b; }
@@ -258,122 +297,138 @@ private:
 
 #ifdef USE_FFTW3
         // ... and tranform it into the frequency domain
-        fftwf_execute(loadL);
-        fftwf_execute(loadR);
+        fftwf_execute_dft_r2c(plans.load, lt, dftL);
+        fftwf_execute_dft_r2c(plans.load, rt, dftR);
 #else
-        ff_fft_permuteRC(fftContextForward, lt, (FFTComplex*)&dftL[0]);
-        av_fft_calc(fftContextForward, (FFTComplex*)&dftL[0]);
-
-        ff_fft_permuteRC(fftContextForward, rt, (FFTComplex*)&dftR[0]);
-        av_fft_calc(fftContextForward, (FFTComplex*)&dftR[0]);
+        // ... and tranform it into the frequency domain; both channels are real, so they
+        // go through one complex FFT as its real and imaginary parts and are split after
+        ff_fft_permuteRC(fftContextForward, lt, rt, (FFTComplex*)&src[0]);
+        av_fft_calc(fftContextForward, (FFTComplex*)&src[0]);
+        for (unsigned f=0;f<halfN;f++) {
+            const FFTSample *z = src[f], *n = src[(N-f)&(N-1)];
+            dftL[f][0] = 0.5f*(z[0]+n[0]);
+            dftL[f][1] = 0.5f*(z[1]-n[1]);
+            dftR[f][0] = 0.5f*(z[1]+n[1]);
+            dftR[f][1] = 0.5f*(n[0]-z[0]);
+        }
 #endif
 
         // 2. compare amplitude and phase of each DFT bin and produce the X/Y coordinates in the sound field
         //    but dont do DC or N/2 component
-        for (unsigned f=0;f<halfN;f++) {           
-            // get left/right amplitudes/phases
-            float ampL = amplitude(dftL[f]), ampR = amplitude(dftR[f]);
-            float phaseL = phase(dftL[f]), phaseR = phase(dftR[f]);
-//          if (ampL+ampR < epsilon)
-//              continue;       
-
-            // calculate the amplitude/phase difference
-            float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-            float phaseDiff = phaseL - phaseR;
-            if (phaseDiff < -PI) phaseDiff += 2*PI;
-            if (phaseDiff > PI) phaseDiff -= 2*PI;
-            phaseDiff = abs(phaseDiff);
+        //    the phase difference is the angle of L*conj(R), which is already wrapped to [-PI,PI], and the
+        //    positioned signals keep the bin phases by scaling the bins instead of going through polar form
+        for (unsigned f=0;f<halfN;f++) {
+            // get left/right amplitudes
+            float lr = dftL[f][0], li = dftL[f][1];
+            float rr = dftR[f][0], ri = dftR[f][1];
+            float ampL = sqrtf(lr*lr + li*li), ampR = sqrtf(rr*rr + ri*ri);
+            float ampSum = ampL+ampR;
+
+            // calculate the amplitude/phase difference, the mapping to the sound field is done below
+            xfs[f] = clamp((ampSum < epsilon) ? 0 : (ampR-ampL) / ampSum);
+            yfs[f] = fabsf(atan2f(li*rr - lr*ri, lr*rr + li*ri));
 
-            if (linear_steering) {
-                // --- this is the fancy new linear mode ---
+            // ... and build the signal which we want to position
+            frontL[f] = ampL > 0 ? cfloat(ampSum*(lr/ampL),ampSum*(li/ampL)) : cfloat(ampSum,0);
+            frontR[f] = ampR > 0 ? cfloat(ampSum*(rr/ampR),ampSum*(ri/ampR)) : cfloat(ampSum,0);
+            avg[f] = frontL[f] + frontR[f];
+            surL[f] = rotate(frontL[f],phase_rotL);
+            surR[f] = rotate(frontR[f],phase_rotR);
+            trueavg[f] = cfloat(lr + rr, li + ri);
+        }
+
+        if (linear_steering) {
+            // --- this is the fancy new linear mode ---
+            for (unsigned f=0;f<halfN;f++) {
+                float ampDiff = xfs[f], phaseDiff = yfs[f];
 
                 // get sound field x/y position
-                yfs[f] = get_yfs(ampDiff,phaseDiff);
-                xfs[f] = get_xfs(ampDiff,yfs[f]);
+                float y = get_yfs(ampDiff,phaseDiff);
+                float x = get_xfs(ampDiff,y);
 
                 // add dimension control
-                yfs[f] = clamp(yfs[f] - dimension);
+                y = clamp(y - dimension);
 
                 // add crossfeed control
-                xfs[f] = clamp(xfs[f] * (front_separation*(1+yfs[f])/2 + rear_separation*(1-yfs[f])/2));
-
-                // 3. generate frequency filters for each output channel
-                float left = (1-xfs[f])/2, right = (1+xfs[f])/2;
-                float front = (1+yfs[f])/2, back = (1-yfs[f])/2;
-                float volume[5] = {
-                    front * (left * center_width + max(0,-xfs[f]) * (1-center_width)),  // left
-                    front * center_level*((1-abs(xfs[f])) * (1-center_width)),          // center
-                    front * (right * center_width + max(0, xfs[f]) * (1-center_width)), // right
-                    back * surround_level * left,                                       // left surround
-                    back * surround_level * right                                       // right surround
-                };
-
-                // adapt the prior filter
-                for (unsigned c=0;c<5;c++)
-                    filter[c][f] = (1-adaption_rate)*filter[c][f] + adaption_rate*volume[c];
-
-            } else {
-                // --- this is the old & simple steering mode ---
-
-                // calculate the amplitude/phase difference
-                float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-                float phaseDiff = phaseL - phaseR;
-                if (phaseDiff < -PI) phaseDiff += 2*PI;
-                if (phaseDiff > PI) phaseDiff -= 2*PI;
-                phaseDiff = abs(phaseDiff);
-
+                xfs[f] = clamp(x * (front_separation*(1+y)/2 + rear_separation*(1-y)/2));
+                yfs[f] = y;
+            }
+        } else {
+            // --- this is the old & simple steering mode ---
+            for (unsigned f=0;f<halfN;f++) {
                 // determine sound field x-position
-                xfs[f] = ampDiff;
+                float x = xfs[f];
 
                 // determine preliminary sound field y-position from phase difference
-                yfs[f] = 1 - (phaseDiff/PI)*2;
+                float y = 1 - (yfs[f]/PI)*2;
 
-                if (abs(xfs[f]) > surround_balance) {
+                if (fabsf(x) > surround_balance) {
                     // blend linearly between the surrounds and the fronts if the balance exceeds the surround encoding balance
                     // this is necessary because the sound field is trapezoidal and will be stretched behind the listener
-                    float frontness = (abs(xfs[f]) - surround_balance)/(1-surround_balance);
-                    yfs[f]  = (1-frontness) * yfs[f] + frontness * 1; 
+                    float frontness = (fabsf(x) - surround_balance)/(1-surround_balance);
+                    y = (1-frontness) * y + frontness * 1;
                 }
 
                 // add dimension control
-                yfs[f] = clamp(yfs[f] - dimension);
+                y = clamp(y - dimension);
 
                 // add crossfeed control
-                xfs[f] = clamp(xfs[f] * (front_separation*(1+yfs[f])/2 + rear_separation*(1-yfs[f])/2));
-
-                // 3. generate frequency filters for each output channel, according to the signal position
-                // the sum of all channel volumes must be 1.0
-                float left = (1-xfs[f])/2, right = (1+xfs[f])/2;
-                float front = (1+yfs[f])/2, back = (1-yfs[f])/2;
-                float volume[5] = {
-                    front * (left * center_width + max(0,-xfs[f]) * (1-center_width)),      // left
-                    front * center_level*((1-abs(xfs[f])) * (1-center_width)),              // center
-                    front * (right * center_width + max(0, xfs[f]) * (1-center_width)),     // right
-                    back * surround_level*max(0,min(1,((1-(xfs[f]/surround_balance))/2))),  // left surround
-                    back * surround_level*max(0,min(1,((1+(xfs[f]/surround_balance))/2)))   // right surround
-                };
-
-                // adapt the prior filter
-                for (unsigned c=0;c<5;c++)
-                    filter[c][f] = (1-adaption_rate)*filter[c][f] + adaption_rate*volume[c];
+                xfs[f] = clamp(x * (front_separation*(1+y)/2 + rear_separation*(1-y)/2));
+                yfs[f] = y;
             }
+        }
 
-            // ... and build the signal which we want to position
-            frontL[f] = polar(ampL+ampR,phaseL);
-            frontR[f] = polar(ampL+ampR,phaseR);
-            avg[f] = frontL[f] + frontR[f];
-            surL[f] = polar(ampL+ampR,phaseL+phase_offsetL);
-            surR[f] = polar(ampL+ampR,phaseR+phase_offsetR);
-            trueavg[f] = cfloat(dftL[f][0] + dftR[f][0], dftL[f][1] + dftR[f][1]);
+        // 3. generate frequency filters for each output channel, according to the signal position,
+        //    and adapt the prior filters; the sum of all channel volumes must be 1.0
+        //    these loops are straight arithmetic so that the compiler can vectorize them
+        {
+            const float *px = &xfs[0], *py = &yfs[0];
+            float *fL = &filter[0][0], *fC = &filter[1][0], *fR = &filter[2][0];
+            float *fLS = &filter[3][0], *fRS = &filter[4][0];
+            const float rate = adaption_rate, keep = 1-adaption_rate;
+            const float width = center_width, narrow = 1-center_width;
+            const float level = surround_level, balance = surround_balance;
+            if (linear_steering) {
+                for (unsigned f=0;f<halfN;f++) {
+                    float x = px[f], y = py[f];
+                    float left = (1-x)/2, right = (1+x)/2;
+                    float front = (1+y)/2, back = (1-y)/2;
+                    fL[f]  = keep*fL[f]  + rate*(front * (left * width + max(0,-x) * narrow));
+                    fC[f]  = keep*fC[f]  + rate*(front * center_level*((1-fabsf(x)) * narrow));
+                    fR[f]  = keep*fR[f]  + rate*(front * (right * width + max(0, x) * narrow));
+                    fLS[f] = keep*fLS[f] + rate*(back * level * left);
+                    fRS[f] = keep*fRS[f] + rate*(back * level * right);
+                }
+            } else {
+                for (unsigned f=0;f<halfN;f++) {
+                    float x = px[f], y = py[f];
+                    float left = (1-x)/2, right = (1+x)/2;
+                    float front = (1+y)/2, back = (1-y)/2;
+                    fL[f]  = keep*fL[f]  + rate*(front * (left * width + max(0,-x) * narrow));
+                    fC[f]  = keep*fC[f]  + rate*(front * center_level*((1-fabsf(x)) * narrow));
+                    fR[f]  = keep*fR[f]  + rate*(front * (right * width + max(0, x) * narrow));
+                    fLS[f] = keep*fLS[f] + rate*(back * level*max(0,min(1,((1-(x/balance))/2))));
+                    fRS[f] = keep*fRS[f] + rate*(back * level*max(0,min(1,((1+(x/balance))/2))));
+                }
+            }
         }
 
         // 4. distribute the unfiltered reference signals over the channels
+#ifdef USE_FFTW3
         apply_filter(&frontL[0],&filter[0][0],&output[0][0]);   // front left
         apply_filter(&avg[0], &filter[1][0],&output[1][0]);     // front center
         apply_filter(&frontR[0],&filter[2][0],&output[2][0]);   // front right
         apply_filter(&surL[0],&filter[3][0],&output[3][0]);     // surround left
         apply_filter(&surR[0],&filter[4][0],&output[4][0]);     // surround right
         apply_filter(&trueavg[0],&filter[5][0],&output[5][0]);  // lfe
+#else
+        apply_filter(&frontL[0],&filter[0][0],&output[0][0],    // front left
+                     &avg[0], &filter[1][0],&output[1][0]);     // front center
+        apply_filter(&frontR[0],&filter[2][0],&output[2][0],    // front right
+                     &surL[0],&filter[3][0],&output[3][0]);     // surround left
+        apply_filter(&surR[0],&filter[4][0],&output[4][0],      // surround right
+                     &trueavg[0],&filter[5][0],&output[5][0]);  // lfe
+#endif
     }
 
 #define FASTER_CALC
@@ -424,17 +479,16 @@ private:
 #endif
     }
 
+#ifdef USE_FFTW3
     // filter the complex source signal and add it to target
     void apply_filter(cfloat *signal, float *flt, float *target) {
         // filter the signal
-        unsigned f;
-        for (f=0;f<=halfN;f++) {
+        for (unsigned f=0;f<=halfN;f++) {
             src[f][0] = signal[f].real() * flt[f];
             src[f][1] = signal[f].imag() * flt[f];
         }
-#ifdef USE_FFTW3
         // transform into time domain
-        fftwf_execute(store);
+        fftwf_execute_dft_c2r(plans.store, src, dst);
 
         float* pT1   = &target[current_buf*halfN];
         float* pWnd1 = &wnd[0];
@@ -450,38 +504,57 @@ private:
             // 2nd part is set as has no history
             *pT2++  = *pWnd2++ * *pDst2++;
         }
+    }
 #else
-        // enforce odd symmetry
-        for (f=1;f<halfN;f++) {
-            src[N-f][0] = src[f][0];
-            src[N-f][1] = -src[f][1];   // complex conjugate
+    // filter two complex source signals and add them to their targets
+    //  both results are real, so one is carried in the real and the other in the imaginary
+    //  part of a single inverse transform, which halves the number of transforms
+    void apply_filter(cfloat *signal1, float *flt1, float *target1,
+                      cfloat *signal2, float *flt2, float *target2) {
+        // filter the signals and enforce odd symmetry, the DC and N/2 bins are real
+        src[0][0] = signal1[0].real() * flt1[0];
+        src[0][1] = signal2[0].real() * flt2[0];
+        src[halfN][0] = signal1[halfN].real() * flt1[halfN];
+        src[halfN][1] = signal2[halfN].real() * flt2[halfN];
+        for (unsigned f=1;f<halfN;f++) {
+            float xr = signal1[f].real() * flt1[f], xi = signal1[f].imag() * flt1[f];
+            float yr = signal2[f].real() * flt2[f], yi = signal2[f].imag() * flt2[f];
+            src[f][0] = xr - yi;
+            src[f][1] = xi + yr;
+            src[N-f][0] = xr + yi;      // complex conjugates
+            src[N-f][1] = yr - xi;
         }
         av_fft_permute(fftContextReverse, (FFTComplex*)&src[0]);
         av_fft_calc(fftContextReverse, (FFTComplex*)&src[0]);
 
-        float* pT1   = &target[current_buf*halfN];
+        float* pT1   = &target1[current_buf*halfN];
+        float* pU1   = &target2[current_buf*halfN];
         float* pWnd1 = &wnd[0];
         float* pDst1 = &src[0][0];
-        float* pT2   = &target[(current_buf^1)*halfN];
+        float* pT2   = &target1[(current_buf^1)*halfN];
+        float* pU2   = &target2[(current_buf^1)*halfN];
         float* pWnd2 = &wnd[halfN];
         float* pDst2 = &src[halfN][0];
-        // add the result to target, windowed
+        // add the results to the targets, windowed
         for (unsigned int k=0;k<halfN;k++)
         {
             // 1st part is overlap add
-            *pT1++ += *pWnd1++ * *pDst1; pDst1 += 2;
+            *pT1++ += *pWnd1 * pDst1[0];
+            *pU1++ += *pWnd1++ * pDst1[1]; pDst1 += 2;
             // 2nd part is set as has no history
-            *pT2++  = *pWnd2++ * *pDst2; pDst2 += 2;
+            *pT2++  = *pWnd2 * pDst2[0];
+            *pU2++  = *pWnd2++ * pDst2[1]; pDst2 += 2;
         }
-#endif
     }
+#endif
 
 #ifndef USE_FFTW3
     /**
      *  * Do the permutation needed BEFORE calling ff_fft_calc()
-     *  special for freesurround that also copies
+     *  special for freesurround that also copies two real signals
+     *  into the real and imaginary parts
      *   */
-    void ff_fft_permuteRC(FFTContext *s, FFTSample *r, FFTComplex *z)
+    void ff_fft_permuteRC(FFTContext *s, FFTSample *r, FFTSample *i, FFTComplex *z)
     {
         int j, k, np;
         const uint16_t *revtab = s->revtab;
@@ -491,7 +564,7 @@ private:
         for(j=0;j<np;j++) {
             k = revtab[j];
             z[k].re = r[j];
-            z[k].im = 0.0;
+            z[k].im = i[j];
         }
     }
 
@@ -524,7 +597,7 @@ private:
     // FFTW data structures
     float *lt,*rt,*dst;                // left total, right total (source arrays), destination array
     fftwf_complex *dftL,*dftR,*src;    // intermediate arrays (FFTs of lt & rt, processing source)
-    fftwf_plan loadL,loadR,store;      // plans for loading the data into the intermediate format and back
+    fftw_plans plans;                  // shared plans for loading the data into the intermediate format and back
 #else
     FFTContext *fftContextForward, *fftContextReverse; 
     FFTSample *lt,*rt;                 // left total, right total (source arrays), destination array
@@ -543,6 +616,7 @@ private:
     float surround_balance;            // the xfs balance that follows from the coeffs
     float surround_level;              // gain for the surround channels (follows from the coeffs
     float phase_offsetL, phase_offsetR;// phase shifts to be applied to the rear channels
+    cfloat phase_rotL, phase_rotR;     // the same phase shifts as unit phasors
     float front_separation;            // front stereo separation
     float rear_separation;             // rear stereo separation
     bool linear_steering;              // whether the steering should be linear or not
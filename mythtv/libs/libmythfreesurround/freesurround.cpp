@@ -508,7 +508,7 @@ void FreeSurround::open()
 {
     if (!decoder)
     {
-        decoder = (fsurround_decoder*)dp.acquire((void*)1);
+        decoder = (fsurround_decoder*)dp.acquire(this);
         decoder->flush();
         if (bufs)
             bufs->clear();
@@ -2,6 +2,8 @@
 
 #include <QDir>
 #include <QUrl>
+#include <QFile>
+#include <QDataStream>
 
 #include "mythcorecontext.h"
 #include "dbaccess.h"
@@ -16,6 +18,120 @@ DirectoryHandler::~DirectoryHandler()
 {
 }
 
+// bump when the layout of the cache file changes
+#define DIRECTORY_CACHE_VERSION 1
+
+DirectoryCache::DirectoryCache(const QString &filename) :
+    m_filename(filename)
+{
+}
+
+bool DirectoryCache::Load(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_dirs.clear();
+    m_seen.clear();
+
+    QFile file(m_filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> version >> count;
+    if (version != DIRECTORY_CACHE_VERSION)
+        return false;
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString path;
+        CachedDir dir;
+        stream >> path >> dir.modified >> dir.listed >> dir.entries;
+        m_dirs[path] = dir;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("Directory cache %1 is corrupt, ignoring it")
+                .arg(m_filename));
+        m_dirs.clear();
+        return false;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, QString("Loaded %1 directories from %2")
+            .arg(m_dirs.size()).arg(m_filename));
+
+    return true;
+}
+
+/// Write out the directories that were looked at since Load()
+bool DirectoryCache::Save(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    QFile file(m_filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Unable to write directory cache %1")
+                .arg(m_filename));
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << (quint32)DIRECTORY_CACHE_VERSION << (quint32)m_seen.size();
+
+    QMap<QString, CachedDir>::const_iterator it = m_dirs.begin();
+    for (; it != m_dirs.end(); ++it)
+    {
+        if (m_seen.contains(it.key()))
+            stream << it.key() << it->modified << it->listed << it->entries;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+/**
+ *  \brief Fetch the entries remembered for \p path, if it has not been
+ *         modified since they were read.
+ */
+bool DirectoryCache::Lookup(const QString &path, const QDateTime &modified,
+                            QStringList &entries)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_seen.insert(path);
+
+    QMap<QString, CachedDir>::const_iterator it = m_dirs.find(path);
+    if (it == m_dirs.end())
+        return false;
+
+    // Modification times are only good to the second, so an entry read
+    // in the same second the directory was changed can't be trusted.
+    uint mtime = modified.toTime_t();
+    if (it->modified != mtime || it->listed <= mtime)
+        return false;
+
+    entries = it->entries;
+    return true;
+}
+
+void DirectoryCache::Insert(const QString &path, const QDateTime &modified,
+                            const QStringList &entries)
+{
+    CachedDir dir;
+    dir.modified = modified.toTime_t();
+    dir.listed = QDateTime::currentDateTime().toTime_t();
+    dir.entries = entries;
+
+    QMutexLocker locker(&m_lock);
+
+    m_seen.insert(path);
+    m_dirs[path] = dir;
+}
+
 namespace
 {
     class ext_lookup
@@ -47,42 +163,71 @@ namespace
     };
 
     bool scan_dir(const QString &start_path, DirectoryHandler *handler,
-                  const ext_lookup &ext_settings)
+                  const ext_lookup &ext_settings, DirectoryCache *cache)
     {
-        QDir d(start_path);
+        QFileInfo start_info(start_path);
 
         // Return a fail if directory doesn't exist.
-        if (!d.exists())
+        if (!start_info.isDir())
             return false;
 
-        QFileInfoList list = d.entryInfoList();
+        // Entries are kept as "type, name, absolute path" triples so an
+        // unchanged directory can be replayed from the cache without
+        // stat()ing every file in it again.
+        QStringList entries;
+        QDateTime modified;
+        if (cache)
+            modified = start_info.lastModified();
+
+        if (!cache || !cache->Lookup(start_path, modified, entries))
+        {
+            QDir d(start_path);
+            QFileInfoList list = d.entryInfoList();
+
+            for (QFileInfoList::iterator p = list.begin(); p != list.end(); ++p)
+            {
+                if (p->fileName() == "." ||
+                    p->fileName() == ".." ||
+                    p->fileName() == "Thumbs.db")
+                {
+                    continue;
+                }
+
+                entries << (p->isDir() ? "d" : "f") << p->fileName()
+                        << p->absoluteFilePath();
+            }
+
+            if (cache)
+                cache->Insert(start_path, modified, entries);
+        }
+
         // An empty directory is fine
-        if (!list.size())
+        if (!entries.size())
             return true;
 
         QDir dir_tester;
 
-        for (QFileInfoList::iterator p = list.begin(); p != list.end(); ++p)
+        for (int i = 0; i + 2 < entries.size(); i += 3)
         {
-            if (p->fileName() == "." ||
-                p->fileName() == ".." ||
-                p->fileName() == "Thumbs.db")
-            {
-                continue;
-            }
+            bool is_dir = (entries[i] == "d");
+            const QString &file_name = entries[i + 1];
+            const QString &fq_file_name = entries[i + 2];
+            QString suffix = QFileInfo(file_name).suffix();
 
-            if (!p->isDir() &&
-                ext_settings.extension_ignored(p->suffix())) continue;
+            if (!is_dir &&
+                ext_settings.extension_ignored(suffix)) continue;
 
             bool add_as_file = true;
 
-            if (p->isDir())
+            if (is_dir)
             {
                 add_as_file = false;
 
-                dir_tester.setPath(p->absoluteFilePath() + "/VIDEO_TS");
+                // Always looked for rather than cached, adding a disc
+                // structure only changes the subdirectory's time
+                dir_tester.setPath(fq_file_name + "/VIDEO_TS");
                 QDir bd_dir_tester;
-                bd_dir_tester.setPath(p->absoluteFilePath() + "/BDMV");
+                bd_dir_tester.setPath(fq_file_name + "/BDMV");
                 if (dir_tester.exists() || bd_dir_tester.exists())
                 {
                     add_as_file = true;
@@ -91,15 +236,14 @@ namespace
                 {
 #if 0
                     LOG(VB_GENERAL, LOG_DEBUG, 
-                        QString(" -- Dir : %1").arg(p->absoluteFilePath()));
+                        QString(" -- Dir : %1").arg(fq_file_name));
 #endif
                     DirectoryHandler *dh =
-                            handler->newDir(p->fileName(),
-                                            p->absoluteFilePath());
+                            handler->newDir(file_name, fq_file_name);
 
                     // Since we are dealing with a subdirectory failure is fine,
                     // so we'll just ignore the failue and continue
-                    (void) scan_dir(p->absoluteFilePath(), dh, ext_settings);
+                    (void) scan_dir(fq_file_name, dh, ext_settings, cache);
                 }
             }
 
@@ -107,10 +251,9 @@ namespace
             {
 #if 0
                 LOG(VB_GENERAL, LOG_DEBUG,
-                    QString(" -- File : %1").arg(p->fileName()));
+                    QString(" -- File : %1").arg(file_name));
 #endif
-                handler->handleFile(p->fileName(), p->absoluteFilePath(),
-                                    p->suffix(), "");
+                handler->handleFile(file_name, fq_file_name, suffix, "");
             }
         }
 
@@ -119,7 +262,8 @@ namespace
 
     bool scan_sg_dir(const QString &start_path, const QString &host,
                      const QString &base_path, DirectoryHandler *handler,
-                     const ext_lookup &ext_settings, bool isMaster = false)
+                     const ext_lookup &ext_settings, bool isMaster,
+                     DirectoryCache *cache)
     {
         QString path = start_path;
 
@@ -137,8 +281,22 @@ namespace
 
         if (isMaster)
         {
-            StorageGroup sg("Videos", host);
-            list = sg.GetFileInfoList(start_path);
+            // the storage group is local, so the directory's time can be
+            // checked to see if the last listing of it is still good
+            QString key = "sg:" + start_path;
+            QFileInfo start_info(start_path);
+            QDateTime modified;
+            bool cacheable = cache && start_path != "/" && start_info.isDir();
+            if (cacheable)
+                modified = start_info.lastModified();
+
+            if (!cacheable || !cache->Lookup(key, modified, list))
+            {
+                StorageGroup sg("Videos", host);
+                list = sg.GetFileInfoList(start_path);
+                if (cacheable)
+                    cache->Insert(key, modified, list);
+            }
             ok = true;
         }
         else
@@ -186,7 +344,7 @@ namespace
                 // as we reached it once to make it this far than we know the 
                 // SG/Path exists
                 (void) scan_sg_dir(start_path + "/" + fileName, host, base_path,
-                             dh, ext_settings, isMaster);
+                             dh, ext_settings, isMaster, cache);
             }
             else
             {
@@ -232,7 +390,7 @@ namespace
 
 bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions)
+        bool list_unknown_extensions, DirectoryCache *cache)
 {
     ext_lookup extlookup(ext_disposition, list_unknown_extensions);
 
@@ -244,7 +402,7 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        if (!scan_dir(start_path, handler, extlookup, cache))
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
@@ -263,7 +421,8 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
 
         if (!scan_sg_dir(path, host, path, handler, extlookup, 
                 (gCoreContext->IsMasterHost(host) &&
-                 (gCoreContext->GetHostName().toLower() == host.toLower()))))
+                 (gCoreContext->GetHostName().toLower() == host.toLower())),
+                cache))
         {
             LOG(VB_GENERAL, LOG_ERR, 
                 QString("MythVideo::ScanVideoDirectory failed to scan %1 ")
@@ -1,6 +1,12 @@
 #ifndef DIRSCAN_H_
 #define DIRSCAN_H_
 
+#include <QMap>
+#include <QSet>
+#include <QMutex>
+#include <QDateTime>
+#include <QStringList>
+
 #include "mythmetaexp.h"
 
 class META_PUBLIC DirectoryHandler
@@ -15,8 +21,44 @@ class META_PUBLIC DirectoryHandler
                             const QString &host) = 0;
 };
 
+/**
+ *  \brief Remembers what was in each directory the last time it was read.
+ *
+ *  A directory's modification time only changes when entries are added to
+ *  it, removed or renamed, so while it stays the same the remembered entries
+ *  can be used instead of reading the directory again.  Subdirectories are
+ *  still visited, each is checked against its own modification time.
+ *  Safe to share between threads scanning different directories.
+ */
+class META_PUBLIC DirectoryCache
+{
+  public:
+    DirectoryCache(const QString &filename);
+
+    bool Load(void);
+    bool Save(void);
+
+    bool Lookup(const QString &path, const QDateTime &modified,
+                QStringList &entries);
+    void Insert(const QString &path, const QDateTime &modified,
+                const QStringList &entries);
+
+  private:
+    struct CachedDir
+    {
+        uint        modified;
+        uint        listed;
+        QStringList entries;
+    };
+
+    QString                   m_filename;
+    QMutex                    m_lock;
+    QMap<QString, CachedDir>  m_dirs;
+    QSet<QString>             m_seen;
+};
+
 META_PUBLIC bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions);
+        bool list_unknown_extensions, DirectoryCache *cache = NULL);
 
 #endif // DIRSCAN_H_
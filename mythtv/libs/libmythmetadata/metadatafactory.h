@@ -99,6 +99,10 @@ class META_PUBLIC MetadataFactory : public QObject
                               m_imagedownload->isRunning() ||
                               m_videoscanner->isRunning(); };
 
+    void SetDisplaySize(VideoArtworkType type, const QSize &size,
+                        bool preserveAspect = true)
+        { m_imagedownload->setDisplaySize(type, size, preserveAspect); };
+
     bool VideoGrabbersFunctional();
 
   private:
@@ -1,5 +1,12 @@
+// c
+#include <unistd.h>
+
 // qt
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QUrl>
+#include <QTextStream>
+#include <QRunnable>
 #include <QImage>
 #include <QFileInfo>
 #include <QDir>
@@ -8,12 +15,15 @@
 // myth
 #include "mythcorecontext.h"
 #include "mythuihelper.h"
+#include "mythuiimage.h"
 #include "mythdirs.h"
 #include "httpcomms.h"
 #include "storagegroup.h"
 #include "metadataimagedownload.h"
 #include "remotefile.h"
 #include "mythdownloadmanager.h"
+#include "mthreadpool.h"
+#include "videoutils.h"
 #include "mythlogging.h"
 #include "mythdate.h"
 
@@ -26,304 +36,715 @@ QEvent::Type ImageDLFailureEvent::kEventType =
 QEvent::Type ThumbnailDLEvent::kEventType =
     (QEvent::Type) QEvent::registerEventType();
 
+/// Most downloads we will have in flight from any one web server
+static const int kMaxDownloadsPerHost = 2;
+
+/// Most downloads we will have in flight altogether
+static const int kMaxDownloads = 6;
+
+/// Artwork is kept in the cache for this many days after it was fetched
+static const int kArtworkCacheDays = 30;
+
+#define ARTWORK_INDEX_FILE "index"
+
+/// Works through a downloader's queue on one of its pool threads
+class ImageDLWorker : public QRunnable
+{
+  public:
+    ImageDLWorker(MetadataImageDownload *parent) : m_parent(parent) {}
+
+    void run(void)
+    {
+        m_parent->processQueue();
+    }
+
+  private:
+    MetadataImageDownload *m_parent;
+};
+
+/*
+ * The artwork cache holds every image we have downloaded once, named after
+ * the SHA1 of its contents so artwork shared by many titles, like the cover
+ * of a series, is only stored once.  Local copies are hard links to the
+ * cache entry where the filesystem allows.  An index maps the URLs fetched
+ * to the image they gave, so the same URL is never fetched twice.  The
+ * cache is shared by every downloader in the process.
+ */
+static QMutex                  s_artworkLock;
+static QMap<QString, QString>  s_artworkIndex;
+static bool                    s_artworkLoaded = false;
+
+static QString getArtworkCacheDir(void)
+{
+    return GetConfDir() + "/thumbcache/artwork";
+}
+
+/// Rewrite the URL index without entries for expired images,
+/// s_artworkLock must be held
+static void saveArtworkIndex(void)
+{
+    QDir dir(getArtworkCacheDir());
+    QFile index(dir.filePath(ARTWORK_INDEX_FILE));
+    if (!index.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                    QIODevice::Text))
+        return;
+
+    QTextStream stream(&index);
+    stream.setCodec("UTF-8");
+    QMap<QString, QString>::iterator it = s_artworkIndex.begin();
+    while (it != s_artworkIndex.end())
+    {
+        if (!dir.exists(*it))
+        {
+            it = s_artworkIndex.erase(it);
+            continue;
+        }
+        stream << *it << ' ' << it.key() << '\n';
+        ++it;
+    }
+}
+
+/// Read in the URL index, s_artworkLock must be held
+static void loadArtworkIndex(void)
+{
+    if (s_artworkLoaded)
+        return;
+
+    s_artworkLoaded = true;
+
+    QDir dir(getArtworkCacheDir());
+    if (!dir.exists())
+        dir.mkpath(dir.path());
+
+    QFile file(dir.filePath(ARTWORK_INDEX_FILE));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    // one "<image hash> <url>" line per download, later lines win
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    int lines = 0;
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine();
+        int space = line.indexOf(' ');
+        if (space > 0)
+            s_artworkIndex[line.mid(space + 1)] = line.left(space);
+        lines++;
+    }
+    file.close();
+
+    // drop lines for expired images and lines later ones replaced, so the
+    // index only grows by what is really in the cache
+    QMap<QString, QString>::iterator it = s_artworkIndex.begin();
+    while (it != s_artworkIndex.end())
+    {
+        if (dir.exists(*it))
+            ++it;
+        else
+            it = s_artworkIndex.erase(it);
+    }
+
+    if (lines != s_artworkIndex.size())
+        saveArtworkIndex();
+}
+
+static bool getCachedArtwork(const QString &url, QByteArray &data,
+                             QString &cached)
+{
+    QMutexLocker locker(&s_artworkLock);
+
+    loadArtworkIndex();
+
+    QMap<QString, QString>::const_iterator it = s_artworkIndex.find(url);
+    if (it == s_artworkIndex.end())
+        return false;
+
+    QFile file(getArtworkCacheDir() + '/' + *it);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    data = file.readAll();
+    cached = file.fileName();
+    return !data.isEmpty();
+}
+
+/// Add an image to the cache, returns the cache entry or an empty string
+static QString cacheArtwork(const QString &url, const QByteArray &data)
+{
+    QString hash(QCryptographicHash::hash(data, QCryptographicHash::Sha1)
+                                                                .toHex());
+
+    QMutexLocker locker(&s_artworkLock);
+
+    loadArtworkIndex();
+
+    QString dir = getArtworkCacheDir();
+    QFile file(dir + '/' + hash);
+    if (!file.exists())
+    {
+        if (!file.open(QIODevice::WriteOnly) ||
+            file.write(data) != data.size())
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Image Download: Unable to write %1 to the artwork "
+                        "cache").arg(file.fileName()));
+            file.remove();
+            return QString();
+        }
+        file.close();
+    }
+
+    if (s_artworkIndex.value(url) == hash)
+        return file.fileName();
+
+    s_artworkIndex[url] = hash;
+
+    QFile index(dir + '/' + ARTWORK_INDEX_FILE);
+    if (index.open(QIODevice::WriteOnly | QIODevice::Append |
+                   QIODevice::Text))
+    {
+        QTextStream stream(&index);
+        stream.setCodec("UTF-8");
+        stream << hash << ' ' << url << '\n';
+    }
+
+    return file.fileName();
+}
+
+/// Fetch an image, from the artwork cache if it has been fetched before.
+/// cached is set to the image's cache entry, if it has one.
+static bool fetchArtwork(const QString &url, QByteArray &data, QImage &image,
+                         bool useCache, QString &cached)
+{
+    if (useCache && getCachedArtwork(url, data, cached) &&
+        image.loadFromData(data))
+    {
+        LOG(VB_GENERAL, LOG_DEBUG,
+            QString("Metadata Image Download: %1 found in artwork cache")
+                .arg(url));
+        return true;
+    }
+
+    data.clear();
+    cached.clear();
+    GetMythDownloadManager()->download(url, &data);
+
+    if (!image.loadFromData(data))
+        return false;
+
+    cached = cacheArtwork(url, data);
+    return true;
+}
+
+/// Write artwork to a local file, as a hard link to its cache entry when
+/// the cache is on the same filesystem
+static bool storeArtwork(const QString &filename, const QString &cached,
+                         const QByteArray &data)
+{
+#ifndef USING_MINGW
+    if (!cached.isEmpty() &&
+        link(QFile::encodeName(cached).constData(),
+             QFile::encodeName(filename).constData()) == 0)
+        return true;
+#endif
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    return file.write(data) == data.size();
+}
+
+static QString getStorageGroupName(VideoArtworkType type)
+{
+    if (type == kArtworkCoverart)
+        return "Coverart";
+    else if (type == kArtworkFanart)
+        return "Fanart";
+    else if (type == kArtworkBanner)
+        return "Banners";
+    else if (type == kArtworkScreenshot)
+        return "Screenshots";
+
+    return "Default";
+}
+
 MetadataImageDownload::MetadataImageDownload(QObject *parent) :
-    MThread("MetadataImageDownload")
+    m_parent(parent), m_pool(new MThreadPool("MetadataImageDownload")),
+    m_workers(0)
 {
-    m_parent = parent;
+    m_pool->setMaxThreadCount(kMaxDownloads);
 }
 
 MetadataImageDownload::~MetadataImageDownload()
 {
     cancel();
-    wait();
+    m_pool->waitForDone();
+    delete m_pool;
 }
 
 void MetadataImageDownload::addThumb(QString title,
                                      QString url, QVariant data)
 {
+    ImageDLJob job;
+    job.thumb = new ThumbnailData();
+    job.thumb->title = title;
+    job.thumb->data = data;
+    job.thumb->url = url;
+    job.lookup = NULL;
+    job.type = kArtworkCoverart;
+    job.filename = getDownloadFilename(title, url);
+    job.host = QUrl(url).host();
+
     m_mutex.lock();
-    ThumbnailData *id = new ThumbnailData();
-    id->title = title;
-    id->data = data;
-    id->url = url;
-    m_thumbnailList.append(id);
-    if (!isRunning())
-        start();
+    m_thumbnailList.append(job);
+    startWorkers();
     m_mutex.unlock();
 }
 
 void MetadataImageDownload::addDownloads(MetadataLookup *lookup)
 {
+    DownloadMap downloads = lookup->GetDownloads();
+
     m_mutex.lock();
-    m_downloadList.append(lookup);
-    if (!isRunning())
-        start();
+
+    // each piece of artwork is fetched on its own, the lookup is handed
+    // back once they have all been tried
+    for (DownloadMap::iterator i = downloads.begin();
+            i != downloads.end(); ++i)
+    {
+        ImageDLJob job;
+        job.thumb = NULL;
+        job.lookup = lookup;
+        job.type = i.key();
+        job.info = i.value();
+        job.filename = getDownloadFilename(job.type, lookup, job.info.url);
+        job.host = QUrl(job.info.url).host();
+        m_downloadList.append(job);
+    }
+
+    if (downloads.isEmpty())
+    {
+        lookup->SetDownloads(DownloadMap());
+        QCoreApplication::postEvent(m_parent, new ImageDLEvent(lookup));
+    }
+    else
+    {
+        m_pending[lookup] = downloads.size();
+        m_downloaded[lookup] = DownloadMap();
+    }
+
+    startWorkers();
     m_mutex.unlock();
 }
 
+/**
+ *  \brief Have artwork scaled to the size the theme shows it at as soon as
+ *         it has been downloaded.
+ *
+ *  The scaled copy is put straight into the theme's image cache, so the UI
+ *  finds it there rather than loading and scaling the full size image the
+ *  first time it is shown.  Must be called from the UI thread.
+ */
+void MetadataImageDownload::setDisplaySize(VideoArtworkType type,
+                                           const QSize &size,
+                                           bool preserveAspect)
+{
+    QString cacheDir = GetMythUI()->GetThemeCacheDir();
+
+    QMutexLocker locker(&m_mutex);
+
+    m_themeCacheDir = cacheDir;
+
+    if (size.width() <= 0 || size.height() <= 0)
+    {
+        m_displaySizes.remove(type);
+        return;
+    }
+
+    DisplaySize display;
+    display.size = size;
+    display.preserveAspect = preserveAspect;
+    m_displaySizes[type] = display;
+}
+
 void MetadataImageDownload::cancel()
 {
     m_mutex.lock();
-    qDeleteAll(m_thumbnailList);
+
+    QList<ImageDLJob>::iterator it = m_thumbnailList.begin();
+    for (; it != m_thumbnailList.end(); ++it)
+        delete it->thumb;
     m_thumbnailList.clear();
-    qDeleteAll(m_downloadList);
+
+    // lookups with artwork still being fetched are deleted once it is done
+    for (it = m_downloadList.begin(); it != m_downloadList.end(); ++it)
+        m_pending[it->lookup]--;
     m_downloadList.clear();
+
+    QMap<MetadataLookup*, int>::iterator pending = m_pending.begin();
+    while (pending != m_pending.end())
+    {
+        if (*pending <= 0)
+        {
+            m_downloaded.remove(pending.key());
+            m_cancelled.remove(pending.key());
+            delete pending.key();
+            pending = m_pending.erase(pending);
+        }
+        else
+        {
+            m_cancelled.insert(pending.key());
+            ++pending;
+        }
+    }
+
     m_mutex.unlock();
 }
 
-void MetadataImageDownload::run()
+bool MetadataImageDownload::isRunning()
 {
-    RunProlog();
+    QMutexLocker locker(&m_mutex);
+    return m_workers > 0;
+}
+
+/// Start enough workers for the queued jobs, m_mutex must be held
+void MetadataImageDownload::startWorkers()
+{
+    int queued = m_thumbnailList.size() + m_downloadList.size();
 
-    // Always handle thumbnails first, they're higher priority.
-    ThumbnailData *thumb;
-    while ((thumb = moreThumbs()) != NULL)
+    while (m_workers < m_pool->maxThreadCount() && m_workers < queued)
     {
-        QString sFilename = getDownloadFilename(thumb->title, thumb->url);
+        m_workers++;
+        m_pool->start(new ImageDLWorker(this), "ImageDLWorker");
+    }
+}
 
-        bool exists = QFile::exists(sFilename);
-        if (!exists && !thumb->url.isEmpty())
-            GetMythDownloadManager()->download(thumb->url, sFilename);
+void MetadataImageDownload::processQueue()
+{
+    ImageDLJob job;
 
-        // inform parent we have thumbnail ready for it
-        if (QFile::exists(sFilename) && m_parent)
+    m_mutex.lock();
+    while (takeJob(job))
+    {
+        m_mutex.unlock();
+
+        bool ok = true;
+        if (job.thumb)
+            downloadThumb(job.thumb, job.filename);
+        else
+            ok = downloadArtwork(job);
+
+        m_mutex.lock();
+        finishJob(job, ok);
+    }
+
+    // anything left is waiting on a busy server, whoever is fetching
+    // from it will pick it up
+    m_workers--;
+    m_mutex.unlock();
+}
+
+/**
+ *  \brief Take the next job off the queue, m_mutex must be held.
+ *
+ *  Thumbnails always go first, they're higher priority.  Jobs for a server
+ *  we already have kMaxDownloadsPerHost downloads from, or for a file that
+ *  is already being written, are passed over for now.
+ */
+bool MetadataImageDownload::takeJob(ImageDLJob &job)
+{
+    QList<ImageDLJob> *lists[2] = { &m_thumbnailList, &m_downloadList };
+
+    for (int l = 0; l < 2; ++l)
+    {
+        QList<ImageDLJob>::iterator it = lists[l]->begin();
+        for (; it != lists[l]->end(); ++it)
         {
-            LOG(VB_GENERAL, LOG_DEBUG,
-                    QString("Threaded Image Thumbnail Download: %1")
-                    .arg(sFilename));
-            thumb->url = sFilename;
-            QCoreApplication::postEvent(m_parent,
-                           new ThumbnailDLEvent(thumb));
+            if (m_hostDownloads.value(it->host) >= kMaxDownloadsPerHost ||
+                m_activeFiles.contains(it->filename))
+                continue;
+
+            job = *it;
+            lists[l]->erase(it);
+
+            m_hostDownloads[job.host]++;
+            m_activeFiles.insert(job.filename);
+            return true;
         }
-        else
-            delete thumb;
     }
 
-    MetadataLookup *lookup;
-    while ((lookup = moreDownloads()) != NULL)
+    return false;
+}
+
+/// Account for a finished job, m_mutex must be held
+void MetadataImageDownload::finishJob(const ImageDLJob &job, bool ok)
+{
+    if (--m_hostDownloads[job.host] <= 0)
+        m_hostDownloads.remove(job.host);
+    m_activeFiles.remove(job.filename);
+
+    // a slot on this server is free again
+    startWorkers();
+
+    if (!job.lookup)
+        return;
+
+    if (ok)
+        m_downloaded[job.lookup].insert(job.type, job.info);
+
+    if (--m_pending[job.lookup] > 0)
+        return;
+
+    MetadataLookup *lookup = job.lookup;
+    DownloadMap downloaded = m_downloaded.take(lookup);
+    m_pending.remove(lookup);
+
+    if (m_cancelled.remove(lookup))
     {
-        DownloadMap downloads = lookup->GetDownloads();
-        DownloadMap downloaded;
+        delete lookup;
+        return;
+    }
 
-        for (DownloadMap::iterator i = downloads.begin();
-                i != downloads.end(); ++i)
-        {
-            VideoArtworkType type = i.key();
-            ArtworkInfo info = i.value();
-            QString filename = getDownloadFilename( type, lookup,
-                                   info.url );
-            if (lookup->GetHost().isEmpty())
-            {
-                QString path = getLocalWritePath(lookup->GetType(), type);
-                QDir dirPath(path);
-                if (!dirPath.exists())
-                    if (!dirPath.mkpath(path))
-                    {
-                        LOG(VB_GENERAL, LOG_ERR,
-                            QString("Metadata Image Download: Unable to create "
-                                    "path %1, aborting download.").arg(path));
-                        QCoreApplication::postEvent(m_parent,
-                                    new ImageDLFailureEvent(lookup));
-                        continue;
-                    }
-                QString finalfile = path + "/" + filename;
-                QString oldurl = info.url;
-                info.url = finalfile;
-                if (!QFile::exists(finalfile) || lookup->GetAllowOverwrites())
-                {
-                    QFile dest_file(finalfile);
-                    if (dest_file.exists())
-                    {
-                        QFileInfo fi(finalfile);
-                        GetMythUI()->RemoveFromCacheByFile(fi.fileName());
-                        dest_file.remove();
-                    }
-
-                    LOG(VB_GENERAL, LOG_INFO,
-                        QString("Metadata Image Download: %1 ->%2")
-                         .arg(oldurl).arg(finalfile));
-                    QByteArray *download = new QByteArray();
-                    GetMythDownloadManager()->download(oldurl, download);
-
-                    QImage testImage;
-                    bool didLoad = testImage.loadFromData(*download);
-                    if (!didLoad)
-                    {
-                        LOG(VB_GENERAL, LOG_ERR,
-                            QString("Tried to write %1, but it appears to be "
-                                    "an HTML redirect (filesize %2).")
-                                .arg(oldurl).arg(download->size()));
-                        delete download;
-                        download = NULL;
-                        QCoreApplication::postEvent(m_parent,
-                                    new ImageDLFailureEvent(lookup));
-                        continue;
-                    }
-
-                    if (dest_file.open(QIODevice::WriteOnly))
-                    {
-                        off_t size = dest_file.write(*download,
-                                                     download->size());
-                        if (size != download->size())
-                        {
-                            LOG(VB_GENERAL, LOG_ERR,
-                                QString("Image Download: Error Writing Image "
-                                        "to file: %1").arg(finalfile));
-                            QCoreApplication::postEvent(m_parent,
-                                        new ImageDLFailureEvent(lookup));
-                        }
-                        else
-                            downloaded.insert(type, info);
-                    }
-
-                    delete download;
-                }
-                else
-                    downloaded.insert(type, info);
-            }
-            else
+    lookup->SetDownloads(downloaded);
+    QCoreApplication::postEvent(m_parent, new ImageDLEvent(lookup));
+}
+
+void MetadataImageDownload::downloadThumb(ThumbnailData *thumb,
+                                          const QString &filename)
+{
+    bool exists = QFile::exists(filename);
+    if (!exists && !thumb->url.isEmpty())
+        GetMythDownloadManager()->download(thumb->url, filename);
+
+    // inform parent we have thumbnail ready for it
+    if (QFile::exists(filename) && m_parent)
+    {
+        LOG(VB_GENERAL, LOG_DEBUG,
+                QString("Threaded Image Thumbnail Download: %1")
+                .arg(filename));
+        thumb->url = filename;
+        QCoreApplication::postEvent(m_parent,
+                       new ThumbnailDLEvent(thumb));
+    }
+    else
+        delete thumb;
+}
+
+/**
+ *  \brief Fetch one piece of artwork and store it where the lookup wants it.
+ *
+ *  On success job.info.url is set to where the artwork was stored.
+ */
+bool MetadataImageDownload::downloadArtwork(ImageDLJob &job)
+{
+    MetadataLookup *lookup = job.lookup;
+    VideoArtworkType type = job.type;
+    QString filename = job.filename;
+    QString oldurl = job.info.url;
+
+    if (lookup->GetHost().isEmpty())
+    {
+        QString path = getLocalWritePath(lookup->GetType(), type);
+        QDir dirPath(path);
+        if (!dirPath.exists())
+            if (!dirPath.mkpath(path))
             {
-                QString path = getStorageGroupURL(type, lookup->GetHost());
-                QString finalfile = path + filename;
-                QString oldurl = info.url;
-                info.url = finalfile;
-                bool exists = false;
-                bool onMaster = false;
-                QString resolvedFN;
-                if ((lookup->GetHost().toLower() == gCoreContext->GetHostName().toLower()) ||
-                    (gCoreContext->IsThisHost(lookup->GetHost())))
-                {
-                    StorageGroup sg;
-                    resolvedFN = sg.FindFile(filename);
-                    exists = QFile::exists(resolvedFN);
-                    if (!exists)
-                    {
-                        resolvedFN = getLocalStorageGroupPath(type,
-                                                 lookup->GetHost()) + "/" + filename;
-                    }
-                    onMaster = true;
-                }
-                else
-                    exists = RemoteFile::Exists(finalfile);
-
-                if (!exists || lookup->GetAllowOverwrites())
-                {
-
-                    if (exists && !onMaster)
-                    {
-                        QFileInfo fi(finalfile);
-                        GetMythUI()->RemoveFromCacheByFile(fi.fileName());
-                        RemoteFile::DeleteFile(finalfile);
-                    }
-                    else if (exists)
-                        QFile::remove(resolvedFN);
-
-                    LOG(VB_GENERAL, LOG_INFO,
-                        QString("Metadata Image Download: %1 -> %2")
-                            .arg(oldurl).arg(finalfile));
-                    QByteArray *download = new QByteArray();
-                    GetMythDownloadManager()->download(oldurl, download);
-
-                    QImage testImage;
-                    bool didLoad = testImage.loadFromData(*download);
-                    if (!didLoad)
-                    {
-                        LOG(VB_GENERAL, LOG_ERR,
-                            QString("Tried to write %1, but it appears to be "
-                                    "an HTML redirect or corrupt file "
-                                    "(filesize %2).")
-                                .arg(oldurl).arg(download->size()));
-                        delete download;
-                        download = NULL;
-                        QCoreApplication::postEvent(m_parent,
-                                    new ImageDLFailureEvent(lookup));
-                        continue;
-                    }
-
-                    if (!onMaster)
-                    {
-                        RemoteFile *outFile = new RemoteFile(finalfile, true);
-                        if (!outFile->isOpen())
-                        {
-                            LOG(VB_GENERAL, LOG_ERR,
-                                QString("Image Download: Failed to open "
-                                        "remote file (%1) for write.  Does "
-                                        "Storage Group Exist?")
-                                        .arg(finalfile));
-                            delete outFile;
-                            outFile = NULL;
-                            QCoreApplication::postEvent(m_parent,
-                                        new ImageDLFailureEvent(lookup));
-                        }
-                        else
-                        {
-                            off_t written = outFile->Write(*download,
-                                                           download->size());
-                            if (written != download->size())
-                            {
-                                LOG(VB_GENERAL, LOG_ERR,
-                                    QString("Image Download: Error Writing Image "
-                                            "to file: %1").arg(finalfile));
-                                QCoreApplication::postEvent(m_parent,
-                                        new ImageDLFailureEvent(lookup));
-                            }
-                            else
-                                downloaded.insert(type, info);
-                            delete outFile;
-                            outFile = NULL;
-                        }
-                    }
-                    else
-                    {
-                        QFile dest_file(resolvedFN);
-                        if (dest_file.open(QIODevice::WriteOnly))
-                        {
-                            off_t size = dest_file.write(*download,
-                                                         download->size());
-                            if (size != download->size())
-                            {
-                                LOG(VB_GENERAL, LOG_ERR,
-                                    QString("Image Download: Error Writing Image "
-                                            "to file: %1").arg(finalfile));
-                                QCoreApplication::postEvent(m_parent,
-                                            new ImageDLFailureEvent(lookup));
-                            }
-                            else
-                                downloaded.insert(type, info);
-                        }
-                    }
-
-                    delete download;
-                }
-                else
-                    downloaded.insert(type, info);
+                LOG(VB_GENERAL, LOG_ERR,
+                    QString("Metadata Image Download: Unable to create "
+                            "path %1, aborting download.").arg(path));
+                QCoreApplication::postEvent(m_parent,
+                            new ImageDLFailureEvent(lookup));
+                return false;
             }
+        QString finalfile = path + "/" + filename;
+        job.info.url = finalfile;
+        if (QFile::exists(finalfile) && !lookup->GetAllowOverwrites())
+            return true;
+
+        QFile dest_file(finalfile);
+        if (dest_file.exists())
+        {
+            QFileInfo fi(finalfile);
+            GetMythUI()->RemoveFromCacheByFile(fi.fileName());
+            dest_file.remove();
         }
-        lookup->SetDownloads(downloaded);
-        QCoreApplication::postEvent(m_parent, new ImageDLEvent(lookup));
+
+        LOG(VB_GENERAL, LOG_INFO,
+            QString("Metadata Image Download: %1 ->%2")
+             .arg(oldurl).arg(finalfile));
+        QByteArray download;
+        QImage image;
+        QString cached;
+        if (!fetchArtwork(oldurl, download, image,
+                          !lookup->GetAllowOverwrites(), cached))
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Tried to write %1, but it appears to be "
+                        "an HTML redirect (filesize %2).")
+                    .arg(oldurl).arg(download.size()));
+            QCoreApplication::postEvent(m_parent,
+                        new ImageDLFailureEvent(lookup));
+            return false;
+        }
+
+        if (!storeArtwork(finalfile, cached, download))
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Image Download: Error Writing Image "
+                        "to file: %1").arg(finalfile));
+            QCoreApplication::postEvent(m_parent,
+                        new ImageDLFailureEvent(lookup));
+            return false;
+        }
+
+        primeImageCache(type, finalfile, image);
+        return true;
     }
 
-    RunEpilog();
-}
+    QString path = getStorageGroupURL(type, lookup->GetHost());
+    QString finalfile = path + filename;
+    job.info.url = finalfile;
+    bool exists = false;
+    bool onMaster = false;
+    QString resolvedFN;
+    if ((lookup->GetHost().toLower() == gCoreContext->GetHostName().toLower()) ||
+        (gCoreContext->IsThisHost(lookup->GetHost())))
+    {
+        StorageGroup sg;
+        resolvedFN = sg.FindFile(filename);
+        exists = QFile::exists(resolvedFN);
+        if (!exists)
+        {
+            resolvedFN = getLocalStorageGroupPath(type,
+                                     lookup->GetHost()) + "/" + filename;
+        }
+        onMaster = true;
+    }
+    else
+        exists = RemoteFile::Exists(finalfile);
 
-ThumbnailData* MetadataImageDownload::moreThumbs()
-{
-    ThumbnailData *ret = NULL;
-    m_mutex.lock();
-    if (!m_thumbnailList.isEmpty())
-        ret = m_thumbnailList.takeFirst();
-    m_mutex.unlock();
-    return ret;
+    if (exists && !lookup->GetAllowOverwrites())
+        return true;
+
+    if (exists && !onMaster)
+    {
+        QFileInfo fi(finalfile);
+        GetMythUI()->RemoveFromCacheByFile(fi.fileName());
+        RemoteFile::DeleteFile(finalfile);
+    }
+    else if (exists)
+        QFile::remove(resolvedFN);
+
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Metadata Image Download: %1 -> %2")
+            .arg(oldurl).arg(finalfile));
+    QByteArray download;
+    QImage image;
+    QString cached;
+    if (!fetchArtwork(oldurl, download, image, !lookup->GetAllowOverwrites(),
+                      cached))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Tried to write %1, but it appears to be "
+                    "an HTML redirect or corrupt file "
+                    "(filesize %2).")
+                .arg(oldurl).arg(download.size()));
+        QCoreApplication::postEvent(m_parent,
+                    new ImageDLFailureEvent(lookup));
+        return false;
+    }
+
+    if (!onMaster)
+    {
+        RemoteFile *outFile = new RemoteFile(finalfile, true);
+        if (!outFile->isOpen())
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Image Download: Failed to open "
+                        "remote file (%1) for write.  Does "
+                        "Storage Group Exist?")
+                        .arg(finalfile));
+            delete outFile;
+            outFile = NULL;
+            QCoreApplication::postEvent(m_parent,
+                        new ImageDLFailureEvent(lookup));
+            return false;
+        }
+
+        off_t written = outFile->Write(download, download.size());
+        delete outFile;
+        outFile = NULL;
+
+        if (written != download.size())
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Image Download: Error Writing Image "
+                        "to file: %1").arg(finalfile));
+            QCoreApplication::postEvent(m_parent,
+                    new ImageDLFailureEvent(lookup));
+            return false;
+        }
+    }
+    else
+    {
+        if (!storeArtwork(resolvedFN, cached, download))
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Image Download: Error Writing Image "
+                        "to file: %1").arg(finalfile));
+            QCoreApplication::postEvent(m_parent,
+                        new ImageDLFailureEvent(lookup));
+            return false;
+        }
+    }
+
+    // the UI refers to storage group artwork by the backend's own address
+    primeImageCache(type, generate_file_url(getStorageGroupName(type),
+                                            lookup->GetHost(), filename),
+                    image);
+    return true;
 }
 
-MetadataLookup* MetadataImageDownload::moreDownloads()
+/**
+ *  \brief Scale freshly downloaded artwork to the size set with
+ *         setDisplaySize() and save it in the theme's image cache under
+ *         the name the UI will look for.
+ */
+void MetadataImageDownload::primeImageCache(VideoArtworkType type,
+                                            const QString &filename,
+                                            const QImage &image)
 {
-    MetadataLookup *ret = NULL;
     m_mutex.lock();
-    if (!m_downloadList.isEmpty())
-        ret = m_downloadList.takeFirst();
+    bool wanted = m_displaySizes.contains(type);
+    DisplaySize display = m_displaySizes.value(type);
+    QString cacheDir = m_themeCacheDir;
     m_mutex.unlock();
-    return ret;
+
+    if (!wanted)
+        return;
+
+    QDir dir(cacheDir);
+    if (!dir.exists() && !dir.mkpath(cacheDir))
+        return;
+
+    QString label = MythUIImage::GenImageLabel(filename, QString(),
+                                               display.size.width(),
+                                               display.size.height());
+
+    QImage scaled = image.scaled(display.size,
+                                 display.preserveAspect ?
+                                     Qt::KeepAspectRatio :
+                                     Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation);
+
+    if (!scaled.save(dir.filePath(label), "PNG"))
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("Image Download: Unable to save scaled copy of %1")
+                .arg(filename));
+    }
 }
 
 QString getDownloadFilename(QString title, QString url)
@@ -449,23 +870,11 @@ QString getLocalWritePath(MetadataType metadatatype, VideoArtworkType type)
 
 QString getStorageGroupURL(VideoArtworkType type, QString host)
 {
-    QString sgroup;
     QString ip = gCoreContext->GetSettingOnHost("BackendServerIP", host);
     uint port = gCoreContext->GetSettingOnHost("BackendServerPort",
                                                host).toUInt();
 
-    if (type == kArtworkCoverart)
-        sgroup = "Coverart";
-    else if (type == kArtworkFanart)
-        sgroup = "Fanart";
-    else if (type == kArtworkBanner)
-        sgroup = "Banners";
-    else if (type == kArtworkScreenshot)
-        sgroup = "Screenshots";
-    else
-        sgroup = "Default";
-
-    return gCoreContext->GenMythURL(ip,port,"",sgroup);
+    return gCoreContext->GenMythURL(ip,port,"",getStorageGroupName(type));
 }
 
 QString getLocalStorageGroupPath(VideoArtworkType type, QString host)
@@ -473,17 +882,7 @@ QString getLocalStorageGroupPath(VideoArtworkType type, QString host)
     QString path;
 
     StorageGroup sg;
-
-    if (type == kArtworkCoverart)
-        sg.Init("Coverart", host);
-    else if (type == kArtworkFanart)
-        sg.Init("Fanart", host);
-    else if (type == kArtworkBanner)
-        sg.Init("Banners", host);
-    else if (type == kArtworkScreenshot)
-        sg.Init("Screenshots", host);
-    else
-        sg.Init("Default", host);
+    sg.Init(getStorageGroupName(type), host);
 
     path = sg.FindNextDirMostFree();
 
@@ -510,5 +909,32 @@ void cleanThumbnailCacheDir()
             QFile::remove(filename);
         }
     }
+
+    // Artwork lasts longer, the index is rebuilt without the old entries
+    QMutexLocker locker(&s_artworkLock);
+
+    loadArtworkIndex();
+
+    QDir artworkDir(getArtworkCacheDir());
+    QStringList artwork = artworkDir.entryList(QDir::Files);
+    QDateTime expired = MythDate::current().addDays(-kArtworkCacheDays);
+    bool removed = false;
+
+    for (QStringList::const_iterator i = artwork.begin();
+            i != artwork.end(); ++i)
+    {
+        if (*i == ARTWORK_INDEX_FILE)
+            continue;
+
+        QFileInfo fi(artworkDir.filePath(*i));
+        if (fi.lastModified() < expired)
+        {
+            QFile::remove(fi.filePath());
+            removed = true;
+        }
+    }
+
+    if (removed)
+        saveArtworkIndex();
 }
 
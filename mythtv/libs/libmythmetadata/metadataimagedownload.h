@@ -3,8 +3,12 @@
 
 #include <QString>
 #include <QStringList>
+#include <QMutex>
+#include <QEvent>
+#include <QSize>
+#include <QMap>
+#include <QSet>
 
-#include "mthread.h"
 #include "mythmetaexp.h"
 #include "metadatacommon.h"
 
@@ -53,8 +57,13 @@ class META_PUBLIC ThumbnailDLEvent : public QEvent
     static Type kEventType;
 };
 
-class META_PUBLIC MetadataImageDownload : public MThread
+class MThreadPool;
+class QImage;
+
+class META_PUBLIC MetadataImageDownload
 {
+    friend class ImageDLWorker;
+
   public:
 
     MetadataImageDownload(QObject *parent);
@@ -62,21 +71,58 @@ class META_PUBLIC MetadataImageDownload : public MThread
 
     void addThumb(QString title, QString url, QVariant data);
     void addDownloads(MetadataLookup *lookup);
+    void setDisplaySize(VideoArtworkType type, const QSize &size,
+                        bool preserveAspect = true);
     void cancel();
-
-  protected:
-
-    void run();
+    bool isRunning();
 
   private:
 
-    ThumbnailData*             moreThumbs();
-    MetadataLookup*            moreDownloads();
+    /// One image to fetch, either a thumbnail or a piece of artwork
+    /// belonging to a lookup
+    struct ImageDLJob
+    {
+        ThumbnailData    *thumb;
+        MetadataLookup   *lookup;
+        VideoArtworkType  type;
+        ArtworkInfo       info;
+        QString           filename;
+        QString           host;
+    };
+
+    /// Size a theme shows a type of artwork at
+    struct DisplaySize
+    {
+        QSize size;
+        bool  preserveAspect;
+    };
+
+    void startWorkers();
+    void processQueue();
+    bool takeJob(ImageDLJob &job);
+    void finishJob(const ImageDLJob &job, bool ok);
+
+    void downloadThumb(ThumbnailData *thumb, const QString &filename);
+    bool downloadArtwork(ImageDLJob &job);
+    void primeImageCache(VideoArtworkType type, const QString &filename,
+                         const QImage &image);
 
     QObject                   *m_parent;
-    QList<MetadataLookup*>     m_downloadList;
-    QList<ThumbnailData*>      m_thumbnailList;
+    QList<ImageDLJob>          m_downloadList;
+    QList<ImageDLJob>          m_thumbnailList;
     QMutex                     m_mutex;
+
+    MThreadPool               *m_pool;
+    int                        m_workers;
+    QMap<QString, int>         m_hostDownloads;
+    QSet<QString>              m_activeFiles;
+
+    QMap<MetadataLookup*, int>          m_pending;
+    QMap<MetadataLookup*, DownloadMap>  m_downloaded;
+    QSet<MetadataLookup*>               m_cancelled;
+
+    QMap<VideoArtworkType, DisplaySize> m_displaySizes;
+    QString                             m_themeCacheDir;
 };
 
 META_PUBLIC QString getDownloadFilename(QString title, QString url);
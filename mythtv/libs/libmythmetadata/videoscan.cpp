@@ -1,5 +1,7 @@
 #include <QImageReader>
 #include <QApplication>
+#include <QRunnable>
+#include <QThread>
 #include <QUrl>
 
 #include "mythcontext.h"
@@ -16,6 +18,8 @@
 #include "remoteutil.h"
 #include "mythlogging.h"
 #include "mythdate.h"
+#include "mythdirs.h"
+#include "mthreadpool.h"
 
 QEvent::Type VideoScanChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
@@ -70,22 +74,50 @@ namespace
     };
 }
 
+/// Works through one of the scanner's queues on a pool thread
+class VideoScanWorker : public QRunnable
+{
+  public:
+    VideoScanWorker(VideoScannerThread *scanner, bool hash) :
+        m_scanner(scanner), m_hash(hash) {}
+
+    void run(void)
+    {
+        if (m_hash)
+            m_scanner->hashQueue();
+        else
+            m_scanner->scanQueue();
+    }
+
+  private:
+    VideoScannerThread *m_scanner;
+    bool                m_hash;
+};
+
 class VideoMetadataListManager;
 class MythUIProgressDialog;
 
 VideoScannerThread::VideoScannerThread(QObject *parent) :
     MThread("VideoScanner"),
-    m_RemoveAll(false), m_KeepAll(false),
-    m_DBDataChanged(false)
+    m_RemoveAll(false), m_KeepAll(false), m_dialog(NULL),
+    m_DBDataChanged(false), m_pool(new MThreadPool("VideoScanner")),
+    m_nextJob(0), m_jobsDone(0), m_filesFound(0), m_nextHash(0)
 {
     m_parent = parent;
     m_dbmetadata = new VideoMetadataListManager;
     m_HasGUI = gCoreContext->HasGUI();
     m_ListUnknown = gCoreContext->GetNumSetting("VideoListUnknownFiletypes", 0);
+    m_dirCache = new DirectoryCache(GetConfDir() + "/videoscan.cache");
+
+    // Most of the time goes in waiting on disks and other backends, so
+    // run more at once than there are cores
+    m_pool->setMaxThreadCount(qMax(QThread::idealThreadCount(), 4));
 }
 
 VideoScannerThread::~VideoScannerThread()
 {
+    delete m_pool;
+    delete m_dirCache;
     delete m_dbmetadata;
 }
 
@@ -163,36 +195,17 @@ void VideoScannerThread::run()
 
     LOG(VB_GENERAL, LOG_INFO, QString("Beginning Video Scan."));
 
-    uint counter = 0;
     FileCheckList fs_files;
 
-    if (m_HasGUI)
-        SendProgressEvent(counter, (uint)m_directories.size(),
-                          QObject::tr("Searching for video files"));
-    for (QStringList::const_iterator iter = m_directories.begin();
-         iter != m_directories.end(); ++iter)
-    {
-        if (!buildFileList(*iter, imageExtensions, fs_files))
-        {
-            if (iter->startsWith("myth://"))
-            {
-                QUrl sgurl = *iter;
-                QString host = sgurl.host().toLower();
-                QString path = sgurl.path();
-
-                m_liveSGHosts.removeAll(host);
-
-                LOG(VB_GENERAL, LOG_ERR,
-                    QString("Failed to scan :%1:").arg(*iter));
-            }
-        }
-        if (m_HasGUI)
-            SendProgressEvent(++counter);
-    }
+    m_dirCache->Load();
+    scanDirectories(imageExtensions, fs_files);
+    m_dirCache->Save();
 
     PurgeList db_remove;
     verifyFiles(fs_files, db_remove);
+    hashNewFiles(fs_files);
     m_DBDataChanged = updateDB(fs_files, db_remove);
+    m_hashes.clear();
 
     if (m_DBDataChanged)
     {
@@ -311,7 +324,7 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
             int id = -1;
 
             // Are we sure this needs adding?  Let's check our Hash list.
-            QString hash = VideoMetadata::VideoFileHash(p->first, p->second.host);
+            QString hash = m_hashes.value(p->first);
             if (hash != "NULL" && !hash.isEmpty())
             {
                 id = VideoMetadata::UpdateHashedDBRecord(hash, p->first, p->second.host);
@@ -391,11 +404,145 @@ bool VideoScannerThread::buildFileList(const QString &directory,
 
     LOG(VB_GENERAL,LOG_INFO, QString("buildFileList directory = %1")
                                  .arg(directory));
-    FileAssociations::ext_ignore_list ext_list;
-    FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
-    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown);
+    return ScanVideoDirectory(directory, &dh, m_extList, m_ListUnknown,
+                              m_dirCache);
+}
+
+/**
+ *  \brief Scan all the video directories, several at a time.
+ *
+ *  Each directory is scanned into its own list on a pool thread.  The lists
+ *  are then merged in the order the directories were given, so a file found
+ *  in more than one ends up with the same host as a one at a time scan
+ *  would give it.
+ */
+void VideoScannerThread::scanDirectories(const QStringList &imageExtensions,
+                                         FileCheckList &filelist)
+{
+    FileAssociations::getFileAssociation().getExtensionIgnoreList(m_extList);
+
+    m_imageExtensions = imageExtensions;
+    m_scanJobs.clear();
+    for (QStringList::const_iterator iter = m_directories.begin();
+         iter != m_directories.end(); ++iter)
+    {
+        ScanJob job;
+        job.dir = *iter;
+        job.ok = false;
+        m_scanJobs.push_back(job);
+    }
+    m_nextJob = m_jobsDone = m_filesFound = 0;
+
+    if (m_HasGUI)
+        SendProgressEvent(0, (uint)m_scanJobs.size(),
+                          QObject::tr("Searching for video files"));
+
+    int workers = qMin(m_pool->maxThreadCount(), (int)m_scanJobs.size());
+    for (int i = 0; i < workers; ++i)
+        m_pool->start(new VideoScanWorker(this, false), "VideoScanWorker");
+    m_pool->waitForDone();
+
+    std::vector<ScanJob>::const_iterator job = m_scanJobs.begin();
+    for (; job != m_scanJobs.end(); ++job)
+    {
+        FileCheckList::const_iterator p = job->files.begin();
+        for (; p != job->files.end(); ++p)
+            filelist[p->first] = p->second;
+
+        if (!job->ok && job->dir.startsWith("myth://"))
+        {
+            QUrl sgurl = job->dir;
+            QString host = sgurl.host().toLower();
+
+            m_liveSGHosts.removeAll(host);
+
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Failed to scan :%1:").arg(job->dir));
+        }
+    }
+
+    m_scanJobs.clear();
+}
+
+void VideoScannerThread::scanQueue(void)
+{
+    m_queueLock.lock();
+    while (m_nextJob < m_scanJobs.size())
+    {
+        ScanJob &job = m_scanJobs[m_nextJob++];
+        m_queueLock.unlock();
+
+        job.ok = buildFileList(job.dir, m_imageExtensions, job.files);
+
+        m_queueLock.lock();
+        m_jobsDone++;
+        m_filesFound += job.files.size();
+
+        LOG(VB_GENERAL, LOG_INFO,
+            QString("Scanned %1 (%2 of %3), %4 files found so far")
+                .arg(job.dir).arg(m_jobsDone).arg(m_scanJobs.size())
+                .arg(m_filesFound));
+
+        if (m_HasGUI)
+            SendProgressEvent(m_jobsDone);
+    }
+    m_queueLock.unlock();
+}
+
+/**
+ *  \brief Work out the hashes of all the files not yet in the database.
+ *
+ *  There is no backend command to hash many files at once, so instead the
+ *  requests are all made up front from the pool threads, where the time
+ *  spent reading local files overlaps with the waits on other backends.
+ */
+void VideoScannerThread::hashNewFiles(const FileCheckList &files)
+{
+    m_hashQueue.clear();
+    m_hashes.clear();
+    m_nextHash = 0;
+
+    for (FileCheckList::const_iterator p = files.begin();
+         p != files.end(); ++p)
+    {
+        if (!p->second.check)
+            m_hashQueue.push_back(std::make_pair(p->first, p->second.host));
+    }
+
+    if (m_hashQueue.empty())
+        return;
+
+    if (m_HasGUI)
+        SendProgressEvent(0, (uint)m_hashQueue.size(),
+                          QObject::tr("Checking new video files"));
+
+    int workers = qMin(m_pool->maxThreadCount(), (int)m_hashQueue.size());
+    for (int i = 0; i < workers; ++i)
+        m_pool->start(new VideoScanWorker(this, true), "VideoScanWorker");
+    m_pool->waitForDone();
+
+    m_hashQueue.clear();
+}
+
+void VideoScannerThread::hashQueue(void)
+{
+    m_queueLock.lock();
+    while (m_nextHash < m_hashQueue.size())
+    {
+        std::pair<QString, QString> file = m_hashQueue[m_nextHash++];
+        m_queueLock.unlock();
+
+        QString hash = VideoMetadata::VideoFileHash(file.first, file.second);
+
+        m_queueLock.lock();
+        m_hashes[file.first] = hash;
+
+        if (m_HasGUI)
+            SendProgressEvent(m_hashes.size());
+    }
+    m_queueLock.unlock();
 }
 
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
@@ -8,11 +8,16 @@
 #include <QObject> // for moc
 #include <QStringList>
 #include <QEvent>
+#include <QMutex>
+#include <QMap>
 
 #include "mythmetaexp.h"
 #include "mthread.h"
+#include "dbaccess.h"
 
 class QStringList;
+class MThreadPool;
+class DirectoryCache;
 
 class MythUIProgressDialog;
 
@@ -58,6 +63,8 @@ class META_PUBLIC VideoScanChanges : public QEvent
 
 class META_PUBLIC VideoScannerThread : public MThread
 {
+    friend class VideoScanWorker;
+
   public:
     VideoScannerThread(QObject *parent);
     ~VideoScannerThread();
@@ -82,6 +89,14 @@ class META_PUBLIC VideoScannerThread : public MThread
     typedef std::vector<std::pair<unsigned int, QString> > PurgeList;
     typedef std::map<QString, CheckStruct> FileCheckList;
 
+    /// One of the directories being scanned and what was found in it
+    struct ScanJob
+    {
+        QString       dir;
+        FileCheckList files;
+        bool          ok;
+    };
+
     void removeOrphans(unsigned int id, const QString &filename);
 
     void verifyFiles(FileCheckList &files, PurgeList &remove);
@@ -89,6 +104,12 @@ class META_PUBLIC VideoScannerThread : public MThread
     bool buildFileList(const QString &directory,
                                         const QStringList &imageExtensions,
                                         FileCheckList &filelist);
+    void scanDirectories(const QStringList &imageExtensions,
+                         FileCheckList &filelist);
+    void hashNewFiles(const FileCheckList &files);
+
+    void scanQueue(void);
+    void hashQueue(void);
 
     void SendProgressEvent(uint progress, uint total = 0,
             QString messsage = QString());
@@ -110,6 +131,21 @@ class META_PUBLIC VideoScannerThread : public MThread
     QList<int> m_movList; // intids moved to new filename
     QList<int> m_delList; // orphaned/deleted intids
     bool m_DBDataChanged;
+
+    MThreadPool    *m_pool;
+    DirectoryCache *m_dirCache;
+    FileAssociations::ext_ignore_list m_extList;
+
+    // Shared with the pool threads, guarded by m_queueLock
+    QMutex                 m_queueLock;
+    QStringList            m_imageExtensions;
+    std::vector<ScanJob>   m_scanJobs;
+    uint                   m_nextJob;
+    uint                   m_jobsDone;
+    uint                   m_filesFound;
+    std::vector<std::pair<QString, QString> > m_hashQueue;
+    uint                   m_nextHash;
+    QMap<QString, QString> m_hashes;
 };
 
 #endif
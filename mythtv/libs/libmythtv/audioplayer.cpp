@@ -506,6 +506,16 @@ bool AudioPlayer::GetBufferStatus(uint &fill, uint &total)
     return true;
 }
 
+bool AudioPlayer::GetLatencyStats(int &target, int &current, uint &underruns)
+{
+    target = current = 0;
+    underruns = 0;
+    if (!m_audioOutput || m_no_audio_out)
+        return false;
+    m_audioOutput->GetLatencyStats(target, current, underruns);
+    return true;
+}
+
 bool AudioPlayer::IsBufferAlmostFull(void)
 {
     uint ofill = 0, ototal = 0, othresh = 0;
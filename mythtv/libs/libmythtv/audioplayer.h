@@ -75,6 +75,7 @@ class MTV_PUBLIC AudioPlayer
     bool NeedDecodingBeforePassthrough(void);
     int64_t LengthLastData(void);
     bool GetBufferStatus(uint &fill, uint &total);
+    bool GetLatencyStats(int &target, int &current, uint &underruns);
     bool IsBufferAlmostFull(void);
 
   private:
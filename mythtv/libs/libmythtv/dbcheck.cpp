@@ -448,6 +448,15 @@ bool UpgradeTVDatabaseSchema(const bool upgradeAllowed,
 #ifdef IGNORE_SCHEMA_VER_MISMATCH
     return true;
 #endif
+    // A host that may not upgrade only needs to know the schema is
+    // current, which the version setting tells it without taking the
+    // upgrade lock or building the wizard.
+    if (!upgradeAllowed &&
+        gCoreContext->GetSetting("DBSchemaVer") == currentDatabaseVersion)
+    {
+        return true;
+    }
+
     SchemaUpgradeWizard *schema_wizard = NULL;
 
     // Suppress DB messages and turn off the settings cache,
@@ -24,6 +24,7 @@
 #include "dtvrecorder.h"
 #include "programinfo.h"
 #include "mythlogging.h"
+#include "mythdb.h"
 #include "mpegtables.h"
 #include "ringbuffer.h"
 #include "tv_rec.h"
@@ -133,8 +134,10 @@ void DTVRecorder::SetOptionsFromProfile(RecordingProfile *profile,
                                         const QString &videodev,
                                         const QString&, const QString&)
 {
+    static MythSettingHandle tvformat("TVFormat");
+
     SetOption("videodevice", videodev);
-    DTVRecorder::SetOption("tvformat", gCoreContext->GetSetting("TVFormat"));
+    DTVRecorder::SetOption("tvformat", tvformat.GetString());
     SetStrOption(profile, "recordingtype");
 }
 
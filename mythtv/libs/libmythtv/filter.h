@@ -23,6 +23,11 @@ typedef struct VideoFilter_ VideoFilter;
 
 typedef VideoFilter*(*init_filter)(int, int, int *, int *, char *, int);
 
+/* Filters rows [begin, end) of the luma plane, and the matching chroma
+ * rows, in place. Filters that provide this must be safe to call from
+ * several threads at once on disjoint row ranges of the same frame. */
+typedef int(*slice_filter)(VideoFilter *, VideoFrame *, int, int, int);
+
 typedef struct FilterInfo_
 {
     init_filter filter_init;
@@ -30,6 +35,7 @@ typedef struct FilterInfo_
     char *descript;
     FmtConv *formats;
     char *libname;
+    slice_filter filter_slice; /* optional, NULL if not slice safe */
 } FilterInfo;
 
 struct VideoFilter_
@@ -44,7 +50,7 @@ struct VideoFilter_
     FilterInfo *info;
 };
 
-#define FILT_NULL {NULL,NULL,NULL,NULL,NULL}
+#define FILT_NULL {NULL,NULL,NULL,NULL,NULL,NULL}
 
 #ifdef TIME_FILTER
 
@@ -10,14 +10,81 @@
 // Qt headers
 #include <QDir>
 #include <QStringList>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
 
 // MythTV headers
 #include "mythcontext.h"
 #include "filtermanager.h"
 #include "mythdirs.h"
+#include "mthreadpool.h"
 
 #define LOC QString("FilterManager: ")
 
+// Slice heights are kept even so that YV12 chroma rows split cleanly,
+// and slices smaller than this are not worth handing to another thread.
+#define SLICE_ROW_ALIGN  2
+#define SLICE_MIN_ROWS  32
+
+static QMutex       slice_pool_lock;
+static MThreadPool *slice_pool = NULL;
+
+/// Pool shared by every FilterChain for running slice safe filters.
+static MThreadPool *GetSlicePool(void)
+{
+    QMutexLocker locker(&slice_pool_lock);
+    if (!slice_pool)
+    {
+        slice_pool = new MThreadPool("FilterSlicePool");
+        slice_pool->setMaxThreadCount(max(QThread::idealThreadCount(), 1));
+    }
+    return slice_pool;
+}
+
+static void RunSlice(const vector<VideoFilter*> &filters,
+                     const vector<slice_filter> &slice_filters,
+                     uint first, uint last, VideoFrame *frame, int field,
+                     int begin, int end)
+{
+    // Run every filter of the group on these rows before moving on,
+    // so the rows are still in cache for the next filter.
+    for (uint i = first; i < last; i++)
+        slice_filters[i](filters[i], frame, field, begin, end);
+}
+
+class FilterSliceTask : public QRunnable
+{
+  public:
+    FilterSliceTask(const vector<VideoFilter*> &filters,
+                    const vector<slice_filter> &slice_filters,
+                    uint first, uint last, VideoFrame *frame, int field,
+                    int begin, int end, QSemaphore *done) :
+        m_filters(filters), m_slice_filters(slice_filters),
+        m_first(first), m_last(last), m_frame(frame), m_field(field),
+        m_begin(begin), m_end(end), m_done(done)
+    {
+    }
+
+    virtual void run(void)
+    {
+        RunSlice(m_filters, m_slice_filters, m_first, m_last,
+                 m_frame, m_field, m_begin, m_end);
+        m_done->release();
+    }
+
+  private:
+    const vector<VideoFilter*> &m_filters;
+    const vector<slice_filter> &m_slice_filters;
+    uint        m_first;
+    uint        m_last;
+    VideoFrame *m_frame;
+    int         m_field;
+    int         m_begin;
+    int         m_end;
+    QSemaphore *m_done;
+};
+
 static const char *FmtToString(VideoFrameType ft)
 {
     switch(ft)
@@ -53,14 +120,79 @@ FilterChain::~FilterChain()
     filters.clear();
 }
 
+void FilterChain::Append(VideoFilter *f)
+{
+    filters.push_back(f);
+    slice_filters.push_back((f->info) ? f->info->filter_slice : NULL);
+}
+
 void FilterChain::ProcessFrame(VideoFrame *frame, FrameScanType scan)
 {
     if (!frame)
         return;
 
-    vector<VideoFilter*>::iterator it = filters.begin();
-    for (; it != filters.end(); ++it)
-        (*it)->filter(*it, frame, kScan_Intr2ndField == scan);
+    int field = (kScan_Intr2ndField == scan);
+    bool sliced = (slices > 1) &&
+        (frame->height >= SLICE_MIN_ROWS * 2);
+
+    uint i = 0;
+    while (i < filters.size())
+    {
+        if (!sliced || !slice_filters[i])
+        {
+            filters[i]->filter(filters[i], frame, field);
+            i++;
+            continue;
+        }
+
+        // Group adjacent slice safe filters so each slice runs them all
+        uint first = i;
+        while (i < filters.size() && slice_filters[i])
+            i++;
+        ProcessSlices(first, i, frame, field);
+    }
+}
+
+/**
+ *  Runs filters [first, last) over horizontal slices of the frame,
+ *  one slice on the calling thread and the rest on the shared pool.
+ *  If no pool thread is free a slice is run here instead.
+ */
+void FilterChain::ProcessSlices(uint first, uint last,
+                                VideoFrame *frame, int field)
+{
+    int height = frame->height;
+    int rows = (height + slices - 1) / slices;
+    rows = max(rows, SLICE_MIN_ROWS);
+    rows = (rows + SLICE_ROW_ALIGN - 1) & ~(SLICE_ROW_ALIGN - 1);
+
+    MThreadPool *pool = GetSlicePool();
+    QSemaphore done;
+    int pending = 0;
+
+    for (int begin = rows; begin < height; begin += rows)
+    {
+        int end = min(begin + rows, height);
+        FilterSliceTask *task = new FilterSliceTask(
+            filters, slice_filters, first, last, frame, field,
+            begin, end, &done);
+
+        if (pool->tryStart(task, "FilterSlice"))
+        {
+            pending++;
+        }
+        else
+        {
+            delete task;
+            RunSlice(filters, slice_filters, first, last, frame, field,
+                     begin, end);
+        }
+    }
+
+    RunSlice(filters, slice_filters, first, last, frame, field,
+             0, min(rows, height));
+
+    done.acquire(pending);
 }
 
 FilterManager::FilterManager()
@@ -160,6 +292,7 @@ bool FilterManager::LoadFilterLib(const QString &path)
 
         FilterInfo *newFilter = new FilterInfo;
         newFilter->filter_init = NULL;
+        newFilter->filter_slice = filtInfo->filter_slice;
         newFilter->name     = strdup(filtInfo->name);
         newFilter->descript = strdup(filtInfo->descript);
 
@@ -202,7 +335,7 @@ FilterChain *FilterManager::LoadFilters(QString Filters,
         return NULL;
 
     vector<const FilterInfo*> FiltInfoChain;
-    FilterChain *FiltChain = new FilterChain;
+    FilterChain *FiltChain = new FilterChain(max_threads);
     vector<FmtConv*> FmtList;
     const FilterInfo *FI;
     const FilterInfo *FI2;
@@ -9,6 +9,7 @@ extern "C" {
 // C++ headers
 #include <vector>
 #include <map>
+#include <algorithm>
 using namespace std;
 
 // Qt headers
@@ -22,15 +23,19 @@ typedef map<QString,FilterInfo*> filter_map_t;
 class FilterChain
 {
   public:
-    FilterChain() { }
+    explicit FilterChain(int threads = 1) : slices(max(threads, 1)) { }
     virtual ~FilterChain();
 
     void ProcessFrame(VideoFrame *Frame, FrameScanType scan = kScan_Ignore);
 
-    void Append(VideoFilter *f) { filters.push_back(f); }
+    void Append(VideoFilter *f);
 
   private:
+    void ProcessSlices(uint first, uint last, VideoFrame *frame, int field);
+
     vector<VideoFilter*> filters;
+    vector<slice_filter> slice_filters; // parallel to filters, may be NULL
+    int                  slices;
 };
 
 class FilterManager
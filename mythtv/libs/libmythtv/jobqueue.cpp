@@ -65,7 +65,7 @@ JobQueue::JobQueue(bool master) :
         "you compiled with the --enable-valgrind option.");
 #endif // USING_VALGRIND
 
-    gCoreContext->addListener(this);
+    gCoreContext->addListener(this, QStringList("LOCAL_JOB"));
 }
 
 JobQueue::~JobQueue(void)
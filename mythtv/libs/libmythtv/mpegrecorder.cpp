@@ -33,6 +33,7 @@ extern "C" {
 #include "mpegrecorder.h"
 #include "ringbuffer.h"
 #include "mythcorecontext.h"
+#include "mythdb.h"
 #include "programinfo.h"
 #include "recordingprofile.h"
 #include "tv_rec.h"
@@ -311,8 +312,11 @@ void MpegRecorder::SetOptionsFromProfile(RecordingProfile *profile,
     SetOption("vbidevice", vbidev);
     SetOption("audiodevice", audiodev);
 
-    SetOption("tvformat", gCoreContext->GetSetting("TVFormat"));
-    SetOption("vbiformat", gCoreContext->GetSetting("VbiFormat"));
+    static MythSettingHandle tvformat("TVFormat");
+    static MythSettingHandle vbiformat("VbiFormat");
+
+    SetOption("tvformat", tvformat.GetString());
+    SetOption("vbiformat", vbiformat.GetString());
 
     SetIntOption(profile, "mpeg2bitrate");
     SetIntOption(profile, "mpeg2maxbitrate");
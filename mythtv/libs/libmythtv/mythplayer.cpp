@@ -54,6 +54,7 @@ using namespace std;
 #include "tv_play.h"
 #include "interactivetv.h"
 #include "myth_imgconvert.h"
+#include "yuv2rgb.h"
 #include "mythsystemevent.h"
 #include "mythpainter.h"
 #include "mythimage.h"
@@ -1027,8 +1028,12 @@ void MythPlayer::SetVideoFilters(const QString &override)
 void MythPlayer::InitFilters(void)
 {
     QString filters = "";
+    int threads = 1;
     if (videoOutput)
+    {
         filters = videoOutput->GetFilters();
+        threads = videoOutput->GetFilterThreads();
+    }
 
     LOG(VB_PLAYBACK, LOG_DEBUG, LOC +
         QString("InitFilters() vo '%1' prog '%2' over '%3'")
@@ -1075,7 +1080,8 @@ void MythPlayer::InitFilters(void)
         postfilt_height = video_dim.height();
 
         videoFilters = FiltMan->LoadFilters(
-            filters, itmp, otmp, postfilt_width, postfilt_height, btmp);
+            filters, itmp, otmp, postfilt_width, postfilt_height, btmp,
+            threads);
     }
 
     videofiltersLock.unlock();
@@ -4219,9 +4225,22 @@ char *MythPlayer::GetScreenGrabAtFrame(uint64_t frameNum, bool absolute,
     avpicture_fill(&retbuf, outputbuf, PIX_FMT_RGB32,
                    video_dim.width(), video_dim.height());
 
-    myth_sws_img_convert(
-        &retbuf, PIX_FMT_RGB32, &orig, PIX_FMT_YUV420P,
-                video_dim.width(), video_dim.height());
+    static yuv2rgb_fun argb32_conv = yuv2rgb_init_mmx(32, MODE_RGB);
+
+    // The SSE2/MMX converters work in steps of 8 pixels.
+    if (argb32_conv && !(video_dim.width() & 0x7) &&
+        !(video_dim.height() & 0x1))
+    {
+        argb32_conv(retbuf.data[0], orig.data[0], orig.data[1], orig.data[2],
+                    video_dim.width(), video_dim.height(),
+                    retbuf.linesize[0], orig.linesize[0], orig.linesize[1], 1);
+    }
+    else
+    {
+        myth_sws_img_convert(
+            &retbuf, PIX_FMT_RGB32, &orig, PIX_FMT_YUV420P,
+                    video_dim.width(), video_dim.height());
+    }
 
     vw = video_dim.width();
     vh = video_dim.height();
@@ -4556,6 +4575,13 @@ void MythPlayer::GetPlaybackData(InfoMap &infoMap)
                                          .arg(videoOutput->FreeVideoFrames());
         infoMap.insert("videoframes", frames);
     }
+    int latency_target, latency_current;
+    uint underruns;
+    if (audio.GetLatencyStats(latency_target, latency_current, underruns))
+    {
+        infoMap["audiolatency"] = QString("%1/%2ms (%3)")
+            .arg(latency_current).arg(latency_target).arg(underruns);
+    }
     if (decoder)
         infoMap["videodecoder"] = decoder->GetCodecDecoderName();
     if (output_jmeter)
@@ -259,8 +259,13 @@ void MythSystemEventHandler::customEvent(QEvent *e)
         MythEvent *me = (MythEvent *)e;
         QString msg = me->Message().simplified();
 
+        // A single changed setting is not worth a system event
         if (msg == "CLEAR_SETTINGS_CACHE")
+        {
+            if (me->ExtraDataCount() && me->ExtraData() != "empty")
+                return;
             msg = "SYSTEM_EVENT SETTINGS_CACHE_CLEARED";
+        }
 
         // Listen for any GLOBAL_SYSTEM_EVENT messages and resend to
         // the master backend as regular SYSTEM_EVENT messages.
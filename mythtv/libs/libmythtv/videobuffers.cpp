@@ -167,13 +167,13 @@ void VideoBuffers::Init(uint numdecode, bool extra_for_pause,
     buffers.reserve(max(numcreate, (uint)128));
 
     buffers.resize(numcreate);
+    frame_state.resize(numcreate, 0);
     for (uint i = 0; i < numcreate; i++)
     {
         memset(at(i), 0, sizeof(VideoFrame));
         at(i)->codec            = FMT_NONE;
         at(i)->interlaced_frame = -1;
         at(i)->top_field_first  = +1;
-        vbufferMap[at(i)]       = i;
     }
 
     needfreeframes              = need_free;
@@ -217,7 +217,7 @@ void VideoBuffers::Reset()
     decode.clear();
     pause.clear();
     displayed.clear();
-    vbufferMap.clear();
+    frame_state.assign(buffers.size(), 0);
 }
 
 /**
@@ -239,19 +239,19 @@ VideoFrame *VideoBuffers::GetNextFreeFrameInternal(BufferType enqueue_to)
     // Try to get a frame not being used by the decoder
     for (uint i = 0; i < available.size(); i++)
     {
-        frame = available.dequeue();
-        if (decode.contains(frame))
-            available.enqueue(frame);
+        frame = dequeue(kVideoBuffer_avail);
+        if (FrameState(frame) & kVideoBuffer_decode)
+            enqueue(kVideoBuffer_avail, frame);
         else
             break;
     }
 
-    while (frame && used.contains(frame))
+    while (frame && (FrameState(frame) & kVideoBuffer_used))
     {
         LOG(VB_PLAYBACK, LOG_NOTICE,
             QString("GetNextFreeFrame() served a busy frame %1. Dropping. %2")
                 .arg(DebugString(frame, true)).arg(GetStatus()));
-        frame = available.dequeue();
+        frame = dequeue(kVideoBuffer_avail);
     }
 
     if (frame)
@@ -307,10 +307,10 @@ void VideoBuffers::ReleaseFrame(VideoFrame *frame)
 {
     QMutexLocker locker(&global_lock);
 
-    vpos = vbufferMap[frame];
-    limbo.remove(frame);
-    decode.enqueue(frame);
-    used.enqueue(frame);
+    vpos = max(FrameIndex(frame), 0);
+    remove(kVideoBuffer_limbo, frame);
+    enqueue(kVideoBuffer_decode, frame);
+    enqueue(kVideoBuffer_used, frame);
 }
 
 /**
@@ -321,17 +321,15 @@ void VideoBuffers::ReleaseFrame(VideoFrame *frame)
 void VideoBuffers::DeLimboFrame(VideoFrame *frame)
 {
     QMutexLocker locker(&global_lock);
-    if (limbo.contains(frame))
-        limbo.remove(frame);
+    remove(kVideoBuffer_limbo, frame);
 
     // if decoder didn't release frame and the buffer is getting released by
     // the decoder assume that the frame is lost and return to available
-    if (!decode.contains(frame))
+    if (!(FrameState(frame) & kVideoBuffer_decode))
         safeEnqueue(kVideoBuffer_avail, frame);
 
     // remove from decode queue since the decoder is finished
-    while (decode.contains(frame))
-        decode.remove(frame);
+    remove(kVideoBuffer_decode, frame);
 }
 
 /**
@@ -341,7 +339,7 @@ void VideoBuffers::DeLimboFrame(VideoFrame *frame)
 void VideoBuffers::StartDisplayingFrame(void)
 {
     QMutexLocker locker(&global_lock);
-    rpos = vbufferMap[used.head()];
+    rpos = max(FrameIndex(used.head()), 0);
 }
 
 /**
@@ -352,8 +350,7 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
 {
     QMutexLocker locker(&global_lock);
 
-    if(used.contains(frame))
-        remove(kVideoBuffer_used, frame);
+    remove(kVideoBuffer_used, frame);
 
     enqueue(kVideoBuffer_finished, frame);
 
@@ -362,7 +359,7 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
     frame_queue_t::iterator it = ula.begin();
     for (; it != ula.end(); ++it)
     {
-        if (!decode.contains(*it))
+        if (!(FrameState(*it) & kVideoBuffer_decode))
         {
             remove(kVideoBuffer_finished, *it);
             enqueue(kVideoBuffer_avail, *it);
@@ -383,8 +380,6 @@ void VideoBuffers::DiscardFrame(VideoFrame *frame)
 
 frame_queue_t *VideoBuffers::queue(BufferType type)
 {
-    QMutexLocker locker(&global_lock);
-
     frame_queue_t *q = NULL;
 
     if (type == kVideoBuffer_avail)
@@ -407,8 +402,6 @@ frame_queue_t *VideoBuffers::queue(BufferType type)
 
 const frame_queue_t *VideoBuffers::queue(BufferType type) const
 {
-    QMutexLocker locker(&global_lock);
-
     const frame_queue_t *q = NULL;
 
     if (type == kVideoBuffer_avail)
@@ -438,7 +431,12 @@ VideoFrame *VideoBuffers::dequeue(BufferType type)
     if (!q)
         return NULL;
 
-    return q->dequeue();
+    VideoFrame *frame = q->dequeue();
+    int i = FrameIndex(frame);
+    if (i >= 0)
+        frame_state[i] &= ~type;
+
+    return frame;
 }
 
 VideoFrame *VideoBuffers::head(BufferType type)
@@ -480,12 +478,15 @@ void VideoBuffers::enqueue(BufferType type, VideoFrame *frame)
     if (!q)
         return;
 
-    global_lock.lock();
-    q->remove(frame);
-    q->enqueue(frame);
-    global_lock.unlock();
+    QMutexLocker locker(&global_lock);
 
-    return;
+    // Only search the queue when the frame is known to be in it
+    int i = FrameIndex(frame);
+    if (i < 0 || (frame_state[i] & type))
+        q->remove(frame);
+    q->enqueue(frame);
+    if (i >= 0)
+        frame_state[i] |= type;
 }
 
 void VideoBuffers::remove(BufferType type, VideoFrame *frame)
@@ -495,6 +496,14 @@ void VideoBuffers::remove(BufferType type, VideoFrame *frame)
 
     QMutexLocker locker(&global_lock);
 
+    // Restrict the search to the queues the frame is actually in
+    int i = FrameIndex(frame);
+    if (i >= 0)
+    {
+        type = (BufferType)(type & frame_state[i]);
+        frame_state[i] &= ~type;
+    }
+
     if ((type & kVideoBuffer_avail) == kVideoBuffer_avail)
         available.remove(frame);
     if ((type & kVideoBuffer_used) == kVideoBuffer_used)
@@ -574,6 +583,9 @@ bool VideoBuffers::contains(BufferType type, VideoFrame *frame) const
 {
     QMutexLocker locker(&global_lock);
 
+    if (FrameIndex(frame) >= 0)
+        return FrameState(frame) & type;
+
     const frame_queue_t *q = queue(type);
     if (q)
         return q->contains(frame);
@@ -581,6 +593,36 @@ bool VideoBuffers::contains(BufferType type, VideoFrame *frame) const
     return false;
 }
 
+/**
+ * \fn VideoBuffers::FrameIndex(const VideoFrame*) const
+ *  Returns the index of frame in buffers, or -1 if it is not one of ours.
+ *  This relies on the reservation made in Init() so that frame pointers
+ *  stay valid for the life of the buffers.
+ */
+int VideoBuffers::FrameIndex(const VideoFrame *frame) const
+{
+    if (!frame || buffers.empty())
+        return -1;
+
+    const VideoFrame *first = &buffers[0];
+    if (frame < first || frame >= first + frame_state.size())
+        return -1;
+
+    return frame - first;
+}
+
+/**
+ * \fn VideoBuffers::FrameState(const VideoFrame*) const
+ *  Returns the BufferType mask of the queues the frame is in. Every queue
+ *  change goes through enqueue(), dequeue() or remove() so membership tests
+ *  do not need to search the queues.
+ */
+uint VideoBuffers::FrameState(const VideoFrame *frame) const
+{
+    int i = FrameIndex(frame);
+    return (i >= 0) ? frame_state[i] : 0;
+}
+
 VideoFrame *VideoBuffers::GetScratchFrame(void)
 {
     if (!createdpauseframe || !head(kVideoBuffer_pause))
@@ -602,7 +644,7 @@ void VideoBuffers::SetLastShownFrameToScratch(void)
     }
 
     VideoFrame *pause = head(kVideoBuffer_pause);
-    rpos = vbufferMap[pause];
+    rpos = max(FrameIndex(pause), 0);
 }
 
 /**
@@ -646,9 +688,9 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
     {
         for (uint i=0; i < Size(); i++)
         {
-            if (!available.contains(at(i)) &&
-                !pause.contains(at(i)) &&
-                !displayed.contains(at(i)))
+            if (!(frame_state[i] & (kVideoBuffer_avail |
+                                    kVideoBuffer_pause |
+                                    kVideoBuffer_displayed)))
             {
                 LOG(VB_GENERAL, LOG_ERR,
                     QString("VideoBuffers::DiscardFrames(): ERROR, %1 (%2) not "
@@ -662,11 +704,11 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
 
     // Make sure frames used by decoder are last...
     // This is for libmpeg2 which still uses the frames after a reset.
-    for (it = decode.begin(); it != decode.end(); ++it)
-        remove(kVideoBuffer_all, *it);
-    for (it = decode.begin(); it != decode.end(); ++it)
-        available.enqueue(*it);
-    decode.clear();
+    frame_queue_t decoding(decode);
+    for (it = decoding.begin(); it != decoding.end(); ++it)
+        remove((BufferType)(kVideoBuffer_all | kVideoBuffer_decode), *it);
+    for (it = decoding.begin(); it != decoding.end(); ++it)
+        enqueue(kVideoBuffer_avail, *it);
 
     LOG(VB_PLAYBACK, LOG_INFO,
         QString("VideoBuffers::DiscardFrames(%1): %2 -- done")
@@ -683,15 +725,15 @@ void VideoBuffers::ClearAfterSeek(void)
 
         while (used.count() > 1)
         {
-            VideoFrame *buffer = used.dequeue();
-            available.enqueue(buffer);
+            VideoFrame *buffer = dequeue(kVideoBuffer_used);
+            enqueue(kVideoBuffer_avail, buffer);
         }
 
         if (used.count() > 0)
         {
-            VideoFrame *buffer = used.dequeue();
-            available.enqueue(buffer);
-            vpos = vbufferMap[buffer];
+            VideoFrame *buffer = dequeue(kVideoBuffer_used);
+            enqueue(kVideoBuffer_avail, buffer);
+            vpos = max(FrameIndex(buffer), 0);
             rpos = vpos;
         }
         else
@@ -769,10 +811,10 @@ uint VideoBuffers::AddBuffer(int width, int height, void* data,
 
     uint num = Size();
     buffers.resize(num + 1);
+    frame_state.resize(num + 1, 0);
     memset(&buffers[num], 0, sizeof(VideoFrame));
     buffers[num].interlaced_frame = -1;
     buffers[num].top_field_first  = 1;
-    vbufferMap[at(num)] = num;
     init(&buffers[num], fmt, (unsigned char*)data, width, height, 0);
     buffers[num].priv[0] = ffmpeg_hack;
     buffers[num].priv[1] = ffmpeg_hack;
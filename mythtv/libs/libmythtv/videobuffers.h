@@ -23,8 +23,6 @@ class MythXDisplay;
 typedef MythDeque<VideoFrame*>                frame_queue_t;
 typedef vector<VideoFrame>                    frame_vector_t;
 typedef map<const unsigned char*, void*>      buffer_map_t;
-typedef map<const VideoFrame*, uint>          vbuffer_map_t;
-typedef map<const VideoFrame*, QMutex*>       frame_lock_map_t;
 typedef vector<unsigned char*>                uchar_vector_t;
 
 
@@ -133,9 +131,11 @@ class VideoBuffers
     frame_queue_t         *queue(BufferType type);
     const frame_queue_t   *queue(BufferType type) const;
     VideoFrame            *GetNextFreeFrameInternal(BufferType enqueue_to);
+    int                    FrameIndex(const VideoFrame *frame) const;
+    uint                   FrameState(const VideoFrame *frame) const;
 
     frame_queue_t          available, used, limbo, pause, displayed, decode, finished;
-    vbuffer_map_t          vbufferMap; // videobuffers to buffer's index
+    vector<uint>           frame_state; // BufferType membership per buffer
     frame_vector_t         buffers;
     uchar_vector_t         allocated_arrays;  // for DeleteBuffers
 
@@ -1453,14 +1453,30 @@ void VideoOutputXv::PrepareFrameMem(VideoFrame *buffer, FrameScanType /*scan*/)
                   image_out.data, image_out.linesize);
     }
 
-    avpicture_fill(&image_in, (uint8_t *)XJ_non_xv_image->data,
-                   non_xv_av_format, out_width, out_height);
+    // The SSE2/MMX converters work in steps of 8 pixels, so only use
+    // them when a row is a whole number of steps with no padding.
+    static yuv2rgb_fun argb32_conv = yuv2rgb_init_mmx(32, MODE_RGB);
 
+    if (argb32_conv && (PIX_FMT_RGB32 == non_xv_av_format) &&
+        !(out_width & 0x7) &&
+        (XJ_non_xv_image->bytes_per_line == out_width * 4))
+    {
+        argb32_conv((uint8_t *)XJ_non_xv_image->data, image_out.data[0],
+                    image_out.data[1], image_out.data[2],
+                    out_width, out_height, XJ_non_xv_image->bytes_per_line,
+                    image_out.linesize[0], image_out.linesize[1], 1);
+    }
+    else
+    {
+        avpicture_fill(&image_in, (uint8_t *)XJ_non_xv_image->data,
+                       non_xv_av_format, out_width, out_height);
 
-    // XXX TODO: join with the scaling after removing img_convert, img_resample
-    myth_sws_img_convert(
-        &image_in, non_xv_av_format, &image_out, PIX_FMT_YUV420P,
-         out_width, out_height);
+        // XXX TODO: join with the scaling after removing img_convert,
+        //           img_resample
+        myth_sws_img_convert(
+            &image_in, non_xv_av_format, &image_out, PIX_FMT_YUV420P,
+             out_width, out_height);
+    }
 
     {
         QMutexLocker locker(&global_lock);
@@ -509,6 +509,13 @@ QString VideoOutput::GetFilters(void) const
     return QString::null;
 }
 
+uint VideoOutput::GetFilterThreads(void) const
+{
+    if (db_vdisp_profile)
+        return max(db_vdisp_profile->GetMaxCPUs(), 1U);
+    return 1;
+}
+
 bool VideoOutput::IsPreferredRenderer(QSize video_size)
 {
     if (!db_vdisp_profile || (video_size == window.GetVideoDispDim()))
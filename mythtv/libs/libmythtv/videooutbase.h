@@ -247,6 +247,7 @@ class VideoOutput
                                QString filename = "") { return false; }
 
     QString GetFilters(void) const;
+    uint    GetFilterThreads(void) const;
     /// \brief translates caption/dvd button rectangle into 'screen' space
     QRect   GetImageRect(const QRect &rect, QRect *display = NULL);
     QRect   GetSafeRect(void);
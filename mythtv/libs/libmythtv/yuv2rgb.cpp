@@ -39,10 +39,20 @@ extern "C" {
 #define CPU_MMX 1
 #endif
 
-#if HAVE_ALTIVEC
+#if HAVE_MMX && defined(__SSE2__)
+#define HAVE_SSE2_INTRINSICS 1
+#include <emmintrin.h>
+#else
+#define HAVE_SSE2_INTRINSICS 0
+#endif
+
+#if HAVE_ALTIVEC || HAVE_SSE2_INTRINSICS
 extern "C" {
 #include "libavutil/cpu.h"
 }
+#endif
+
+#if HAVE_ALTIVEC
 int has_altivec(void); 
 #if HAVE_ALTIVEC_H
 #include <altivec.h>
@@ -63,6 +73,17 @@ int has_altivec(void)
 }
 #endif
 
+#if HAVE_SSE2_INTRINSICS
+static int has_sse2(void)
+{
+    int cpu_flags = av_get_cpu_flags();
+    if (cpu_flags & AV_CPU_FLAG_SSE2)
+        return(1);
+
+    return(0);
+}
+#endif
+
 /** \file yuv2rgb.cpp
  *  \brief Contains various YUV, VUY and RGBA colorspace conversion routines.
  *
@@ -74,6 +95,13 @@ static void yuv420_argb32_non_mmx(unsigned char *image, unsigned char *py,
                            int y_stride, int uv_stride, int alphaones)
    MUNUSED; /* <- suppress compiler warning */
 
+#if HAVE_SSE2_INTRINSICS
+static void sse2_argb32(unsigned char *image, unsigned char *py,
+                        unsigned char *pu, unsigned char *pv,
+                        int h_size, int v_size, int rgb_stride,
+                        int y_stride, int uv_stride, int alphaones);
+#endif
+
 /* CPU_MMXEXT/CPU_MMX adaptation layer */
 
 #define movntq(src,dest)        \
@@ -354,7 +382,7 @@ static void mmx_argb32 (uint8_t * image,
 
 /** \fn yuv2rgb_init_mmxext(int bpp, int mode)
  *  \brief This returns a yuv to rgba converter, using
- *          mmxext if MMX was compiled in.
+ *          SSE2 or mmxext if MMX was compiled in.
  *
  *  \param mode must be MODE_RGB
  *  \param bpp must be 32
@@ -363,6 +391,10 @@ static void mmx_argb32 (uint8_t * image,
  */
 yuv2rgb_fun yuv2rgb_init_mmxext (int bpp, int mode)
 {
+#if HAVE_SSE2_INTRINSICS
+    if ((bpp == 32) && (mode == MODE_RGB) && has_sse2())
+        return sse2_argb32;
+#endif
 #if HAVE_MMX
     if ((bpp == 16) && (mode == MODE_RGB))
         return mmxext_rgb16;
@@ -378,7 +410,7 @@ yuv2rgb_fun yuv2rgb_init_mmxext (int bpp, int mode)
 
 /** \fn yuv2rgb_init_mmx (int bpp, int mode)
  *  \brief This returns a yuv to rgba converter, using
- *         mmx if MMX was compiled in.
+ *         SSE2 or mmx if MMX was compiled in.
  *
  *  \param mode must be MODE_RGB
  *  \param bpp must be 32
@@ -387,6 +419,10 @@ yuv2rgb_fun yuv2rgb_init_mmxext (int bpp, int mode)
  */
 yuv2rgb_fun yuv2rgb_init_mmx (int bpp, int mode)
 {
+#if HAVE_SSE2_INTRINSICS
+    if ((bpp == 32) && (mode == MODE_RGB) && has_sse2())
+        return sse2_argb32;
+#endif
 #if HAVE_MMX
     if ((bpp == 16) && (mode == MODE_RGB))
         return mmx_rgb16;
@@ -488,6 +524,100 @@ static void yuv420_argb32_non_mmx(unsigned char *image, unsigned char *py,
     }
 }
 
+#if HAVE_SSE2_INTRINSICS
+/** \brief SSE2 YUV420 to ARGB32 conversion.
+ *
+ *  Uses the same fixed point math as yuv420_argb32_non_mmx() so the
+ *  output is identical, but converts eight pixels at a time and honours
+ *  the strides. Any pixels past the last multiple of 8 are done in C.
+ */
+static void sse2_argb32(unsigned char *image, unsigned char *py,
+                        unsigned char *pu, unsigned char *pv,
+                        int h_size, int v_size, int rgb_stride,
+                        int y_stride, int uv_stride, int alphaones)
+{
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i c128   = _mm_set1_epi16(128);
+    const __m128i c16    = _mm_set1_epi16(16);
+    const __m128i half   = _mm_set1_epi32(1 << (SCALE_BITS - 1));
+    const __m128i coef_y = _mm_set1_epi32(C_Y);
+    // (cb, cr) pairs multiplied by (x, y) pairs with pmaddwd
+    const __m128i coef_r = _mm_set1_epi32(C_RV << 16);
+    const __m128i coef_g = _mm_set1_epi32(
+        (int)(((uint32_t)(-C_GV) << 16) | ((uint32_t)(-C_GU) & 0xffff)));
+    const __m128i coef_b = _mm_set1_epi32(C_BU);
+    const __m128i alpha  = _mm_set1_epi16(alphaones ? 0xff00 : 0);
+    int x, y, w8 = h_size & ~7;
+
+    for (y = 0; y < v_size; y++)
+    {
+        const unsigned char *yp = py + y * y_stride;
+        const unsigned char *up = pu + (y >> 1) * uv_stride;
+        const unsigned char *vp = pv + (y >> 1) * uv_stride;
+        unsigned char *d = image + y * rgb_stride;
+
+        for (x = 0; x < w8; x += 8)
+        {
+            __m128i cb = _mm_cvtsi32_si128(*(const int*)(up + (x >> 1)));
+            __m128i cr = _mm_cvtsi32_si128(*(const int*)(vp + (x >> 1)));
+            cb = _mm_sub_epi16(_mm_unpacklo_epi8(cb, zero), c128);
+            cr = _mm_sub_epi16(_mm_unpacklo_epi8(cr, zero), c128);
+            __m128i cbcr = _mm_unpacklo_epi16(cb, cr);
+
+            // one add term per chroma sample, 4 samples
+            __m128i r_add = _mm_add_epi32(_mm_madd_epi16(cbcr, coef_r), half);
+            __m128i g_add = _mm_add_epi32(_mm_madd_epi16(cbcr, coef_g), half);
+            __m128i b_add = _mm_add_epi32(_mm_madd_epi16(cbcr, coef_b), half);
+
+            __m128i yv = _mm_loadl_epi64((const __m128i*)(yp + x));
+            yv = _mm_sub_epi16(_mm_unpacklo_epi8(yv, zero), c16);
+            __m128i ylo = _mm_madd_epi16(_mm_unpacklo_epi16(yv, zero), coef_y);
+            __m128i yhi = _mm_madd_epi16(_mm_unpackhi_epi16(yv, zero), coef_y);
+
+#define SSE2_CHANNEL(add)                                                   \
+    _mm_packs_epi32(                                                        \
+        _mm_srai_epi32(_mm_add_epi32(ylo, _mm_shuffle_epi32(                \
+            add, _MM_SHUFFLE(1, 1, 0, 0))), SCALE_BITS),                    \
+        _mm_srai_epi32(_mm_add_epi32(yhi, _mm_shuffle_epi32(                \
+            add, _MM_SHUFFLE(3, 3, 2, 2))), SCALE_BITS))
+
+            __m128i r = SSE2_CHANNEL(r_add);
+            __m128i g = SSE2_CHANNEL(g_add);
+            __m128i b = SSE2_CHANNEL(b_add);
+#undef SSE2_CHANNEL
+
+            // clamp to 0..255, then build B,G,R,A bytes
+            r = _mm_packus_epi16(r, r);
+            g = _mm_packus_epi16(g, g);
+            b = _mm_packus_epi16(b, b);
+            __m128i bg = _mm_unpacklo_epi8(b, g);
+            __m128i ra = _mm_or_si128(_mm_unpacklo_epi8(r, zero), alpha);
+
+            _mm_storeu_si128((__m128i*)(d + 4 * x),
+                             _mm_unpacklo_epi16(bg, ra));
+            _mm_storeu_si128((__m128i*)(d + 4 * x + 16),
+                             _mm_unpackhi_epi16(bg, ra));
+        }
+
+        for (; x < h_size; x++)
+        {
+            int cb = up[x >> 1] - 128;
+            int cr = vp[x >> 1] - 128;
+            int r_add = C_RV * cr + (1 << (SCALE_BITS - 1));
+            int g_add = - C_GU * cb - C_GV * cr + (1 << (SCALE_BITS - 1));
+            int b_add = C_BU * cb + (1 << (SCALE_BITS - 1));
+            int yc = (yp[x] - 16) * C_Y;
+            unsigned char *p = d + 4 * x;
+
+            p[R_OI] = std::min(UCHAR_MAX, std::max(0, (yc + r_add) >> SCALE_BITS));
+            p[G_OI] = std::min(UCHAR_MAX, std::max(0, (yc + g_add) >> SCALE_BITS));
+            p[B_OI] = std::min(UCHAR_MAX, std::max(0, (yc + b_add) >> SCALE_BITS));
+            p[A_OI] = (alphaones) ? 0xff : 0;
+        }
+    }
+}
+#endif // HAVE_SSE2_INTRINSICS
+
 #define SCALEBITS 8
 #define ONE_HALF  (1 << (SCALEBITS - 1))
 #define FIX(x)          ((int) ((x) * (1L<<SCALEBITS) + 0.5))
@@ -495,6 +625,8 @@ static void yuv420_argb32_non_mmx(unsigned char *image, unsigned char *py,
 /**
  * \brief Convert planar RGB to YUV420.
  *        Despite the name, this actually converts to i420
+ *
+ *  There is no SIMD version of this routine.
  */
 void rgb32_to_yuv420p(unsigned char *lum, unsigned char *cb, unsigned char *cr,
                       unsigned char *alpha, unsigned char *src,
@@ -880,6 +1012,74 @@ static void mmx_i420_2vuy(
 
 #endif // HAVE_MMX
 
+#if HAVE_SSE2_INTRINSICS
+/** \brief SSE2 I420 to 2VUY conversion function.
+ *
+ *  See http://developer.apple.com/quicktime/icefloe/dispatch019.html
+ *  for a complete description of 2VUY and fourcc.org for YUV 4:2:0.
+ *
+ *  2vuy is a like a 8-bit per component YUV 4:2:2, but it's actually
+ *  a Y'Cb'Cr sampling.
+ *  2vuy is packed with bytes [Cb, Y, Cr, Y] representing two pixels.
+ *
+ *  Converts 32 pixels of two lines at a time using unaligned loads and
+ *  stores, so any stride works. Leftover pixels are done in C.
+ */
+static void sse2_i420_2vuy(
+    uint8_t *image, int vuy_stride,
+    const uint8_t *py, const uint8_t *pu, const uint8_t *pv,
+    int y_stride, int u_stride, int v_stride,
+    int h_size, int v_size)
+{
+    int x, y, w32 = h_size & ~31;
+
+    for (y = 0; y < (v_size>>1); y++)
+    {
+        uint8_t *pi1 = image + 2*y * vuy_stride;
+        uint8_t *pi2 = image + 2*y * vuy_stride + vuy_stride;
+        const uint8_t *py1 = py + 2*y * y_stride;
+        const uint8_t *py2 = py + 2*y * y_stride + y_stride;
+        const uint8_t *pu1 = pu + y * u_stride;
+        const uint8_t *pv1 = pv + y * v_stride;
+
+        for (x = 0; x < w32; x += 32)
+        {
+            __m128i u   = _mm_loadu_si128((const __m128i*)(pu1 + (x>>1)));
+            __m128i v   = _mm_loadu_si128((const __m128i*)(pv1 + (x>>1)));
+            __m128i uvl = _mm_unpacklo_epi8(u, v);
+            __m128i uvh = _mm_unpackhi_epi8(u, v);
+            __m128i y1a = _mm_loadu_si128((const __m128i*)(py1 + x));
+            __m128i y1b = _mm_loadu_si128((const __m128i*)(py1 + x + 16));
+            __m128i y2a = _mm_loadu_si128((const __m128i*)(py2 + x));
+            __m128i y2b = _mm_loadu_si128((const __m128i*)(py2 + x + 16));
+            __m128i *o1 = (__m128i*)(pi1 + 2*x);
+            __m128i *o2 = (__m128i*)(pi2 + 2*x);
+
+            _mm_storeu_si128(o1 + 0, _mm_unpacklo_epi8(uvl, y1a));
+            _mm_storeu_si128(o1 + 1, _mm_unpackhi_epi8(uvl, y1a));
+            _mm_storeu_si128(o1 + 2, _mm_unpacklo_epi8(uvh, y1b));
+            _mm_storeu_si128(o1 + 3, _mm_unpackhi_epi8(uvh, y1b));
+            _mm_storeu_si128(o2 + 0, _mm_unpacklo_epi8(uvl, y2a));
+            _mm_storeu_si128(o2 + 1, _mm_unpackhi_epi8(uvl, y2a));
+            _mm_storeu_si128(o2 + 2, _mm_unpacklo_epi8(uvh, y2b));
+            _mm_storeu_si128(o2 + 3, _mm_unpackhi_epi8(uvh, y2b));
+        }
+
+        for (x >>= 1; x < (h_size>>1); x++)
+        {
+            pi1[4*x+0] = pu1[1*x+0];
+            pi2[4*x+0] = pu1[1*x+0];
+            pi1[4*x+1] = py1[2*x+0];
+            pi2[4*x+1] = py2[2*x+0];
+            pi1[4*x+2] = pv1[1*x+0];
+            pi2[4*x+2] = pv1[1*x+0];
+            pi1[4*x+3] = py1[2*x+1];
+            pi2[4*x+3] = py2[2*x+1];
+        }
+    }
+}
+#endif // HAVE_SSE2_INTRINSICS
+
 #if HAVE_ALTIVEC
 
 // Altivec code adapted from VLC's i420_yuv2.c (thanks to Titer and Paul Jara)
@@ -1017,7 +1217,7 @@ static void altivec_i420_2vuy(
  *  2vuy is packed with bytes [Cb, Y, Cr, Y] representing two pixels.
  *
  *  \return A pointer to a I420 to 2VUY conversion function,
- *          which uses Altivec or MMX when supported.
+ *          which uses Altivec, SSE2 or MMX when supported.
  */
 conv_i420_2vuy_fun get_i420_2vuy_conv(void)
 {
@@ -1025,6 +1225,10 @@ conv_i420_2vuy_fun get_i420_2vuy_conv(void)
     if (has_altivec())
         return altivec_i420_2vuy;
 #endif
+#if HAVE_SSE2_INTRINSICS
+    if (has_sse2())
+        return sse2_i420_2vuy;
+#endif
 #if HAVE_MMX
         return mmx_i420_2vuy;
 #else
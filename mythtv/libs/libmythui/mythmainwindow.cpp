@@ -77,6 +77,7 @@ using namespace std;
 #include "mythpainter_qt.h"
 #include "mythgesture.h"
 #include "mythuihelper.h"
+#include "mythfontproperties.h"
 #include "mythdialogbox.h"
 
 #ifdef USING_MINGW
@@ -775,6 +776,34 @@ void MythMainWindow::drawScreen(void)
     d->repaintRegion = QRegion(QRect(0, 0, 0, 0));
 }
 
+/// Debug overlay with the image cache counters, drawn over the top left
+static void DrawCacheStats(MythPainter *painter, const QRect &screen,
+                           const QRect &clip)
+{
+    ImageCacheStats stats = GetMythUI()->GetImageCacheStats();
+    uint lookups = stats.hits + stats.misses;
+
+    QString msg = QString("Images: %1 (%2/%3 KB)  Hits: %4 (%5%)  "
+                          "Misses: %6  Evictions: %7")
+        .arg(stats.count).arg(stats.size >> 10).arg(stats.maxSize >> 10)
+        .arg(stats.hits).arg(lookups ? stats.hits * 100 / lookups : 0)
+        .arg(stats.misses).arg(stats.evictions);
+
+    QRect area(screen.x() + 4, screen.y() + 4, screen.width() - 8, 20);
+    if (!area.intersects(clip))
+        return;
+
+    static const QBrush background(QColor(0, 0, 0, 160));
+    painter->DrawRect(area, background, QPen(Qt::NoPen), 255);
+
+    MythFontProperties font;
+    font.SetFace(QFont("Droid Sans"));
+    font.SetColor(Qt::yellow);
+    font.SetPointSize(8);
+    painter->DrawText(area, msg, Qt::AlignLeft | Qt::AlignVCenter, font, 255,
+                      area);
+}
+
 void MythMainWindow::draw(void)
 {
     if (!d->painter)
@@ -805,6 +834,9 @@ void MythMainWindow::draw(void)
                 (*screenit)->Draw(d->painter, 0, 0, 255, rects[i]);
             }
         }
+
+        if (d->painter->ShowCacheStats())
+            DrawCacheStats(d->painter, d->uiScreenRect, rects[i]);
     }
 
     d->painter->End();
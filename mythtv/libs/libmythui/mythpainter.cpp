@@ -14,9 +14,17 @@
 // Own header
 #include "mythpainter.h"
 
+// Bytes of glyph images kept for SupportsGlyphCache() painters
+static const int64_t kMaxGlyphCacheSize = 4 * 1024 * 1024;
+// Number of laid out texts whose glyph runs are kept
+static const uint kMaxGlyphRuns = 256;
+// Horizontal positions per pixel that glyph images are rendered at
+static const int kGlyphSubpixels = 4;
+
 MythPainter::MythPainter()
   : m_Parent(0), m_HardwareCacheSize(0), m_SoftwareCacheSize(0),
-    m_showBorders(false), m_showNames(false)
+    m_glyphCacheSize(0),
+    m_showBorders(false), m_showNames(false), m_showCacheStats(false)
 {
     SetMaximumCacheSizes(96, 96);
 }
@@ -24,6 +32,7 @@ MythPainter::MythPainter()
 void MythPainter::Teardown(void)
 {
     ExpireImages(0);
+    ExpireGlyphs(0);
 
     QMutexLocker locker(&m_allocationLock);
 
@@ -70,6 +79,19 @@ void MythPainter::DrawImage(const QPoint &topLeft, MythImage *im, int alpha)
     DrawImage(topLeft.x(), topLeft.y(), im, alpha);
 }
 
+/**
+ *  \brief Draws several images, in order, with the same alpha.
+ *
+ *  Painters that can draw images sharing a texture in one go, such as
+ *  the glyphs of a string, should override this.
+ */
+void MythPainter::DrawImages(const ImageBatch &batch, int alpha)
+{
+    ImageBatch::const_iterator it = batch.begin();
+    for (; it != batch.end(); ++it)
+        DrawImage(it->m_dest, it->m_image, it->m_src, alpha);
+}
+
 void MythPainter::DrawText(const QRect &r, const QString &msg,
                            int flags, const MythFontProperties &font,
                            int alpha, const QRect &boundRect)
@@ -126,6 +148,13 @@ void MythPainter::DrawTextLayout(const QRect & canvasRect,
     if (canvasRect.isNull())
         return;
 
+    if (SupportsGlyphCache() &&
+        DrawTextLayoutGlyphs(canvasRect, layouts, formats, font, alpha,
+                             destRect))
+    {
+        return;
+    }
+
     QRect      canvas(canvasRect);
     QRect      dest(destRect);
 
@@ -444,6 +473,240 @@ MythImage *MythPainter::GetImageFromTextLayout(const LayoutVector &layouts,
     return im;
 }
 
+/**
+ *  \brief Draws text layouts one glyph at a time from cached glyph images.
+ *
+ *  Each glyph is rendered once per font and colour into a small image, so
+ *  text that changes every frame does not need a new image, and a painter
+ *  that packs small images into shared textures does not upload anything
+ *  for it.
+ *
+ *  \return false if the text needs the image based path, e.g. it has an
+ *          outline or a gradient, or Qt is older than 4.8.
+ */
+bool MythPainter::DrawTextLayoutGlyphs(const QRect &canvasRect,
+                                       const LayoutVector &layouts,
+                                       const FormatVector &formats,
+                                       const MythFontProperties &font,
+                                       int alpha, const QRect &destRect)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+    if (!formats.isEmpty() || font.GetBrush().style() != Qt::SolidPattern)
+        return false;
+
+    QList<QGlyphRun> runs = GetGlyphRuns(layouts, font);
+
+    // Only the part of the canvas that the image path would copy is drawn
+    QRect clip = QRect(QPoint(0, 0), canvasRect.size()) &
+                 QRect(QPoint(0, 0), destRect.size());
+    clip.translate(destRect.topLeft());
+    QPoint origin = destRect.topLeft() + canvasRect.topLeft();
+
+    if (font.hasShadow())
+    {
+        QPoint shadowOffset;
+        QColor shadowColor;
+        int    shadowAlpha;
+
+        font.GetShadow(shadowOffset, shadowColor, shadowAlpha);
+        shadowColor.setAlpha(shadowAlpha);
+
+        MythPoint  shadow(shadowOffset);
+        shadow.NormPoint(); // scale it to screen resolution
+
+        DrawGlyphRuns(runs, origin + shadow.toQPoint(), shadowColor,
+                      clip, alpha);
+    }
+
+    DrawGlyphRuns(runs, origin, font.GetBrush().color(), clip, alpha);
+
+    return true;
+#else
+    (void)canvasRect;
+    (void)layouts;
+    (void)formats;
+    (void)font;
+    (void)alpha;
+    (void)destRect;
+    return false;
+#endif
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+/**
+ *  \brief Returns the shaped glyph runs for the layouts, reusing them
+ *         while the same text is drawn with the same font and line breaks.
+ */
+QList<QGlyphRun> MythPainter::GetGlyphRuns(const LayoutVector &layouts,
+                                           const MythFontProperties &font)
+{
+    QString key = font.GetHash();
+
+    LayoutVector::const_iterator Ipara;
+    for (Ipara = layouts.begin(); Ipara != layouts.end(); ++Ipara)
+    {
+        for (int i = 0; i < (*Ipara)->lineCount(); ++i)
+        {
+            QTextLine line = (*Ipara)->lineAt(i);
+            key += QString("/%1,%2,%3,%4").arg(line.textStart())
+                .arg(line.textLength()).arg(line.x()).arg(line.y());
+        }
+        key += "/" + (*Ipara)->text();
+    }
+
+    QHash<QString, GlyphRunCacheEntry>::iterator it = m_glyphRunMap.find(key);
+    if (it != m_glyphRunMap.end())
+    {
+        m_glyphRunExpireList.splice(m_glyphRunExpireList.end(),
+                                    m_glyphRunExpireList, it->m_expire);
+        return it->m_runs;
+    }
+
+    GlyphRunCacheEntry entry;
+    for (Ipara = layouts.begin(); Ipara != layouts.end(); ++Ipara)
+        entry.m_runs += (*Ipara)->glyphRuns();
+    entry.m_expire = m_glyphRunExpireList.insert(m_glyphRunExpireList.end(),
+                                                 key);
+    m_glyphRunMap.insert(key, entry);
+
+    while ((uint)m_glyphRunMap.size() > kMaxGlyphRuns)
+    {
+        m_glyphRunMap.remove(m_glyphRunExpireList.front());
+        m_glyphRunExpireList.pop_front();
+    }
+
+    return entry.m_runs;
+}
+
+/**
+ *  \brief Returns the cached image of a glyph, rendering it if needed.
+ *
+ *  The glyph is rendered subpixel / kGlyphSubpixels of a pixel to the
+ *  right of its origin, so text keeps its fractional glyph positions.
+ *  The image offset is the position of its top left corner relative to
+ *  the glyph origin. The cache keeps the reference, so call IncrRef() to
+ *  hold the image past the next call.
+ */
+MythImage *MythPainter::GetGlyphImage(const QRawFont &rawFont,
+                                      const QString &prefix,
+                                      quint32 glyph, int subpixel,
+                                      const QColor &color)
+{
+    QString key = prefix + QString("%1.%2").arg(glyph).arg(subpixel);
+
+    QHash<QString, GlyphCacheEntry>::iterator it = m_glyphImageMap.find(key);
+    if (it != m_glyphImageMap.end())
+    {
+        m_glyphExpireList.splice(m_glyphExpireList.end(),
+                                 m_glyphExpireList, it->m_expire);
+        return it->m_image;
+    }
+
+    if (m_glyphCacheSize >= kMaxGlyphCacheSize)
+        ExpireGlyphs(kMaxGlyphCacheSize);
+
+    GlyphCacheEntry entry;
+    entry.m_image = NULL;
+
+    // Leave a pixel around the outline for antialiasing, and one more on
+    // the right for the subpixel shift
+    QRect bounds = rawFont.pathForGlyph(glyph).boundingRect()
+                                              .toAlignedRect();
+    if (!bounds.isEmpty())
+    {
+        bounds.adjust(-1, -1, 2, 1);
+
+        QImage pm(bounds.size(), QImage::Format_ARGB32);
+        QColor fillcolor = color;
+        fillcolor.setAlpha(0);
+        pm.fill(fillcolor.rgba());
+
+        QGlyphRun run;
+        run.setRawFont(rawFont);
+        run.setGlyphIndexes(QVector<quint32>() << glyph);
+        run.setPositions(QVector<QPointF>()
+                         << QPointF(-bounds.left() +
+                                    (qreal)subpixel / kGlyphSubpixels,
+                                    -bounds.top()));
+
+        QPainter painter(&pm);
+        painter.setPen(color);
+        painter.drawGlyphRun(QPointF(0, 0), run);
+        painter.end();
+        pm.setOffset(bounds.topLeft());
+
+        entry.m_image = GetFormatImage();
+        entry.m_image->SetFileName("GetGlyphImage");
+        entry.m_image->Assign(pm);
+        m_glyphCacheSize += pm.bytesPerLine() * pm.height();
+    }
+
+    entry.m_expire = m_glyphExpireList.insert(m_glyphExpireList.end(), key);
+    m_glyphImageMap.insert(key, entry);
+
+    return entry.m_image;
+}
+
+/**
+ *  \brief Draws the glyphs of the runs in one batch, so painters that
+ *         hold glyph images in a shared texture can use one draw call.
+ */
+void MythPainter::DrawGlyphRuns(const QList<QGlyphRun> &runs,
+                                const QPoint &origin, const QColor &color,
+                                const QRect &clip, int alpha)
+{
+    ImageBatch batch;
+
+    QList<QGlyphRun>::const_iterator it = runs.begin();
+    for (; it != runs.end(); ++it)
+    {
+        QRawFont rawFont = (*it).rawFont();
+        QString prefix = QString("%1/%2/%3/%4/").arg(rawFont.familyName())
+            .arg(rawFont.styleName()).arg(rawFont.pixelSize())
+            .arg(color.rgba());
+
+        QVector<quint32> glyphs    = (*it).glyphIndexes();
+        QVector<QPointF> positions = (*it).positions();
+
+        for (int i = 0; i < glyphs.size() && i < positions.size(); ++i)
+        {
+            // Split x into whole pixels and the nearest subpixel step
+            int x = qRound(positions[i].x() * kGlyphSubpixels);
+            int subpixel = x & (kGlyphSubpixels - 1);
+            QPoint pos((x - subpixel) / kGlyphSubpixels,
+                       qRound(positions[i].y()));
+
+            MythImage *im = GetGlyphImage(rawFont, prefix, glyphs[i],
+                                          subpixel, color);
+            if (!im)
+                continue;
+
+            QRect area(origin + pos + im->offset(), im->size());
+            QRect visible = area & clip;
+            if (visible.isEmpty())
+                continue;
+
+            // Expiring the glyph cache must not free images still to be
+            // drawn
+            im->IncrRef();
+
+            ImageBatchItem item;
+            item.m_image = im;
+            item.m_dest  = visible;
+            item.m_src   = QRect(visible.topLeft() - area.topLeft(),
+                                 visible.size());
+            batch.push_back(item);
+        }
+    }
+
+    DrawImages(batch, alpha);
+
+    ImageBatch::iterator bit = batch.begin();
+    for (; bit != batch.end(); ++bit)
+        bit->m_image->DecrRef();
+}
+#endif
+
 MythImage* MythPainter::GetImageFromRect(const QRect &area, int radius,
                                          int ellipse,
                                          const QBrush &fillBrush,
@@ -576,6 +839,43 @@ void MythPainter::ExpireImages(int64_t max)
     }
 }
 
+void MythPainter::ExpireGlyphs(int64_t max)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+    while (!m_glyphExpireList.empty())
+    {
+        if (max && m_glyphCacheSize < max)
+            break;
+
+        QHash<QString, GlyphCacheEntry>::iterator it =
+            m_glyphImageMap.find(m_glyphExpireList.front());
+        m_glyphExpireList.pop_front();
+        if (it == m_glyphImageMap.end())
+            continue;
+
+        MythImage *oldim = it->m_image;
+        m_glyphImageMap.erase(it);
+
+        if (oldim)
+        {
+            m_glyphCacheSize -= oldim->bytesPerLine() * oldim->height();
+            oldim->DecrRef();
+        }
+    }
+
+    if (m_glyphImageMap.isEmpty())
+        m_glyphCacheSize = 0;
+
+    if (!max)
+    {
+        m_glyphRunMap.clear();
+        m_glyphRunExpireList.clear();
+    }
+#else
+    (void)max;
+#endif
+}
+
 // the following assume graphics hardware operates natively at 32bpp
 void MythPainter::SetMaximumCacheSizes(int hardware, int software)
 {
@@ -2,12 +2,20 @@
 #define MYTHPAINTER_H_
 
 #include <QMap>
+#include <QHash>
 #include <QString>
 #include <QTextLayout>
 #include <QWidget>
 #include <QPaintDevice>
 #include <QMutex>
 #include <QSet>
+#include <QRect>
+#include <QVector>
+
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+#include <QGlyphRun>
+#include <QRawFont>
+#endif
 
 class QRect;
 class QRegion;
@@ -43,6 +51,9 @@ class MUI_PUBLIC MythPainter
     virtual bool SupportsAnimation(void) = 0;
     virtual bool SupportsAlpha(void) = 0;
     virtual bool SupportsClipping(void) = 0;
+    /// Returns true if text layouts should be drawn from cached glyph
+    /// images rather than rendered to a new image for every string.
+    virtual bool SupportsGlyphCache(void) { return false; }
     virtual void FreeResources(void) { }
     virtual void Begin(QPaintDevice *parent) { m_Parent = parent; }
     virtual void End() { m_Parent = NULL; }
@@ -59,6 +70,18 @@ class MUI_PUBLIC MythPainter
     void DrawImage(int x, int y, MythImage *im, int alpha);
     void DrawImage(const QPoint &topLeft, MythImage *im, int alph);
 
+    /// One image of a batch drawn with DrawImages()
+    class ImageBatchItem
+    {
+      public:
+        MythImage *m_image;
+        QRect      m_dest;
+        QRect      m_src;
+    };
+    typedef QVector<ImageBatchItem> ImageBatch;
+
+    virtual void DrawImages(const ImageBatch &batch, int alpha);
+
     virtual void DrawText(const QRect &dest, const QString &msg, int flags,
                           const MythFontProperties &font, int alpha,
                           const QRect &boundRect);
@@ -93,6 +116,9 @@ class MUI_PUBLIC MythPainter
     bool ShowBorders(void) { return m_showBorders; }
     bool ShowTypeNames(void) { return m_showNames; }
 
+    void SetShowCacheStats(bool show) { m_showCacheStats = show; }
+    bool ShowCacheStats(void) { return m_showCacheStats; }
+
     void SetMaximumCacheSizes(int hardware, int software);
 
   protected:
@@ -111,10 +137,17 @@ class MUI_PUBLIC MythPainter
                                 const QBrush &fillBrush,
                                 const QPen &linePen);
 
+    bool DrawTextLayoutGlyphs(const QRect &canvasRect,
+                              const LayoutVector &layouts,
+                              const FormatVector &formats,
+                              const MythFontProperties &font, int alpha,
+                              const QRect &destRect);
+
     /// Creates a reference counted image, call DecrRef() to delete.
     virtual MythImage* GetFormatImagePriv(void) = 0;
     virtual void DeleteFormatImagePriv(MythImage *im) = 0;
     void ExpireImages(int64_t max = 0);
+    void ExpireGlyphs(int64_t max = 0);
 
     // This needs to be called by classes inheriting from MythPainter
     // in the destructor.
@@ -136,8 +169,39 @@ class MUI_PUBLIC MythPainter
     QMap<QString, MythImage *> m_StringToImageMap;
     std::list<QString>         m_StringExpireList;
 
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+    QList<QGlyphRun> GetGlyphRuns(const LayoutVector &layouts,
+                                  const MythFontProperties &font);
+    MythImage *GetGlyphImage(const QRawFont &rawFont, const QString &prefix,
+                             quint32 glyph, int subpixel,
+                             const QColor &color);
+    void DrawGlyphRuns(const QList<QGlyphRun> &runs, const QPoint &origin,
+                       const QColor &color, const QRect &clip, int alpha);
+
+    class GlyphRunCacheEntry
+    {
+      public:
+        QList<QGlyphRun>             m_runs;
+        std::list<QString>::iterator m_expire;
+    };
+
+    class GlyphCacheEntry
+    {
+      public:
+        MythImage                   *m_image; ///< NULL for blank glyphs
+        std::list<QString>::iterator m_expire;
+    };
+
+    QHash<QString, GlyphRunCacheEntry> m_glyphRunMap;
+    std::list<QString>                 m_glyphRunExpireList;
+    QHash<QString, GlyphCacheEntry>    m_glyphImageMap;
+    std::list<QString>                 m_glyphExpireList;
+#endif
+    int64_t m_glyphCacheSize;
+
     bool m_showBorders;
     bool m_showNames;
+    bool m_showCacheStats;
 };
 
 #endif
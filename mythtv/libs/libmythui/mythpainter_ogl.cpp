@@ -17,10 +17,49 @@
 
 using namespace std;
 
+// Images no larger than this in either dimension share atlas textures
+static const int kAtlasMaxImage = 128;
+static const int kAtlasSize     = 1024;
+static const int kAtlasMaxPages = 4;
+// Interval between painter statistics reports, in ms
+static const int kStatsInterval = 5000;
+
+/**
+ * Find room for an image on this page, opening a new shelf if none of the
+ * existing ones fit it without wasting too much of their height.
+ */
+bool MythOpenGLPainter::AtlasPage::Allocate(const QSize &size, QPoint &pos)
+{
+    for (int i = 0; i < m_shelves.size(); ++i)
+    {
+        QRect &shelf = m_shelves[i];
+        if (shelf.height() >= size.height() &&
+            shelf.height() <= size.height() + (size.height() >> 1) + 2 &&
+            kAtlasSize - shelf.width() >= size.width())
+        {
+            pos = QPoint(shelf.width(), shelf.top());
+            shelf.setWidth(shelf.width() + size.width());
+            m_count++;
+            return true;
+        }
+    }
+
+    if (kAtlasSize - m_top < size.height())
+        return false;
+
+    pos = QPoint(0, m_top);
+    m_shelves.push_back(QRect(0, m_top, size.width(), size.height()));
+    m_top += size.height();
+    m_count++;
+    return true;
+}
+
 MythOpenGLPainter::MythOpenGLPainter(MythRenderOpenGL *render,
                                      QGLWidget *parent) :
     MythPainter(), realParent(parent), realRender(render),
-    target(0), swapControl(true)
+    target(0), swapControl(true),
+    m_frames(0), m_frameTime(0), m_drawCalls(0), m_atlasDraws(0),
+    m_uploads(0)
 {
     if (realRender)
         LOG(VB_GENERAL, LOG_INFO,
@@ -62,14 +101,32 @@ void MythOpenGLPainter::ClearCache(void)
     LOG(VB_GENERAL, LOG_INFO, "Clearing OpenGL painter cache.");
 
     QMutexLocker locker(&m_textureDeleteLock);
-    QMapIterator<MythImage *, unsigned int> it(m_ImageIntMap);
-    while (it.hasNext())
+    QHash<MythImage *, TextureCacheEntry>::const_iterator it;
+    for (it = m_ImageTextureMap.begin(); it != m_ImageTextureMap.end(); ++it)
+        ReleaseEntry(*it);
+    m_ImageTextureMap.clear();
+    m_ImageExpireList.clear();
+}
+
+/**
+ * Queue an entry's texture for deletion, or give its space in an atlas
+ * page back; a page is only deleted once all its images are gone.
+ * m_textureDeleteLock must be held.
+ */
+void MythOpenGLPainter::ReleaseEntry(const TextureCacheEntry &entry)
+{
+    if (!entry.m_page)
     {
-        it.next();
-        m_textureDeleteList.push_back(m_ImageIntMap[it.key()]);
-        m_ImageExpireList.remove(it.key());
+        m_textureDeleteList.push_back(entry.m_texture);
+        return;
     }
-    m_ImageIntMap.clear();
+
+    if (--entry.m_page->m_count > 0)
+        return;
+
+    m_textureDeleteList.push_back(entry.m_page->m_texture);
+    m_atlasPages.removeAll(entry.m_page);
+    delete entry.m_page;
 }
 
 void MythOpenGLPainter::Begin(QPaintDevice *parent)
@@ -108,6 +165,8 @@ void MythOpenGLPainter::Begin(QPaintDevice *parent)
         realRender->SetBackground(0, 0, 0, 0);
         realRender->ClearFramebuffer();
     }
+
+    m_frameTimer.start();
 }
 
 void MythOpenGLPainter::End(void)
@@ -126,20 +185,112 @@ void MythOpenGLPainter::End(void)
     }
 
     MythPainter::End();
+
+    m_frames++;
+    m_frameTime += m_frameTimer.elapsed();
+    if (!m_statsTimer.isValid())
+        m_statsTimer.start();
+    else if (m_statsTimer.elapsed() >= kStatsInterval)
+        ReportStats();
 }
 
-int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
+/**
+ * Log frame time, draw calls and texture uploads averaged over the
+ * frames painted since the last report.
+ */
+void MythOpenGLPainter::ReportStats(void)
+{
+    if (m_frames)
+    {
+        LOG(VB_GUI, LOG_DEBUG, QString("OpenGL painter: %1 fps, %2 ms/frame, "
+                "%3 draws/frame (%4 from atlas), %5 uploads, "
+                "%6 textures (%7 atlas pages), %8 KB")
+            .arg(m_frames * 1000.0 / m_statsTimer.elapsed(), 0, 'f', 1)
+            .arg((float)m_frameTime / m_frames, 0, 'f', 1)
+            .arg(m_drawCalls / m_frames).arg(m_atlasDraws / m_frames)
+            .arg(m_uploads).arg(m_ImageTextureMap.size())
+            .arg(m_atlasPages.size()).arg(m_HardwareCacheSize >> 10));
+    }
+
+    m_frames = m_frameTime = m_drawCalls = m_atlasDraws = m_uploads = 0;
+    m_statsTimer.restart();
+}
+
+/**
+ * Copy a small image into an atlas page, opening a new page if needed.
+ *
+ * The image is surrounded by a copy of its own edge pixels so filtering
+ * never picks up its neighbours on the page.
+ */
+bool MythOpenGLPainter::AddToAtlas(MythImage *im, TextureCacheEntry &entry)
+{
+    int w = im->width();
+    int h = im->height();
+    QSize padded_size(w + 2, h + 2);
+
+    QPoint pos;
+    AtlasPage *page = NULL;
+    QList<AtlasPage *>::iterator it = m_atlasPages.begin();
+    for (; it != m_atlasPages.end() && !page; ++it)
+        if ((*it)->Allocate(padded_size, pos))
+            page = *it;
+
+    if (!page)
+    {
+        if (m_atlasPages.size() >= kAtlasMaxPages)
+            return false;
+
+        GLuint tx_id =
+            realRender->CreateTexture(QSize(kAtlasSize, kAtlasSize), false,
+                                      GL_TEXTURE_2D, GL_UNSIGNED_BYTE,
+                                      GL_RGBA, GL_RGBA8, GL_LINEAR);
+        if (!tx_id)
+            return false;
+
+        m_HardwareCacheSize += realRender->GetTextureDataSize(tx_id);
+        page = new AtlasPage(tx_id);
+        m_atlasPages.push_back(page);
+        page->Allocate(padded_size, pos);
+    }
+
+    QImage padded(padded_size, QImage::Format_ARGB32);
+    {
+        QPainter p(&padded);
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        p.drawImage(1, 1, *im);
+        p.drawImage(QRect(0, 1, 1, h), *im, QRect(0, 0, 1, h));
+        p.drawImage(QRect(w + 1, 1, 1, h), *im, QRect(w - 1, 0, 1, h));
+        QImage top = padded.copy(0, 1, w + 2, 1);
+        QImage bottom = padded.copy(0, h, w + 2, 1);
+        p.drawImage(0, 0, top);
+        p.drawImage(0, h + 1, bottom);
+    }
+
+    QImage tx = QGLWidget::convertToGLFormat(padded);
+    realRender->UpdateTextureRegion(page->m_texture, QRect(pos, padded_size),
+                                    tx.bits());
+
+    entry.m_texture = page->m_texture;
+    entry.m_page    = page;
+    entry.m_offset  = pos + QPoint(1, 1);
+    return true;
+}
+
+int MythOpenGLPainter::GetTextureFromCache(MythImage *im, QPoint &offset)
 {
     if (!realRender)
         return 0;
 
-    if (m_ImageIntMap.contains(im))
+    QHash<MythImage *, TextureCacheEntry>::iterator it =
+        m_ImageTextureMap.find(im);
+    if (it != m_ImageTextureMap.end())
     {
         if (!im->IsChanged())
         {
-            m_ImageExpireList.remove(im);
-            m_ImageExpireList.push_back(im);
-            return m_ImageIntMap[im];
+            m_ImageExpireList.splice(m_ImageExpireList.end(),
+                                     m_ImageExpireList, it->m_expire);
+            offset = it->m_offset;
+            return it->m_texture;
         }
         else
         {
@@ -148,44 +299,129 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
     }
 
     im->SetChanged(false);
+    CheckFormatImage(im);
+    m_uploads++;
 
-    QImage tx = QGLWidget::convertToGLFormat(*im);
-    GLuint tx_id =
-        realRender->CreateTexture(tx.size(), false, 0,
-                                  GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8,
-                                  GL_LINEAR_MIPMAP_LINEAR);
+    TextureCacheEntry entry;
 
-    if (!tx_id)
+    if (im->width() > kAtlasMaxImage || im->height() > kAtlasMaxImage ||
+        im->isNull() || !AddToAtlas(im, entry))
     {
-        LOG(VB_GENERAL, LOG_ERR, "Failed to create OpenGL texture.");
-        return tx_id;
-    }
+        QImage tx = QGLWidget::convertToGLFormat(*im);
+        GLuint tx_id =
+            realRender->CreateTexture(tx.size(), false, 0,
+                                      GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8,
+                                      GL_LINEAR_MIPMAP_LINEAR);
 
-    CheckFormatImage(im);
-    m_HardwareCacheSize += realRender->GetTextureDataSize(tx_id);
-    realRender->GetTextureBuffer(tx_id, false);
-    realRender->UpdateTexture(tx_id, tx.bits());
+        if (!tx_id)
+        {
+            LOG(VB_GENERAL, LOG_ERR, "Failed to create OpenGL texture.");
+            return tx_id;
+        }
+
+        m_HardwareCacheSize += realRender->GetTextureDataSize(tx_id);
+        realRender->GetTextureBuffer(tx_id, false);
+        realRender->UpdateTexture(tx_id, tx.bits());
+        entry.m_texture = tx_id;
+    }
 
-    m_ImageIntMap[im] = tx_id;
-    m_ImageExpireList.push_back(im);
+    entry.m_expire = m_ImageExpireList.insert(m_ImageExpireList.end(), im);
+    m_ImageTextureMap.insert(im, entry);
+    offset = entry.m_offset;
 
-    while (m_HardwareCacheSize > m_MaxHardwareCacheSize)
+    // Expiring an image packed in an atlas frees nothing until its whole
+    // page is empty and only means uploading it again later, so just drop
+    // standalone textures. The atlas is already limited to kAtlasMaxPages.
+    std::list<MythImage *>::iterator exp = m_ImageExpireList.begin();
+    while (m_HardwareCacheSize > m_MaxHardwareCacheSize &&
+           exp != m_ImageExpireList.end())
     {
-        MythImage *expiredIm = m_ImageExpireList.front();
-        m_ImageExpireList.pop_front();
+        MythImage *expiredIm = *exp++;
+        if (expiredIm == im || m_ImageTextureMap.value(expiredIm).m_page)
+            continue;
+
         DeleteFormatImagePriv(expiredIm);
         DeleteTextures();
     }
 
-    return tx_id;
+    return entry.m_texture;
 }
 
 void MythOpenGLPainter::DrawImage(const QRect &r, MythImage *im,
                                   const QRect &src, int alpha)
 {
-    if (realRender)
-        realRender->DrawBitmap(GetTextureFromCache(im), target,
-                               &src, &r, 0, alpha);
+    if (!realRender)
+        return;
+
+    QPoint offset;
+    uint tex = GetTextureFromCache(im, offset);
+
+    if (offset.isNull())
+    {
+        realRender->DrawBitmap(tex, target, &src, &r, 0, alpha);
+    }
+    else
+    {
+        // Don't let an oversized source rect reach the neighbouring images
+        QRect area = src.intersected(im->rect());
+        if (area.isEmpty())
+            return;
+
+        area.translate(offset);
+        realRender->DrawBitmap(tex, target, &area, &r, 0, alpha);
+        m_atlasDraws++;
+    }
+    m_drawCalls++;
+}
+
+/**
+ * Draw the images packed in each atlas page with one call per page,
+ * anything with its own texture is drawn straight away.
+ */
+void MythOpenGLPainter::DrawImages(const ImageBatch &batch, int alpha)
+{
+    if (!realRender)
+        return;
+
+    QList<uint> pages;
+    QHash<uint, QVector<QRect> > srcs;
+    QHash<uint, QVector<QRect> > dests;
+
+    ImageBatch::const_iterator it = batch.begin();
+    for (; it != batch.end(); ++it)
+    {
+        QPoint offset;
+        uint tex = GetTextureFromCache(it->m_image, offset);
+        if (!tex)
+            continue;
+
+        if (offset.isNull())
+        {
+            realRender->DrawBitmap(tex, target, &it->m_src, &it->m_dest,
+                                   0, alpha);
+            m_drawCalls++;
+            continue;
+        }
+
+        // Don't let an oversized source rect reach the neighbouring images
+        QRect area = it->m_src.intersected(it->m_image->rect());
+        if (area.isEmpty())
+            continue;
+
+        if (!srcs.contains(tex))
+            pages.push_back(tex);
+        srcs[tex].push_back(area.translated(offset));
+        dests[tex].push_back(it->m_dest);
+        m_atlasDraws++;
+    }
+
+    QList<uint>::const_iterator pit = pages.begin();
+    for (; pit != pages.end(); ++pit)
+    {
+        realRender->DrawBitmaps(*pit, target, srcs[*pit], dests[*pit],
+                                0, alpha);
+        m_drawCalls++;
+    }
 }
 
 void MythOpenGLPainter::DrawRect(const QRect &area, const QBrush &fillBrush,
@@ -195,6 +431,7 @@ void MythOpenGLPainter::DrawRect(const QRect &area, const QBrush &fillBrush,
          fillBrush.style() == Qt::NoBrush) && realRender)
     {
         realRender->DrawRect(area, fillBrush, linePen, alpha);
+        m_drawCalls++;
         return;
     }
     MythPainter::DrawRect(area, fillBrush, linePen, alpha);
@@ -211,6 +448,7 @@ void MythOpenGLPainter::DrawRoundRect(const QRect &area, int cornerRadius,
         {
             realRender->DrawRoundRect(area, cornerRadius, fillBrush,
                                       linePen, alpha);
+            m_drawCalls++;
             return;
         }
     }
@@ -219,12 +457,14 @@ void MythOpenGLPainter::DrawRoundRect(const QRect &area, int cornerRadius,
 
 void MythOpenGLPainter::DeleteFormatImagePriv(MythImage *im)
 {
-    if (m_ImageIntMap.contains(im))
+    QMutexLocker locker(&m_textureDeleteLock);
+    QHash<MythImage *, TextureCacheEntry>::iterator it =
+        m_ImageTextureMap.find(im);
+    if (it != m_ImageTextureMap.end())
     {
-        QMutexLocker locker(&m_textureDeleteLock);
-        m_textureDeleteList.push_back(m_ImageIntMap[im]);
-        m_ImageIntMap.remove(im);
-        m_ImageExpireList.remove(im);
+        ReleaseEntry(*it);
+        m_ImageExpireList.erase(it->m_expire);
+        m_ImageTextureMap.erase(it);
     }
 }
 
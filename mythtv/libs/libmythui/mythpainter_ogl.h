@@ -3,6 +3,9 @@
 
 #include <QMutex>
 #include <QGLWidget>
+#include <QHash>
+#include <QTime>
+#include <QVector>
 
 #include <list>
 
@@ -22,12 +25,14 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     virtual bool SupportsAnimation(void) { return true;              }
     virtual bool SupportsAlpha(void)     { return true;              }
     virtual bool SupportsClipping(void)  { return false;             }
+    virtual bool SupportsGlyphCache(void) { return true;            }
     virtual void FreeResources(void);
     virtual void Begin(QPaintDevice *parent);
     virtual void End();
 
     virtual void DrawImage(const QRect &dest, MythImage *im, const QRect &src,
                            int alpha);
+    virtual void DrawImages(const ImageBatch &batch, int alpha);
     virtual void DrawRect(const QRect &area, const QBrush &fillBrush,
                           const QPen &linePen, int alpha);
     virtual void DrawRoundRect(const QRect &area, int cornerRadius,
@@ -38,22 +43,61 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     virtual void PopTransformation(void);
 
   protected:
+    /// A shared texture that small images are packed into, in shelves
+    class AtlasPage
+    {
+      public:
+        AtlasPage(uint texture) : m_texture(texture), m_top(0), m_count(0) { }
+
+        bool Allocate(const QSize &size, QPoint &pos);
+
+        uint           m_texture;
+        int            m_top;     ///< first row not used by any shelf
+        int            m_count;   ///< images currently held
+        QVector<QRect> m_shelves; ///< full shelf height, width used so far
+    };
+
+    /// Where a cached image is held on the GPU
+    class TextureCacheEntry
+    {
+      public:
+        TextureCacheEntry() : m_texture(0), m_page(NULL) { }
+
+        uint       m_texture; ///< own texture, or the atlas page's
+        AtlasPage *m_page;    ///< NULL unless packed into an atlas page
+        QPoint     m_offset;  ///< position of the image in the texture
+        std::list<MythImage *>::iterator m_expire;
+    };
+
     virtual MythImage* GetFormatImagePriv(void) { return new MythImage(this); }
     virtual void DeleteFormatImagePriv(MythImage *im);
 
     void       ClearCache(void);
     void       DeleteTextures(void);
-    int        GetTextureFromCache(MythImage *im);
+    int        GetTextureFromCache(MythImage *im, QPoint &offset);
+    bool       AddToAtlas(MythImage *im, TextureCacheEntry &entry);
+    void       ReleaseEntry(const TextureCacheEntry &entry);
+    void       ReportStats(void);
 
     QGLWidget        *realParent;
     MythRenderOpenGL *realRender;
     int               target;
     bool              swapControl;
 
-    QMap<MythImage *, uint>    m_ImageIntMap;
+    QHash<MythImage *, TextureCacheEntry> m_ImageTextureMap;
     std::list<MythImage *>     m_ImageExpireList;
     std::list<uint>            m_textureDeleteList;
     QMutex                     m_textureDeleteLock;
+    QList<AtlasPage *>         m_atlasPages;
+
+    // Per frame statistics, reported periodically
+    QTime m_frameTimer;
+    QTime m_statsTimer;
+    int   m_frames;
+    int   m_frameTime;
+    int   m_drawCalls;
+    int   m_atlasDraws;
+    int   m_uploads;
 };
 
 #endif
@@ -14,6 +14,7 @@ class MUI_PUBLIC MythYUVAPainter : public MythQImagePainter
    ~MythYUVAPainter();
 
     QString GetName(void) { return QString("YUVA"); }
+    bool SupportsGlyphCache(void) { return true; }
 
     virtual void DrawImage(const QRect &dest, MythImage *im, const QRect &src,
                            int alpha);
@@ -325,6 +325,25 @@ void MythRenderOpenGL::UpdateTexture(uint tex, void *buf)
     doneCurrent();
 }
 
+/**
+ * Replace part of a texture, without going through its PBO or scratch
+ * buffer. buf holds area's pixels in the texture's own data format.
+ */
+void MythRenderOpenGL::UpdateTextureRegion(uint tex, const QRect &area,
+                                           void *buf)
+{
+    if (!m_textures.contains(tex))
+        return;
+
+    makeCurrent();
+    EnableTextures(tex);
+    glBindTexture(m_textures[tex].m_type, tex);
+    glTexSubImage2D(m_textures[tex].m_type, 0, area.left(), area.top(),
+                    area.width(), area.height(), m_textures[tex].m_data_fmt,
+                    m_textures[tex].m_data_type, buf);
+    doneCurrent();
+}
+
 int MythRenderOpenGL::GetTextureType(bool &rect)
 {
     static bool rects = true;
@@ -711,6 +730,28 @@ void MythRenderOpenGL::DrawBitmap(uint *textures, uint texture_count,
     doneCurrent();
 }
 
+/**
+ * Draw several areas of one texture with a single draw call, e.g. the
+ * glyphs of a string held in an atlas texture. src and dst are paired.
+ */
+void MythRenderOpenGL::DrawBitmaps(uint tex, uint target,
+                                   const QVector<QRect> &src,
+                                   const QVector<QRect> &dst, uint prog,
+                                   int alpha, int red, int green, int blue)
+{
+    if (!tex || !m_textures.contains(tex) || src.isEmpty() ||
+        src.size() != dst.size())
+        return;
+
+    if (target && !m_framebuffers.contains(target))
+        target = 0;
+
+    makeCurrent();
+    BindFramebuffer(target);
+    DrawBitmapsPriv(tex, src, dst, prog, alpha, red, green, blue);
+    doneCurrent();
+}
+
 void MythRenderOpenGL::DrawRect(const QRect &area, const QBrush &fillBrush,
                                 const QPen &linePen, int alpha)
 {
@@ -1134,6 +1175,70 @@ bool MythRenderOpenGL::UpdateTextureVertices(uint tex, const QRect *src,
     return true;
 }
 
+/**
+ * Fill data with two triangles per src/dst pair, laid out as all the
+ * vertex positions followed by all the texture coordinates, matching
+ * UpdateTextureVertices(). Returns the number of vertices.
+ */
+int MythRenderOpenGL::GetBatchVertices(uint tex, const QVector<QRect> &src,
+                                       const QVector<QRect> &dst,
+                                       QVector<GLfloat> &data)
+{
+    if (!m_textures.contains(tex))
+        return 0;
+
+    QSize size   = m_textures[tex].m_size;
+    bool  rect   = IsRectTexture(m_textures[tex].m_type);
+    float xscale = rect ? 1.0f : 1.0f / size.width();
+    float yscale = rect ? 1.0f : 1.0f / size.height();
+    int   count  = min(src.size(), dst.size());
+    int   verts  = count * 6;
+
+    data.resize(verts * 4);
+    GLfloat *pos = data.data();
+    GLfloat *tx  = pos + verts * 2;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const QRect &s = src[i];
+        const QRect &d = dst[i];
+
+        int width  = min(s.width(),  size.width());
+        int height = min(s.height(), size.height());
+
+        GLfloat left   = d.left();
+        GLfloat top    = d.top();
+        GLfloat right  = d.left() + min(width,  d.width());
+        GLfloat bottom = d.top()  + min(height, d.height());
+
+        GLfloat tleft   = s.left() * xscale;
+        GLfloat tright  = (s.left() + width) * xscale;
+        GLfloat ttop    = (s.top() + height) * yscale;
+        GLfloat tbottom = s.top() * yscale;
+
+        // top left, bottom left, top right, then the same for the
+        // second triangle of the quad
+        GLfloat quad[6][4] = {
+            { left,  top,    tleft,  ttop    },
+            { left,  bottom, tleft,  tbottom },
+            { right, top,    tright, ttop    },
+            { right, top,    tright, ttop    },
+            { left,  bottom, tleft,  tbottom },
+            { right, bottom, tright, tbottom },
+        };
+
+        for (int v = 0; v < 6; ++v)
+        {
+            *pos++ = quad[v][0];
+            *pos++ = quad[v][1];
+            *tx++  = quad[v][2];
+            *tx++  = quad[v][3];
+        }
+    }
+
+    return verts;
+}
+
 bool MythRenderOpenGL::UpdateTextureVertices(uint tex, const QRectF *src,
                                              const QRectF *dst)
 {
@@ -7,6 +7,7 @@
 #include <QGLContext>
 #include <QHash>
 #include <QMutex>
+#include <QVector>
 
 #define GL_GLEXT_PROTOTYPES
 
@@ -134,6 +135,7 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
 
     void* GetTextureBuffer(uint tex, bool create_buffer = true);
     void  UpdateTexture(uint tex, void *buf);
+    void  UpdateTextureRegion(uint tex, const QRect &area, void *buf);
     int   GetTextureType(bool &rect);
     bool  IsRectTexture(uint type);
     uint  CreateTexture(QSize act_size, bool use_pbo, uint type,
@@ -165,6 +167,9 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
                     int red = 255, int green = 255, int blue = 255);
     void DrawBitmap(uint *textures, uint texture_count, uint target,
                     const QRectF *src, const QRectF *dst, uint prog);
+    void DrawBitmaps(uint tex, uint target, const QVector<QRect> &src,
+                     const QVector<QRect> &dst, uint prog, int alpha = 255,
+                     int red = 255, int green = 255, int blue = 255);
     void DrawRect(const QRect &area, const QBrush &fillBrush,
                   const QPen &linePen, int alpha);
     void DrawRoundRect(const QRect &area, int cornerRadius,
@@ -180,6 +185,9 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
     virtual void DrawBitmapPriv(uint *textures, uint texture_count,
                                 const QRectF *src, const QRectF *dst,
                                 uint prog) = 0;
+    virtual void DrawBitmapsPriv(uint tex, const QVector<QRect> &src,
+                                 const QVector<QRect> &dst, uint prog,
+                                 int alpha, int red, int green, int blue) = 0;
     virtual void DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                               const QPen &linePen, int alpha) = 0;
     virtual void DrawRoundRectPriv(const QRect &area, int cornerRadius,
@@ -203,6 +211,8 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
 
     bool UpdateTextureVertices(uint tex, const QRect *src, const QRect *dst);
     bool UpdateTextureVertices(uint tex, const QRectF *src, const QRectF *dst);
+    int  GetBatchVertices(uint tex, const QVector<QRect> &src,
+                          const QVector<QRect> &dst, QVector<GLfloat> &data);
     GLfloat* GetCachedVertices(GLuint type, const QRect &area);
     void ExpireVertices(uint max = 0);
     void GetCachedVBO(GLuint type, const QRect &area);
@@ -378,6 +378,34 @@ void MythRenderOpenGL1::DrawBitmapPriv(uint *textures, uint texture_count,
     glDisableClientState(GL_VERTEX_ARRAY);
 }
 
+void MythRenderOpenGL1::DrawBitmapsPriv(uint tex, const QVector<QRect> &src,
+                                        const QVector<QRect> &dst, uint prog,
+                                        int alpha, int red, int green,
+                                        int blue)
+{
+    QVector<GLfloat> data;
+    int verts = GetBatchVertices(tex, src, dst, data);
+    if (!verts)
+        return;
+
+    if (prog && !m_programs.contains(prog))
+        prog = 0;
+
+    EnableShaderObject(prog);
+    SetBlend(true);
+    SetColor(red, green, blue, alpha);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    EnableTextures(tex);
+    glBindTexture(m_textures[tex].m_type, tex);
+    glVertexPointer(2, GL_FLOAT, 0, data.constData());
+    glTexCoordPointer(2, GL_FLOAT, 0, data.constData() + verts * 2);
+    glDrawArrays(GL_TRIANGLES, 0, verts);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 void MythRenderOpenGL1::DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                                      const QPen &linePen, int alpha)
 {
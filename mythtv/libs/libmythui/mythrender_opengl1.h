@@ -31,6 +31,9 @@ class MUI_PUBLIC MythRenderOpenGL1 : public MythRenderOpenGL
     virtual void DrawBitmapPriv(uint *textures, uint texture_count,
                                 const QRectF *src, const QRectF *dst,
                                 uint prog);
+    virtual void DrawBitmapsPriv(uint tex, const QVector<QRect> &src,
+                                 const QVector<QRect> &dst, uint prog,
+                                 int alpha, int red, int green, int blue);
     virtual void DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                               const QPen &linePen, int alpha);
     virtual void DrawRoundRectPriv(const QRect &area, int cornerRadius,
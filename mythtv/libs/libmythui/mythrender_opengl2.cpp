@@ -552,6 +552,52 @@ void MythRenderOpenGL2::DrawBitmapPriv(uint *textures, uint texture_count,
     m_glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void MythRenderOpenGL2::DrawBitmapsPriv(uint tex, const QVector<QRect> &src,
+                                        const QVector<QRect> &dst, uint prog,
+                                        int alpha, int red, int green,
+                                        int blue)
+{
+    QVector<GLfloat> data;
+    int verts = GetBatchVertices(tex, src, dst, data);
+    if (!verts)
+        return;
+
+    if (prog && !m_shader_objects.contains(prog))
+        prog = 0;
+    if (prog == 0)
+        prog = m_shaders[kShaderDefault];
+
+    EnableShaderObject(prog);
+    SetShaderParams(prog, &m_projection[0][0], "u_projection");
+    SetShaderParams(prog, &m_transforms.top().m[0][0], "u_transform");
+    SetBlend(true);
+
+    EnableTextures(tex);
+    glBindTexture(m_textures[tex].m_type, tex);
+
+    m_glBindBuffer(GL_ARRAY_BUFFER, m_textures[tex].m_vbo);
+    m_glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat),
+                   data.constData(), GL_STREAM_DRAW);
+
+    m_glEnableVertexAttribArray(VERTEX_INDEX);
+    m_glEnableVertexAttribArray(TEXTURE_INDEX);
+
+    m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
+                            VERTEX_SIZE * sizeof(GLfloat),
+                            (const void *) kVertexOffset);
+    m_glVertexAttrib4f(COLOR_INDEX, red / 255.0, green / 255.0, blue / 255.0, alpha / 255.0);
+    m_glVertexAttribPointer(TEXTURE_INDEX, TEXTURE_SIZE, GL_FLOAT, GL_FALSE,
+                            TEXTURE_SIZE * sizeof(GLfloat),
+                            (const void *) (verts * VERTEX_SIZE *
+                                            sizeof(GLfloat)));
+
+    glDrawArrays(GL_TRIANGLES, 0, verts);
+
+    m_glDisableVertexAttribArray(TEXTURE_INDEX);
+    m_glDisableVertexAttribArray(VERTEX_INDEX);
+    m_glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void MythRenderOpenGL2::DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                                      const QPen &linePen, int alpha)
 {
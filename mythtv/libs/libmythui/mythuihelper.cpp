@@ -1,12 +1,15 @@
 #include "mythuihelper.h"
 
 #include <cmath>
+#include <algorithm>
+using namespace std;
 
 #include <QImage>
 #include <QPixmap>
 #include <QMutex>
 #include <QPalette>
 #include <QMap>
+#include <QHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QApplication>
@@ -70,6 +73,100 @@ MythUIHelper *GetMythUI()
     return MythUIHelper::getMythUI();
 }
 
+/// Default memory cache budget, in full screens worth of 32bit images
+const int kImageCacheScreens = 6;
+
+/// An image held in the memory cache
+class ImageCacheEntry
+{
+  public:
+    ImageCacheEntry(const QString &key, MythImage *image)
+        : m_key(key), m_image(image),
+          m_lastUsed(MythDate::current().toTime_t()),
+          m_prev(NULL), m_next(NULL) { }
+
+    QString    m_key;
+    MythImage *m_image;
+    uint       m_lastUsed;  ///< last lookup that checked the source file
+
+    // Links in the LRU list, most recently used first
+    ImageCacheEntry *m_prev;
+    ImageCacheEntry *m_next;
+};
+
+/** \class ImageCacheLRU
+ *  \brief Hashed memory cache index kept in least recently used order.
+ *
+ *  Lookup, touch, insertion and removal are all constant time, so expiring
+ *  images no longer has to scan the whole cache for the oldest entry.
+ *  The entries are owned by the caller, which must hold the cache lock.
+ */
+class ImageCacheLRU
+{
+  public:
+    ImageCacheLRU() : m_head(NULL), m_tail(NULL) { }
+
+    ImageCacheEntry *Find(const QString &key) const
+    {
+        return m_entries.value(key, NULL);
+    }
+
+    void Insert(ImageCacheEntry *entry)
+    {
+        m_entries.insert(entry->m_key, entry);
+        LinkFront(entry);
+    }
+
+    void Touch(ImageCacheEntry *entry)
+    {
+        if (entry == m_head)
+            return;
+        Unlink(entry);
+        LinkFront(entry);
+    }
+
+    void Remove(ImageCacheEntry *entry)
+    {
+        Unlink(entry);
+        m_entries.remove(entry->m_key);
+    }
+
+    ImageCacheEntry *Oldest(void) const { return m_tail; }
+    int Count(void) const { return m_entries.size(); }
+    QList<QString> Keys(void) const { return m_entries.keys(); }
+
+  private:
+    void LinkFront(ImageCacheEntry *entry)
+    {
+        entry->m_prev = NULL;
+        entry->m_next = m_head;
+        if (m_head)
+            m_head->m_prev = entry;
+        m_head = entry;
+        if (!m_tail)
+            m_tail = entry;
+    }
+
+    void Unlink(ImageCacheEntry *entry)
+    {
+        if (entry->m_prev)
+            entry->m_prev->m_next = entry->m_next;
+        else
+            m_head = entry->m_next;
+
+        if (entry->m_next)
+            entry->m_next->m_prev = entry->m_prev;
+        else
+            m_tail = entry->m_prev;
+
+        entry->m_prev = entry->m_next = NULL;
+    }
+
+    QHash<QString, ImageCacheEntry *> m_entries;
+    ImageCacheEntry *m_head;
+    ImageCacheEntry *m_tail;
+};
+
 void DestroyMythUI()
 {
     MythUIHelper::destroyMythUI();
@@ -88,6 +185,10 @@ public:
 
     double GetPixelAspectRatio(void);
 
+    void SetCacheBudget(void);
+    void RemoveCacheEntry(ImageCacheEntry *entry);
+    void ClearImageCache(void);
+
     Settings *m_qtThemeSettings;   ///< Text/button/background colours, etc
 
     bool      m_themeloaded;       ///< Do we have a palette and pixmap to use?
@@ -108,13 +209,17 @@ public:
     int m_baseWidth, m_baseHeight;
     bool m_isWide;
 
-    QMap<QString, MythImage *> imageCache;
-    QMap<QString, uint> CacheTrack;
+    ImageCacheLRU imageCache;
     QMutex *m_cacheLock;
 
     QAtomicInt m_cacheSize;
     QAtomicInt m_maxCacheSize;
 
+    // Memory cache statistics, protected by m_cacheLock
+    uint m_cacheHits;
+    uint m_cacheMisses;
+    uint m_cacheEvictions;
+
     // The part of the screen(s) allocated for the GUI. Unless
     // overridden by the user, defaults to drawable area above.
     int m_screenxbase, m_screenybase;
@@ -157,6 +262,7 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
       m_baseWidth(800), m_baseHeight(600), m_isWide(false),
       m_cacheLock(new QMutex(QMutex::Recursive)),
       m_cacheSize(0), m_maxCacheSize(20 * 1024 * 1024),
+      m_cacheHits(0), m_cacheMisses(0), m_cacheEvictions(0),
       m_screenxbase(0), m_screenybase(0), m_screenwidth(0), m_screenheight(0),
       screensaver(NULL), screensaverEnabled(false), display_res(NULL),
       screenSetup(false), m_imageThreadPool(new MThreadPool("MythUIHelper")),
@@ -166,17 +272,7 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
 
 MythUIHelperPrivate::~MythUIHelperPrivate()
 {
-    QMutableMapIterator<QString, MythImage *> i(imageCache);
-
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
-
-    CacheTrack.clear();
+    ClearImageCache();
 
     delete m_cacheLock;
     delete m_imageThreadPool;
@@ -187,6 +283,49 @@ MythUIHelperPrivate::~MythUIHelperPrivate()
         DisplayRes::SwitchToDesktop();
 }
 
+/**
+ *  \brief Drop an entry from the memory cache, releasing its image.
+ *
+ *  The cache lock must be held.
+ */
+void MythUIHelperPrivate::RemoveCacheEntry(ImageCacheEntry *entry)
+{
+    imageCache.Remove(entry);
+    entry->m_image->SetIsInCache(false);
+    entry->m_image->DecrRef();
+    delete entry;
+}
+
+void MythUIHelperPrivate::ClearImageCache(void)
+{
+    ImageCacheEntry *entry;
+
+    while ((entry = imageCache.Oldest()))
+        RemoveCacheEntry(entry);
+}
+
+/**
+ *  \brief Size the memory cache for the current GUI resolution.
+ *
+ *  A UIImageCacheSize setting (in MB) overrides the default, which holds
+ *  kImageCacheScreens screens worth of images and never less than 20MB.
+ */
+void MythUIHelperPrivate::SetCacheBudget(void)
+{
+    int budget = GetMythDB()->GetNumSetting("UIImageCacheSize", 0);
+
+    if (budget > 0)
+        budget *= 1024 * 1024;
+    else
+        budget = max(20 * 1024 * 1024,
+                     m_screenwidth * m_screenheight * 4 * kImageCacheScreens);
+
+    m_maxCacheSize.fetchAndStoreRelease(budget);
+
+    LOG(VB_GUI, LOG_INFO, LOC +
+        QString("MythUI Image Cache size set to %1 bytes").arg(budget));
+}
+
 void MythUIHelperPrivate::Init(void)
 {
     screensaver = ScreenSaverControl::get();
@@ -398,12 +537,7 @@ void MythUIHelper::Init(MythUIMenuCallbacks &cbs)
     d->Init();
     d->callbacks = cbs;
 
-    d->m_maxCacheSize.fetchAndStoreRelease(
-        GetMythDB()->GetNumSetting("UIImageCacheSize", 20) * 1024 * 1024);
-
-    LOG(VB_GUI, LOG_INFO, LOC +
-        QString("MythUI Image Cache size set to %1 bytes")
-        .arg(d->m_maxCacheSize.fetchAndAddRelease(0)));
+    d->SetCacheBudget();
 }
 
 MythUIMenuCallbacks *MythUIHelper::GetMenuCBs(void)
@@ -492,20 +626,13 @@ void MythUIHelper::UpdateImageCache(void)
 {
     QMutexLocker locker(d->m_cacheLock);
 
-    QMutableMapIterator<QString, MythImage *> i(d->imageCache);
-
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
-
-    d->CacheTrack.clear();
+    d->ClearImageCache();
 
     d->m_cacheSize.fetchAndStoreOrdered(0);
 
+    // The GUI resolution may have changed along with the theme
+    d->SetCacheBudget();
+
     ClearOldImageCache();
 }
 
@@ -513,13 +640,19 @@ MythImage *MythUIHelper::GetImageFromCache(const QString &url)
 {
     QMutexLocker locker(d->m_cacheLock);
 
-    if (d->imageCache.contains(url))
+    ImageCacheEntry *entry = d->imageCache.Find(url);
+
+    if (entry)
     {
-        d->CacheTrack[url] = MythDate::current().toTime_t();
-        d->imageCache[url]->IncrRef();
-        return d->imageCache[url];
+        d->m_cacheHits++;
+        d->imageCache.Touch(entry);
+        entry->m_lastUsed = MythDate::current().toTime_t();
+        entry->m_image->IncrRef();
+        return entry->m_image;
     }
 
+    d->m_cacheMisses++;
+
     /*
         if (QFileInfo(url).exists())
         {
@@ -568,87 +701,74 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
         im->save(dstfile, "PNG");
     }
 
-    // delete the oldest cached images until we fall below threshold.
+    // delete the least recently used images until we fall below threshold.
     QMutexLocker locker(d->m_cacheLock);
 
-    while (d->m_cacheSize.fetchAndAddOrdered(0) + im->numBytes() >=
-           d->m_maxCacheSize.fetchAndAddOrdered(0) &&
-           d->imageCache.size())
-    {
-        QMap<QString, MythImage *>::iterator it = d->imageCache.begin();
-        uint oldestTime = MythDate::current().toTime_t();
-        QString oldestKey = it.key();
+    // Images still referenced outside the cache don't count towards its
+    // size and can't be expired, so move them to the front as we pass
+    // them rather than stepping over them again on every insertion.
+    ImageCacheEntry *entry = d->imageCache.Oldest();
+    int remaining = d->imageCache.Count();
 
-        int count = 0;
+    while (entry && remaining-- > 0 &&
+           d->m_cacheSize.fetchAndAddOrdered(0) + im->numBytes() >=
+           d->m_maxCacheSize.fetchAndAddOrdered(0))
+    {
+        ImageCacheEntry *newer = entry->m_prev;
+        bool inUse = (2 != entry->m_image->IncrRef()) ||
+                     (entry->m_image == im);
+        entry->m_image->DecrRef();
 
-        for (; it != d->imageCache.end(); ++it)
+        if (inUse)
         {
-            if (d->CacheTrack[it.key()] < oldestTime)
-            {
-                if ((2 == it.value()->IncrRef()) && (it.value() != im))
-                {
-                    oldestTime = d->CacheTrack[it.key()];
-                    oldestKey = it.key();
-                    count++;
-                }
-                it.value()->DecrRef();
-            }
+            d->imageCache.Touch(entry);
         }
-
-        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-            QString("%1 images are eligible for expiry").arg(count));
-
-        if (count > 0)
+        else
         {
             LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
                 QString("Cache too big (%1), removing :%2:")
                 .arg(d->m_cacheSize.fetchAndAddOrdered(0) + im->numBytes())
-                .arg(oldestKey));
+                .arg(entry->m_key));
 
-            d->imageCache[oldestKey]->SetIsInCache(false);
-            d->imageCache[oldestKey]->DecrRef();
-            d->imageCache.remove(oldestKey);
-            d->CacheTrack.remove(oldestKey);
-        }
-        else
-        {
-            break;
+            d->RemoveCacheEntry(entry);
+            d->m_cacheEvictions++;
         }
+
+        entry = newer;
     }
 
-    QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
+    entry = d->imageCache.Find(url);
 
-    if (it == d->imageCache.end())
+    if (!entry)
     {
         im->IncrRef();
-        d->imageCache[url] = im;
-        d->CacheTrack[url] = MythDate::current().toTime_t();
+        entry = new ImageCacheEntry(url, im);
+        d->imageCache.Insert(entry);
 
         im->SetIsInCache(true);
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
             QString("NOT IN RAM CACHE, Adding, and adding to size :%1: :%2:")
             .arg(url).arg(im->numBytes()));
     }
+    else
+    {
+        d->imageCache.Touch(entry);
+    }
 
     LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
         QString("MythUIHelper::CacheImage : Cache Count = :%1: size :%2:")
-        .arg(d->imageCache.count()).arg(d->m_cacheSize));
+        .arg(d->imageCache.Count()).arg(d->m_cacheSize));
 
-    return d->imageCache[url];
+    return entry->m_image;
 }
 
 void MythUIHelper::RemoveFromCacheByURL(const QString &url)
 {
     QMutexLocker locker(d->m_cacheLock);
-    QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
+    ImageCacheEntry *entry = d->imageCache.Find(url);
 
-    if (it != d->imageCache.end())
-    {
-        d->imageCache[url]->SetIsInCache(false);
-        d->imageCache[url]->DecrRef();
-        d->imageCache.remove(url);
-        d->CacheTrack.remove(url);
-    }
+    if (entry)
+        d->RemoveCacheEntry(entry);
 
     QString dstfile;
 
@@ -666,7 +786,7 @@ void MythUIHelper::RemoveFromCacheByFile(const QString &fname)
     partialKey.replace('/', '-');
 
     d->m_cacheLock->lock();
-    QList<QString> imageCacheKeys = d->imageCache.keys();
+    QList<QString> imageCacheKeys = d->imageCache.Keys();
     d->m_cacheLock->unlock();
 
     for (it = imageCacheKeys.begin(); it != imageCacheKeys.end(); ++it)
@@ -702,7 +822,7 @@ bool MythUIHelper::IsImageInCache(const QString &url)
 {
     QMutexLocker locker(d->m_cacheLock);
 
-    if (d->imageCache.contains(url))
+    if (d->imageCache.Find(url))
         return true;
 
     if (QFileInfo(url).exists())
@@ -711,6 +831,21 @@ bool MythUIHelper::IsImageInCache(const QString &url)
     return false;
 }
 
+ImageCacheStats MythUIHelper::GetImageCacheStats(void)
+{
+    QMutexLocker locker(d->m_cacheLock);
+
+    ImageCacheStats stats;
+    stats.hits      = d->m_cacheHits;
+    stats.misses    = d->m_cacheMisses;
+    stats.evictions = d->m_cacheEvictions;
+    stats.count     = d->imageCache.Count();
+    stats.size      = d->m_cacheSize.fetchAndAddOrdered(0);
+    stats.maxSize   = d->m_maxCacheSize.fetchAndAddOrdered(0);
+
+    return stats;
+}
+
 QString MythUIHelper::GetThemeCacheDir(void)
 {
     QString cachedirname = GetConfDir() + "/themecache/";
@@ -1498,11 +1633,23 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
 
         QMutexLocker locker(d->m_cacheLock);
 
-        if (d->imageCache.contains(label) &&
-            d->CacheTrack[label] + kImageCacheTimeout > now)
+        ImageCacheEntry *entry = d->imageCache.Find(label);
+
+        if (entry && entry->m_lastUsed + kImageCacheTimeout > now)
+        {
+            d->m_cacheHits++;
+            d->imageCache.Touch(entry);
+            entry->m_image->IncrRef();
+            return entry->m_image;
+        }
+
+        // A memory only lookup can't find anything on disk, so don't
+        // stat the source and disk cache files on the caller's thread
+        // just to find that out; the caller loads it in the background.
+        if (!entry && (cacheMode & kCacheCheckMemoryOnly))
         {
-            d->imageCache[label]->IncrRef();
-            return d->imageCache[label];
+            d->m_cacheMisses++;
+            return NULL;
         }
     }
 
@@ -30,6 +30,17 @@ typedef enum ImageCacheMode
     kCacheForceStat       = 0x4,
 } ImageCacheMode;
 
+/// Memory image cache counters, sizes are in bytes
+struct MUI_PUBLIC ImageCacheStats
+{
+    uint hits;
+    uint misses;
+    uint evictions;
+    int  count;
+    int  size;
+    int  maxSize;
+};
+
 struct MUI_PUBLIC MythUIMenuCallbacks
 {
     void (*exec_program)(const QString &cmd);
@@ -57,6 +68,7 @@ class MUI_PUBLIC MythUIHelper
     void RemoveFromCacheByURL(const QString &url);
     void RemoveFromCacheByFile(const QString &fname);
     bool IsImageInCache(const QString &url);
+    ImageCacheStats GetImageCacheStats(void);
     QString GetThemeCacheDir(void);
 
     void IncludeInCacheSize(MythImage *im);
@@ -173,7 +173,6 @@ class ImageLoader
     */
     static QString GenImageLabel(const ImageProperties &imProps)
     {
-        QString imagelabel;
         QString s_Attrib;
 
         if (imProps.isMasked)
@@ -197,14 +196,7 @@ class ImageLoader
         }
 
 
-        imagelabel  = QString("%1-%2-%3x%4.png")
-                    .arg(imProps.filename)
-                    .arg(s_Attrib)
-                    .arg(w)
-                    .arg(h);
-        imagelabel.replace('/', '-');
-
-        return imagelabel;
+        return MythUIImage::GenImageLabel(imProps.filename, s_Attrib, w, h);
     }
 
     static MythImage *LoadImage(MythPainter *painter,
@@ -578,6 +570,25 @@ MythUIImage::~MythUIImage()
     delete d;
 }
 
+/**
+ *  \brief Generates the name an image is kept under in the image cache,
+ *         for \p filename scaled to \p width x \p height with the
+ *         effects listed in \p attributes applied.
+ */
+QString MythUIImage::GenImageLabel(const QString &filename,
+                                   const QString &attributes,
+                                   int width, int height)
+{
+    QString imagelabel = QString("%1-%2-%3x%4.png")
+                            .arg(filename)
+                            .arg(attributes)
+                            .arg(width)
+                            .arg(height);
+    imagelabel.replace('/', '-');
+
+    return imagelabel;
+}
+
 /**
  *  \brief Remove all images from the widget
  */
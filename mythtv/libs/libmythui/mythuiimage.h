@@ -115,6 +115,14 @@ class MUI_PUBLIC MythUIImage : public MythUIType
     void Reset(void);
     bool Load(bool allowLoadInBackground = true, bool forceStat = false);
 
+    QSize GetForceSize(void) const { return m_imageProperties.forceSize; }
+    bool GetPreserveAspect(void) const
+        { return m_imageProperties.preserveAspect; }
+
+    static QString GenImageLabel(const QString &filename,
+                                 const QString &attributes,
+                                 int width, int height);
+
     virtual void Pulse(void);
 
     virtual void LoadNow(void);
@@ -7,6 +7,11 @@
 
 // QT headers
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QTime>
 #include <QDomDocument>
 #include <QString>
 #include <QBrush>
@@ -323,6 +328,20 @@ QString XMLParseBase::parseText(QDomElement &element)
 static MythUIType *globalObjectStore = NULL;
 static QStringList loadedBaseFiles;
 
+/// A theme file parsed once, reused while the file is unchanged
+class ParsedThemeFile
+{
+  public:
+    QDomDocument m_doc;
+    QDateTime    m_modified;
+    qint64       m_size;
+};
+
+// Keyed by the full path of the theme file. Windows are built by parsing
+// the cached document again, so each screen gets its own fresh widgets.
+static QHash<QString, ParsedThemeFile> parsedThemeFiles;
+static QMutex parsedThemeFilesLock;
+
 MythUIType *XMLParseBase::GetGlobalObjectStore(void)
 {
     if (!globalObjectStore)
@@ -338,6 +357,10 @@ void XMLParseBase::ClearGlobalObjectStore(void)
 
     // clear any loaded base xml files which will force a reload the next time they are used
     loadedBaseFiles.clear();
+
+    // and read the theme files again in case the theme has changed
+    QMutexLocker locker(&parsedThemeFilesLock);
+    parsedThemeFiles.clear();
 }
 
 void XMLParseBase::ParseChildren(const QString &filename,
@@ -625,28 +648,10 @@ bool XMLParseBase::WindowExists(const QString &xmlfile,
     for (; it != searchpath.end(); ++it)
     {
         QString themefile = *it + xmlfile;
-        QFile f(themefile);
-
-        if (!f.open(QIODevice::ReadOnly))
-            continue;
 
         QDomDocument doc;
-        QString errorMsg;
-        int errorLine = 0;
-        int errorColumn = 0;
-
-        if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
-        {
-            LOG(VB_GENERAL, LOG_ERR, LOC +
-                QString("Location: '%1' @ %2 column: %3"
-                        "\n\t\t\tError: %4")
-                    .arg(qPrintable(themefile)).arg(errorLine).arg(errorColumn)
-                    .arg(qPrintable(errorMsg)));
-            f.close();
+        if (!LoadDocument(themefile, doc, true))
             continue;
-        }
-
-        f.close();
 
         QDomElement docElem = doc.documentElement();
         QDomNode n = docElem.firstChild();
@@ -676,6 +681,9 @@ bool XMLParseBase::LoadWindowFromXML(const QString &xmlfile,
     bool onlyLoadWindows = true;
     bool showWarnings = true;
 
+    QTime timer;
+    timer.start();
+
     const QStringList searchpath = GetMythUI()->GetThemeSearchPath();
     QStringList::const_iterator it = searchpath.begin();
     for (; it != searchpath.end(); ++it)
@@ -685,6 +693,9 @@ bool XMLParseBase::LoadWindowFromXML(const QString &xmlfile,
         if (doLoad(windowname, parent, themefile,
                    onlyLoadWindows, showWarnings))
         {
+            LOG(VB_GUI, LOG_INFO, LOC +
+                QString("Loaded window %1 from %2 in %3 ms")
+                    .arg(windowname).arg(themefile).arg(timer.elapsed()));
             return true;
         }
         else
@@ -700,13 +711,32 @@ bool XMLParseBase::LoadWindowFromXML(const QString &xmlfile,
     return false;
 }
 
-bool XMLParseBase::doLoad(const QString &windowname,
-                          MythUIType *parent,
-                          const QString &filename,
-                          bool onlywindows,
-                          bool showWarnings)
+/**
+ *  \brief Read and parse a theme file.
+ *
+ *  With useCache the parsed document is kept and handed out again until
+ *  the file's size or modification time changes, so windows can be opened
+ *  again without reading and parsing their theme file each time.
+ */
+bool XMLParseBase::LoadDocument(const QString &filename, QDomDocument &doc,
+                                bool useCache)
 {
-    QDomDocument doc;
+    QFileInfo fi(filename);
+
+    if (useCache)
+    {
+        QMutexLocker locker(&parsedThemeFilesLock);
+
+        QHash<QString, ParsedThemeFile>::const_iterator it =
+            parsedThemeFiles.find(filename);
+        if (it != parsedThemeFiles.end() &&
+            it->m_modified == fi.lastModified() && it->m_size == fi.size())
+        {
+            doc = it->m_doc;
+            return true;
+        }
+    }
+
     QFile f(filename);
 
     if (!f.open(QIODevice::ReadOnly))
@@ -729,6 +759,32 @@ bool XMLParseBase::doLoad(const QString &windowname,
 
     f.close();
 
+    if (useCache)
+    {
+        ParsedThemeFile entry;
+        entry.m_doc      = doc;
+        entry.m_modified = fi.lastModified();
+        entry.m_size     = fi.size();
+
+        QMutexLocker locker(&parsedThemeFilesLock);
+        parsedThemeFiles.insert(filename, entry);
+    }
+
+    return true;
+}
+
+bool XMLParseBase::doLoad(const QString &windowname,
+                          MythUIType *parent,
+                          const QString &filename,
+                          bool onlywindows,
+                          bool showWarnings)
+{
+    // base theme files are only read once anyway, so only windows
+    // are worth keeping
+    QDomDocument doc;
+    if (!LoadDocument(filename, doc, onlywindows))
+        return false;
+
     QDomElement docElem = doc.documentElement();
     QDomNode n = docElem.firstChild();
     while (!n.isNull())
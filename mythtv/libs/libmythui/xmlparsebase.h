@@ -9,6 +9,7 @@
 class MythUIType;
 class MythScreenType;
 class QDomElement;
+class QDomDocument;
 class QBrush;
 
 #define VERBOSE_XML(type, level, filename, element, msg)                  \
@@ -62,6 +63,8 @@ class MUI_PUBLIC XMLParseBase
                                    MythScreenType *win);
 
   private:
+    static bool LoadDocument(const QString &filename, QDomDocument &doc,
+                             bool useCache);
     static bool doLoad(const QString &windowname, MythUIType *parent,
                        const QString &filename,
                        bool onlyLoadWindows, bool showWarnings);
@@ -22,6 +22,8 @@
 
 // Qt headers
 #include <QScriptEngine>
+#include <QSocketNotifier>
+#include <QTimer>
 
 // MythTV headers
 #include "httpserver.h"
@@ -31,6 +33,7 @@
 #include "mythdirs.h"
 #include "mythlogging.h"
 #include "htmlserver.h"
+#include "bufferedsocketdevice.h"
 
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
@@ -50,10 +53,15 @@ QString  HttpServer::s_platform;
 HttpServer::HttpServer(const QString sApplicationPrefix) :
     ServerPool(), m_sSharePath(GetShareDir()),
     m_pHtmlServer(new HtmlServerExtension(m_sSharePath, sApplicationPrefix)),
-    m_threadPool("HttpServerPool"), m_running(true)
+    m_threadPool("HttpServerPool"), m_running(true),
+    m_parkTimer(new QTimer(this)), m_keepAliveTimeout(-1)
 {
     setMaxPendingConnections(20);
 
+    connect(m_parkTimer, SIGNAL(timeout()),
+            this,        SLOT(ExpireParkedConnections()));
+    m_parkTimer->start(1000);
+
     // ----------------------------------------------------------------------
     // Build Platform String
     // ----------------------------------------------------------------------
@@ -90,6 +98,19 @@ HttpServer::~HttpServer()
 
     m_threadPool.Stop();
 
+    m_parkLock.lock();
+    while (!m_parkQueue.empty())
+        delete m_parkQueue.takeFirst();
+    m_parkLock.unlock();
+
+    QMap<int, ParkedConnection>::iterator it = m_parked.begin();
+    for (; it != m_parked.end(); ++it)
+    {
+        delete (*it).m_pNotifier;
+        delete (*it).m_pSocket;
+    }
+    m_parked.clear();
+
     while (!m_extensions.empty())
     {
         delete m_extensions.takeFirst();
@@ -229,6 +250,112 @@ void HttpServer::DelegateRequest(HTTPRequest *pRequest)
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Called by a worker once a keep-alive connection has no more pending
+// requests.  The socket is watched from the server's event loop and a
+// new worker is only started once the client sends something again.
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ParkConnection(BufferedSocketDevice *pSocket)
+{
+    if (!IsRunning())
+    {
+        delete pSocket;
+        return;
+    }
+
+    m_parkLock.lock();
+    m_parkQueue.append(pSocket);
+    m_parkLock.unlock();
+
+    QMetaObject::invokeMethod(this, "ProcessParkQueue", Qt::QueuedConnection);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ProcessParkQueue(void)
+{
+    if (m_keepAliveTimeout < 0)
+    {
+        m_keepAliveTimeout = 1000 *
+            UPnp::GetConfiguration()->GetValue("HTTP/KeepAliveTimeoutSecs", 10);
+    }
+
+    QMutexLocker locker(&m_parkLock);
+
+    while (!m_parkQueue.empty())
+    {
+        BufferedSocketDevice *pSocket = m_parkQueue.takeFirst();
+        int nSocket = pSocket->socket();
+
+        if (!pSocket->IsValid() || m_parked.contains(nSocket))
+        {
+            delete pSocket;
+            continue;
+        }
+
+        ParkedConnection conn;
+        conn.m_pSocket   = pSocket;
+        conn.m_pNotifier = new QSocketNotifier(nSocket,
+                                               QSocketNotifier::Read, this);
+        conn.m_parked.start();
+
+        connect(conn.m_pNotifier, SIGNAL(activated(int)),
+                this,             SLOT(ResumeConnection(int)));
+
+        m_parked.insert(nSocket, conn);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ResumeConnection(int nSocket)
+{
+    QMap<int, ParkedConnection>::iterator it = m_parked.find(nSocket);
+    if (it == m_parked.end())
+        return;
+
+    ParkedConnection conn = *it;
+    m_parked.erase(it);
+
+    // We're inside the notifier's signal, so it can't be deleted directly.
+    conn.m_pNotifier->setEnabled(false);
+    conn.m_pNotifier->deleteLater();
+
+    m_threadPool.startReserved(
+        new HttpWorker(*this, conn.m_pSocket),
+        QString("HttpServer%1").arg(nSocket));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ExpireParkedConnections(void)
+{
+    QMap<int, ParkedConnection>::iterator it = m_parked.begin();
+    while (it != m_parked.end())
+    {
+        if ((*it).m_parked.elapsed() < m_keepAliveTimeout)
+        {
+            ++it;
+            continue;
+        }
+
+        LOG(VB_UPNP, LOG_DEBUG,
+            QString("HttpServer: Closing idle keep-alive socket(%1)")
+                .arg(it.key()));
+
+        delete (*it).m_pNotifier;
+        delete (*it).m_pSocket;
+        it = m_parked.erase(it);
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -238,12 +365,25 @@ void HttpServer::DelegateRequest(HTTPRequest *pRequest)
 /////////////////////////////////////////////////////////////////////////////
 
 HttpWorker::HttpWorker(HttpServer &httpServer, int sock) :
-    m_httpServer(httpServer), m_socket(sock), m_socketTimeout(10000)
+    m_httpServer(httpServer), m_socket(sock), m_socketTimeout(10000),
+    m_pSocket(NULL)
 {
     m_socketTimeout = 1000 *
         UPnp::GetConfiguration()->GetValue("HTTP/KeepAliveTimeoutSecs", 10);
 }                  
 
+/////////////////////////////////////////////////////////////////////////////
+// Resumes a parked keep-alive connection, taking ownership of pSocket.
+/////////////////////////////////////////////////////////////////////////////
+
+HttpWorker::HttpWorker(HttpServer &httpServer, BufferedSocketDevice *pSocket) :
+    m_httpServer(httpServer), m_socket(pSocket->socket()),
+    m_socketTimeout(10000), m_pSocket(pSocket)
+{
+    m_socketTimeout = 1000 *
+        UPnp::GetConfiguration()->GetValue("HTTP/KeepAliveTimeoutSecs", 10);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -257,12 +397,16 @@ void HttpWorker::run(void)
 
     bool                    bTimeout   = false;
     bool                    bKeepAlive = true;
-    BufferedSocketDevice   *pSocket    = NULL;
+    bool                    bPark      = false;
+    BufferedSocketDevice   *pSocket    = m_pSocket;
     HTTPRequest            *pRequest   = NULL;
 
+    m_pSocket = NULL;
+
     try
     {
-        if ((pSocket = new BufferedSocketDevice( m_socket )) == NULL)
+        if ((pSocket == NULL) &&
+            (pSocket = new BufferedSocketDevice( m_socket )) == NULL)
         {
             LOG(VB_GENERAL, LOG_ERR, "Error Creating BufferedSocketDevice");
             return;
@@ -343,6 +487,19 @@ void HttpWorker::run(void)
 
                     delete pRequest;
                     pRequest = NULL;
+
+                    // -------------------------------------------------------
+                    // Pipelined requests already buffered are handled right
+                    // away, otherwise hand the idle connection back to the
+                    // server instead of blocking this thread waiting on it.
+                    // -------------------------------------------------------
+
+                    if (bKeepAlive && pSocket->IsValid() &&
+                        pSocket->BytesAvailable() == 0)
+                    {
+                        bPark = true;
+                        break;
+                    }
                 }
                 else
                 {
@@ -366,6 +523,13 @@ void HttpWorker::run(void)
     if (pRequest != NULL)
         delete pRequest;
 
+    if (bPark && m_httpServer.IsRunning())
+    {
+        m_httpServer.ParkConnection(pSocket);
+        m_socket = 0;
+        return;
+    }
+
     pSocket->Close();
 
     delete pSocket;
@@ -28,6 +28,7 @@
 #include <QPointer>
 #include <QMutex>
 #include <QList>
+#include <QTime>
 
 // MythTV headers
 #include "serverpool.h"
@@ -40,7 +41,10 @@ typedef struct timeval  TaskTime;
 
 class HttpWorkerThread;
 class QScriptEngine;
+class QSocketNotifier;
+class QTimer;
 class HttpServer;
+class BufferedSocketDevice;
 
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
@@ -81,8 +85,22 @@ typedef QList<QPointer<HttpServerExtension> > HttpServerExtensionList;
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
+/// Idle keep-alive connection waiting in the server's event loop for
+/// its next request, so it doesn't occupy a worker thread meanwhile.
+class ParkedConnection
+{
+  public:
+    ParkedConnection() : m_pSocket(NULL), m_pNotifier(NULL) {}
+
+    BufferedSocketDevice *m_pSocket;
+    QSocketNotifier      *m_pNotifier;
+    QTime                 m_parked;
+};
+
 class UPNP_PUBLIC HttpServer : public ServerPool
 {
+    Q_OBJECT
+
   protected:
     mutable QReadWriteLock  m_rwlock;
     HttpServerExtensionList m_extensions;
@@ -93,6 +111,15 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     MThreadPool             m_threadPool;
     bool                    m_running; // protected by m_rwlock
 
+    // Keep-alive connections handed back by workers between requests.
+    // m_parkQueue is filled from worker threads (protected by
+    // m_parkLock), m_parked is only touched from the server's thread.
+    QMutex                        m_parkLock;
+    QList<BufferedSocketDevice*>  m_parkQueue;
+    QMap<int, ParkedConnection>   m_parked;
+    QTimer                       *m_parkTimer;
+    int                           m_keepAliveTimeout;
+
     static QMutex           s_platformLock;
     static QString          s_platform;
 
@@ -103,6 +130,7 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     void RegisterExtension(HttpServerExtension*);
     void UnregisterExtension(HttpServerExtension*);
     void DelegateRequest(HTTPRequest*);
+    void ParkConnection(BufferedSocketDevice*);
 
     QScriptEngine *ScriptEngine(void);
 
@@ -122,6 +150,11 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     }
 
     static QString GetPlatform(void);
+
+  private slots:
+    void ProcessParkQueue(void);
+    void ResumeConnection(int socket);
+    void ExpireParkedConnections(void);
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -136,13 +169,15 @@ class HttpWorker : public QRunnable
 {
   public:
     HttpWorker(HttpServer &httpServer, int sock);
+    HttpWorker(HttpServer &httpServer, BufferedSocketDevice *pSocket);
 
     virtual void run(void);
 
   protected:
-    HttpServer &m_httpServer; 
-    int         m_socket;
-    int         m_socketTimeout;
+    HttpServer           &m_httpServer;
+    int                   m_socket;
+    int                   m_socketTimeout;
+    BufferedSocketDevice *m_pSocket;
 };
 
 
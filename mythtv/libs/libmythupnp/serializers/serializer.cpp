@@ -15,6 +15,9 @@
 #include <QMetaObject>
 #include <QMetaProperty>
 
+QMutex                                               Serializer::s_propCacheLock;
+QHash< const QMetaObject*, SerializerPropertyList* > Serializer::s_propCache;
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
@@ -104,41 +107,31 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 {
     if (pObject != NULL)
     {
-        const QMetaObject *pMetaObject = pObject->metaObject();
-
-        int nCount = pMetaObject->propertyCount();
+        const QMetaObject            *pMetaObject = pObject->metaObject();
+        const SerializerPropertyList *pProps      = GetPropertyList( pMetaObject );
 
-        for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+        SerializerPropertyList::const_iterator it = pProps->begin();
+        for (; it != pProps->end(); ++it)
         {
-            QMetaProperty metaProperty = pMetaObject->property( nIdx );
+            const SerializerPropertyInfo &info = *it;
+
+            // DESIGNABLE may be a member function, so it is evaluated for
+            // every object rather than cached with the class metadata.
+
+            if (!info.m_metaProperty.isDesignable( pObject ))
+                continue;
+
+            QVariant value( info.m_metaProperty.read( pObject ) );
 
-            if (metaProperty.isDesignable( pObject ))
+            if (!info.m_bTransient)
             {
-                const char *pszPropName = metaProperty.name();
-                QString     sPropName( pszPropName );
-
-                if ( sPropName.compare( "objectName" ) == 0)
-                    continue;
-                
-                bool bHash = false;
-
-                if (ReadPropertyMetadata( pObject, 
-                                          sPropName, 
-                                          "transient").toLower() != "true" )
-                {
-                    bHash = true;
-                    m_hash.addData( sPropName.toUtf8() );
-                }
-
-                QVariant value( pObject->property( pszPropName ) );
-
-                if (bHash && !value.canConvert< QObject* >()) 
-                {
-                    m_hash.addData( value.toString().toUtf8() );
-                }
+                m_hash.addData( info.m_sUtf8Name );
 
-                AddProperty( sPropName, value, pMetaObject, &metaProperty );
+                if (!value.canConvert< QObject* >()) 
+                    m_hash.addData( value.toString().toUtf8() );
             }
+
+            AddProperty( info.m_sName, value, pMetaObject, &info.m_metaProperty );
         }
     }
 }
@@ -147,12 +140,65 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 //
 /////////////////////////////////////////////////////////////////////////////
 
+const SerializerPropertyList *Serializer::GetPropertyList(
+    const QMetaObject *pMeta )
+{
+    QMutexLocker locker( &s_propCacheLock );
+
+    QHash< const QMetaObject*, SerializerPropertyList* >::const_iterator it =
+        s_propCache.find( pMeta );
+
+    if (it != s_propCache.end())
+        return *it;
+
+    // Entries live for the lifetime of the process, QMetaObjects are static.
+
+    SerializerPropertyList *pList = new SerializerPropertyList();
+
+    int nCount = pMeta->propertyCount();
+
+    for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+    {
+        SerializerPropertyInfo info;
+
+        info.m_metaProperty = pMeta->property( nIdx );
+        info.m_sName        = info.m_metaProperty.name();
+
+        if ( info.m_sName.compare( "objectName" ) == 0)
+            continue;
+
+        info.m_sUtf8Name    = info.m_sName.toUtf8();
+        info.m_bTransient   = ReadPropertyMetadata( pMeta, info.m_sName,
+                                                    "transient" )
+                                  .toLower() == "true";
+
+        pList->append( info );
+    }
+
+    s_propCache.insert( pMeta, pList );
+
+    return pList;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QString Serializer::ReadPropertyMetadata( const QObject *pObject, 
                                                 QString  sPropName, 
                                                 QString  sKey )
 {
-    const QMetaObject *pMeta = pObject->metaObject();
+    return ReadPropertyMetadata( pObject->metaObject(), sPropName, sKey );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
 
+QString Serializer::ReadPropertyMetadata( const QMetaObject *pMeta,
+                                          const QString     &sPropName,
+                                          const QString     &sKey )
+{
     int nIdx = pMeta->indexOfClassInfo( sPropName.toUtf8() );
 
     if (nIdx >=0)
@@ -17,7 +17,10 @@
 #include "upnputil.h"
 
 #include <QList>
+#include <QHash>
+#include <QMutex>
 #include <QMetaType>
+#include <QMetaProperty>
 #include <QCryptographicHash>
 
 //////////////////////////////////////////////////////////////////////////////
@@ -28,8 +31,32 @@
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////
+// Per class property metadata, built once per QMetaObject so walking large
+// lists of data contract objects doesn't re-parse Q_CLASSINFO strings.
+//////////////////////////////////////////////////////////////////////////////
+
+class SerializerPropertyInfo
+{
+    public:
+
+        QMetaProperty   m_metaProperty;
+        QString         m_sName;
+        QByteArray      m_sUtf8Name;
+        bool            m_bTransient;
+};
+
+typedef QList< SerializerPropertyInfo > SerializerPropertyList;
+
+//////////////////////////////////////////////////////////////////////////////
+
 class UPNP_PUBLIC Serializer
 {
+    private:
+
+        static QMutex                                               s_propCacheLock;
+        static QHash< const QMetaObject*, SerializerPropertyList* > s_propCache;
+
     protected:
 
         QCryptographicHash  m_hash;
@@ -54,6 +81,13 @@ class UPNP_PUBLIC Serializer
                                                  QString  sPropName, 
                                                  QString  sKey );
 
+        static QString ReadPropertyMetadata( const QMetaObject *pMeta,
+                                             const QString     &sPropName,
+                                             const QString     &sKey );
+
+        static const SerializerPropertyList *GetPropertyList(
+                                             const QMetaObject *pMeta );
+
     public:
 
         virtual void Serialize( const QObject *pObject, const QString &_sName = QString() );
@@ -22,6 +22,9 @@
 
 #define XML_SERIALIZER_VERSION "1.1"
 
+QMutex                                       XmlSerializer::s_contentNameLock;
+QHash< const QMetaObject*, ContentNameMap >  XmlSerializer::s_contentNames;
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
@@ -289,9 +292,26 @@ QString XmlSerializer::GetContentName( const QString        &sName,
                                        const QMetaObject   *pMetaObject,
                                        const QMetaProperty *pMetaProp )
 {
+    // The answer only depends on the class and property name, so it is
+    // looked up once and reused for every object of that class.
+
+    if (pMetaObject != NULL)
+    {
+        QMutexLocker locker( &s_contentNameLock );
+
+        ContentNameMap &names = s_contentNames[ pMetaObject ];
+
+        ContentNameMap::const_iterator it = names.find( sName );
+        if (it != names.end())
+            return *it;
+    }
+
+    QString sTypeName;
+
     // Try to read Name or TypeName from classinfo metadata.
 
-    int nClassIdx = pMetaObject->indexOfClassInfo( sName.toAscii() );
+    int nClassIdx = (pMetaObject != NULL) ?
+                    pMetaObject->indexOfClassInfo( sName.toAscii() ) : -1;
 
     if (nClassIdx >=0)
     {
@@ -304,18 +324,27 @@ QString XmlSerializer::GetContentName( const QString        &sName,
             sNameOption = FindOptionValue( sOptions, "type" );
 
         if (!sNameOption.isEmpty())
-            return GetItemName(  sNameOption );
+            sTypeName = GetItemName( sNameOption );
     }
 
-    // Neither found, so lets use the type name (slightly modified).
+    if (sTypeName.isEmpty())
+    {
+        // Neither found, so lets use the type name (slightly modified).
 
-    QString sTypeName( sName );    
+        sTypeName = sName;
 
-    if (sName.at(0) == 'Q')        
-        sTypeName = sName.mid( 1 );    
+        if (sName.at(0) == 'Q')        
+            sTypeName = sName.mid( 1 );    
 
-    sTypeName.remove( "DTC::"    );    
-    sTypeName.remove( QChar('*') );
+        sTypeName.remove( "DTC::"    );    
+        sTypeName.remove( QChar('*') );
+    }
+
+    if (pMetaObject != NULL)
+    {
+        QMutexLocker locker( &s_contentNameLock );
+        s_contentNames[ pMetaObject ].insert( sName, sTypeName );
+    }
 
     return sTypeName;
 }
@@ -17,6 +17,8 @@
 #include <QVariant>
 #include <QIODevice>
 #include <QStringList>
+#include <QHash>
+#include <QMutex>
 
 #include "upnpexp.h"
 #include "serializer.h"
@@ -29,8 +31,15 @@
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
+typedef QHash< QString, QString > ContentNameMap;
+
 class UPNP_PUBLIC XmlSerializer : public Serializer
 {
+    private:
+
+        // Element names resolved from Q_CLASSINFO, per class & property.
+        static QMutex                                       s_contentNameLock;
+        static QHash< const QMetaObject*, ContentNameMap >  s_contentNames;
 
     protected:
 
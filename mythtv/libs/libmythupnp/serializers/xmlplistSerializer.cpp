@@ -259,25 +259,18 @@ void XmlPListSerializer::SerializePListObjectProperties(const QString &sName,
     }
     m_pXmlWriter->writeStartElement("dict");
 
-    const QMetaObject *pMetaObject = pObject->metaObject();
+    const QMetaObject            *pMetaObject = pObject->metaObject();
+    const SerializerPropertyList *pProps      = GetPropertyList(pMetaObject);
 
-    int nCount = pMetaObject->propertyCount();
-
-    for (int nIdx=0; nIdx < nCount; ++nIdx)
+    SerializerPropertyList::const_iterator it = pProps->begin();
+    for (; it != pProps->end(); ++it)
     {
-        QMetaProperty metaProperty = pMetaObject->property(nIdx);
-
-        if (metaProperty.isDesignable(pObject))
+        if ((*it).m_metaProperty.isDesignable(pObject))
         {
-            const char *pszPropName = metaProperty.name();
-            QString     sPropName(pszPropName);
-
-            if (sPropName.compare("objectName") == 0)
-                continue;
-
-            QVariant value(pObject->property(pszPropName));
+            QVariant value((*it).m_metaProperty.read(pObject));
 
-            AddProperty(sPropName, value, pMetaObject, &metaProperty);
+            AddProperty((*it).m_sName, value, pMetaObject,
+                        &(*it).m_metaProperty);
         }
     }
 
@@ -10,17 +10,30 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 
+#include <climits>
 #include <cmath>
 #include <algorithm>
 using namespace std;
 
+#include <QTextStream>
+#include <QTextCodec>
+#include <QTimerEvent>
+
 #include "upnp.h"
 #include "upnpcds.h"
 #include "upnputil.h"
 #include "mythlogging.h"
+#include "mythcorecontext.h"
+#include "mythevent.h"
+#include "mythdb.h"
 
 #define DIDL_LITE_BEGIN "<DIDL-Lite xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmlns:upnp=\"urn:schemas-upnp-org:metadata-1-0/upnp/\" xmlns=\"urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/\">"
-#define DIDL_LITE_END   "</DIDL-Lite>";
+#define DIDL_LITE_END   "</DIDL-Lite>"
+
+// Library change events often arrive in bursts (e.g. one
+// RECORDING_LIST_CHANGE UPDATE per recording in progress), so they are
+// coalesced into at most one SystemUpdateID bump per interval.
+#define CDS_UPDATE_ID_INTERVAL  5000
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -38,11 +51,12 @@ void UPnpCDSExtensionResults::Add( CDSObject *pObject )
 
 QString UPnpCDSExtensionResults::GetResultXML(FilterMap &filter)
 {
-    QString sXML;
+    QString     sXML;
+    QTextStream os( &sXML, QIODevice::WriteOnly );
+    os.setCodec(QTextCodec::codecForName("UTF-8"));
 
-    CDSObjects::const_iterator it = m_List.begin();
-    for (; it != m_List.end(); ++it)
-        sXML += (*it)->toXml(filter);
+    GetResultXML(os, filter);
+    os << flush;
 
     return sXML;
 }
@@ -51,8 +65,20 @@ QString UPnpCDSExtensionResults::GetResultXML(FilterMap &filter)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+void UPnpCDSExtensionResults::GetResultXML(QTextStream &os, FilterMap &filter)
+{
+    CDSObjects::const_iterator it = m_List.begin();
+    for (; it != m_List.end(); ++it)
+        (*it)->toXml(os, filter);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
-  : Eventing( "UPnpCDS", "CDS_Event", sSharePath )
+  : Eventing( "UPnpCDS", "CDS_Event", sSharePath ),
+    m_nUpdateIDTimerId( 0 )
 {
     m_root.m_eType      = OT_Container;
     m_root.m_sId        = "0";
@@ -68,6 +94,8 @@ UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
 
     SetValue< unsigned short >( "SystemUpdateID", 1 );
 
+    gCoreContext->addListener( this );
+
     QString sUPnpDescPath = UPnp::GetConfiguration()->GetValue( "UPnP/DescXmlPath", sSharePath );
 
     m_sServiceDescFileName = sUPnpDescPath + "CDS_scpd.xml";
@@ -85,6 +113,11 @@ UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
 
 UPnpCDS::~UPnpCDS()
 {
+    gCoreContext->removeListener( this );
+
+    if (m_nUpdateIDTimerId)
+        killTimer( m_nUpdateIDTimerId );
+
     while (!m_extensions.empty())
     {
         delete m_extensions.back();
@@ -156,6 +189,63 @@ QStringList UPnpCDS::GetBasePaths()
 //
 /////////////////////////////////////////////////////////////////////////////
 
+void UPnpCDS::customEvent( QEvent *e )
+{
+    if ((MythEvent::Type)(e->type()) != MythEvent::MythEventMessage)
+        return;
+
+    MythEvent *me = (MythEvent *)e;
+    QString message = me->Message();
+
+    if (message.startsWith("RECORDING_LIST_CHANGE") ||
+        message.startsWith("VIDEO_LIST_CHANGE"))
+    {
+        if (m_nUpdateIDTimerId == 0)
+            m_nUpdateIDTimerId = startTimer( CDS_UPDATE_ID_INTERVAL );
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDS::timerEvent( QTimerEvent *e )
+{
+    if (e->timerId() != m_nUpdateIDTimerId)
+        return;
+
+    killTimer( m_nUpdateIDTimerId );
+    m_nUpdateIDTimerId = 0;
+
+    IncrementSystemUpdateID();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDS::IncrementSystemUpdateID( void )
+{
+    unsigned short nId = GetValue<unsigned short>("SystemUpdateID") + 1;
+
+    // Zero is reserved by the spec, skip it when the counter wraps.
+    if (nId == 0)
+        nId = 1;
+
+    UPnpCDSExtensionList::iterator it = m_extensions.begin();
+    for (; it != m_extensions.end(); ++it)
+        (*it)->InvalidateCountCache();
+
+    SetValue< unsigned short >( "SystemUpdateID", nId );
+
+    LOG(VB_UPNP, LOG_DEBUG,
+        QString("UPnpCDS::IncrementSystemUpdateID - now %1").arg(nId));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 bool UPnpCDS::ProcessRequest( HTTPRequest *pRequest )
 {
     if (pRequest)
@@ -330,12 +420,19 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
 
     UPnPResultCode eErrorCode      = UPnPResult_CDS_NoSuchObject;
     QString        sErrorDesc      = "";
-    short          nNumberReturned = 0;
-    short          nTotalMatches   = 0;
+    int            nNumberReturned = 0;
+    int            nTotalMatches   = 0;
     short          nUpdateID       = 0;
-    QString        sResultXML;
     FilterMap filter =  (FilterMap) request.m_sFilter.split(',');
 
+    // Objects are serialized straight into the DIDL-Lite document as
+    // they are produced instead of concatenating per-object strings.
+
+    QString        sResults;
+    QTextStream    os( &sResults, QIODevice::WriteOnly );
+    os.setCodec(QTextCodec::codecForName("UTF-8"));
+    os << DIDL_LITE_BEGIN;
+
     LOG(VB_UPNP, LOG_INFO,
         QString("UPnpCDS::HandleBrowse ObjectID=%1, ContainerId=%2")
             .arg(request.m_sObjectId) .arg(request.m_sContainerID));
@@ -361,7 +458,7 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
 
                 m_root.SetChildCount( m_extensions.count() );
 
-                sResultXML      = m_root.toXml(filter);
+                m_root.toXml(os, filter);
 
                 break;
             }
@@ -379,8 +476,8 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
                 if (request.m_nRequestedCount == 0)
                     request.m_nRequestedCount = nTotalMatches;
 
-                short nStart = Max( request.m_nStartingIndex, short( 0 ));
-                short nCount = Min( nTotalMatches, request.m_nRequestedCount );
+                int nStart = max( request.m_nStartingIndex, 0 );
+                int nCount = min( nTotalMatches, request.m_nRequestedCount );
 
                 UPnpCDSRequest       childRequest;
 
@@ -406,7 +503,7 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
                     {
                         if (pResult->m_eErrorCode == UPnPResult_Success)
                         {
-                            sResultXML  += pResult->GetResultXML(filter);
+                            pResult->GetResultXML(os, filter);
                             nNumberReturned ++;
                         }
 
@@ -444,8 +541,8 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
             {
                 nNumberReturned = pResult->m_List.count();
                 nTotalMatches   = pResult->m_nTotalMatches;
-                nUpdateID       = pResult->m_nUpdateID;
-                sResultXML      = pResult->GetResultXML(filter);
+                nUpdateID       = GetValue<unsigned short>("SystemUpdateID");
+                pResult->GetResultXML(os, filter);
             }
 
             delete pResult;
@@ -460,9 +557,7 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
     {
         NameValues list;
 
-        QString sResults = DIDL_LITE_BEGIN;
-        sResults += sResultXML;
-        sResults += DIDL_LITE_END;
+        os << DIDL_LITE_END << flush;
 
         list.push_back(NameValue("Result",         sResults));
         list.push_back(NameValue("NumberReturned", nNumberReturned));
@@ -487,10 +582,14 @@ void UPnpCDS::HandleSearch( HTTPRequest *pRequest )
 
     UPnPResultCode eErrorCode      = UPnPResult_InvalidAction;
     QString       sErrorDesc      = "";
-    short         nNumberReturned = 0;
-    short         nTotalMatches   = 0;
+    int           nNumberReturned = 0;
+    int           nTotalMatches   = 0;
     short         nUpdateID       = 0;
-    QString       sResultXML;
+
+    QString       sResults;
+    QTextStream   os( &sResults, QIODevice::WriteOnly );
+    os.setCodec(QTextCodec::codecForName("UTF-8"));
+    os << DIDL_LITE_BEGIN;
 
     DetermineClient( pRequest, &request );
     request.m_sObjectId         = pRequest->m_mapParams[ "ObjectID"      ];
@@ -583,8 +682,8 @@ void UPnpCDS::HandleSearch( HTTPRequest *pRequest )
             FilterMap filter =  (FilterMap) request.m_sFilter.split(',');
             nNumberReturned = pResult->m_List.count();
             nTotalMatches   = pResult->m_nTotalMatches;
-            nUpdateID       = pResult->m_nUpdateID;
-            sResultXML      = pResult->GetResultXML(filter);
+            nUpdateID       = GetValue<unsigned short>("SystemUpdateID");
+            pResult->GetResultXML(os, filter);
 #if 0
             bSearchDone = true;
 #endif
@@ -593,17 +692,11 @@ void UPnpCDS::HandleSearch( HTTPRequest *pRequest )
         delete pResult;
     }
 
-#if 0
-    nUpdateID       = 0;
-    LOG(VB_UPNP, LOG_DEBUG, sResultXML);
-#endif
-
     if (eErrorCode == UPnPResult_Success)
     {
         NameValues list;
-        QString sResults = DIDL_LITE_BEGIN;
-        sResults += sResultXML;
-        sResults += DIDL_LITE_END;
+
+        os << DIDL_LITE_END << flush;
 
         list.push_back(NameValue("Result",         sResults));
         list.push_back(NameValue("NumberReturned", nNumberReturned));
@@ -852,7 +945,7 @@ UPnpCDSExtensionResults *
     pResults->m_nTotalMatches   = 0;
     pResults->m_nUpdateID       = 1;
 
-    short nRootCount = GetRootCount();
+    int nRootCount = GetRootCount();
 
     switch( pRequest->m_eBrowseFlag )
     {
@@ -883,13 +976,13 @@ UPnpCDSExtensionResults *
             if ( pRequest->m_nRequestedCount == 0)
                 pRequest->m_nRequestedCount = nRootCount ;
 
-            short nStart = max(pRequest->m_nStartingIndex, short(0));
-            short nEnd   = min(nRootCount,
-                               short(nStart + pRequest->m_nRequestedCount));
+            int nStart = max(pRequest->m_nStartingIndex, 0);
+            int nEnd   = min(nRootCount,
+                             nStart + pRequest->m_nRequestedCount);
 
             if (nStart < nRootCount)
             {
-                for (short nIdx = nStart; nIdx < nEnd; nIdx++)
+                for (int nIdx = nStart; nIdx < nEnd; nIdx++)
                 {
                     UPnpCDSRootInfo *pInfo = GetRootInfo( nIdx );
                     if (pInfo != NULL)
@@ -1175,7 +1268,11 @@ UPnpCDSExtensionResults *
             pResults->m_nUpdateID     = 1;
 
             if (pRequest->m_nRequestedCount == 0)
-                pRequest->m_nRequestedCount = SHRT_MAX;
+                pRequest->m_nRequestedCount = INT_MAX;
+
+            // Nothing to fetch when a renderer pages past the end.
+            if (pRequest->m_nStartingIndex >= pResults->m_nTotalMatches)
+                break;
 
             MSqlQuery query(MSqlQuery::InitCon());
 
@@ -1231,72 +1328,94 @@ UPnpCDSExtensionResults *
 
 int UPnpCDSExtension::GetDistinctCount( UPnpCDSRootInfo *pInfo )
 {
-    int nCount = 0;
-
     if ((pInfo == NULL) || (pInfo->column == NULL))
         return 0;
 
-    MSqlQuery query(MSqlQuery::InitCon());
+    // Note: Tried to use Bind, however it would not allow me to use it
+    //       for column & table names
 
-    if (query.isConnected())
+    QString sSQL;
+
+    if (strncmp( pInfo->column, "*", 1) == 0)
     {
-        // Note: Tried to use Bind, however it would not allow me to use it
-        //       for column & table names
+        sSQL = QString( "SELECT count( %1 ) FROM %2" )
+                  .arg( pInfo->column )
+                  .arg( GetTableName( pInfo->column ));
+    }
+    else
+    {
+        sSQL = QString( "SELECT count( DISTINCT %1 ) FROM %2" )
+                  .arg( pInfo->column )
+                  .arg( GetTableName( pInfo->column ) );
+    }
 
-        QString sSQL;
+    return GetCachedCount( sSQL );
+}
 
-        if (strncmp( pInfo->column, "*", 1) == 0)
-        {
-            sSQL = QString( "SELECT count( %1 ) FROM %2" )
-                      .arg( pInfo->column )
-                      .arg( GetTableName( pInfo->column ));
-        }
-        else
-        {
-            sSQL = QString( "SELECT count( DISTINCT %1 ) FROM %2" )
-                      .arg( pInfo->column )
-                      .arg( GetTableName( pInfo->column ) );
-        }
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
 
-        query.prepare( sSQL );
+int UPnpCDSExtension::GetCount( const QString &sColumn, const QString &sKey )
+{
+    QString sSQL = QString("SELECT count( %1 ) FROM %2")
+                   .arg( sColumn ).arg( GetTableName( sColumn ) );
 
-        if (query.exec() && query.next())
-        {
-            nCount = query.value(0).toInt();
-        }
-    }
+    if ( sKey.length() )
+        sSQL += " WHERE " + sColumn + " = :KEY";
+
+    int nCount = GetCachedCount( sSQL, sKey );
+
+    LOG(VB_UPNP, LOG_DEBUG, "UPnpCDSExtension::GetCount() - " +
+                            sSQL + " = " + QString::number(nCount));
 
     return( nCount );
 }
 
 /////////////////////////////////////////////////////////////////////////////
-//
+// Runs a single value COUNT() query, binding sKey to :KEY when given.
+// Results are remembered until the next InvalidateCountCache() call,
+// unless the extension opts out through CacheCounts().
 /////////////////////////////////////////////////////////////////////////////
 
-int UPnpCDSExtension::GetCount( const QString &sColumn, const QString &sKey )
+int UPnpCDSExtension::GetCachedCount( const QString &sSQL,
+                                      const QString &sKey )
 {
+    bool    bCache    = CacheCounts();
+    QString sCacheKey = sKey.isEmpty() ? sSQL : sSQL + "\n:KEY=" + sKey;
+
+    if (bCache)
+    {
+        QMutexLocker locker(&m_countCacheLock);
+
+        QMap<QString, int>::const_iterator it = m_countCache.find(sCacheKey);
+        if (it != m_countCache.end())
+            return *it;
+    }
+
     int nCount = 0;
 
     MSqlQuery query(MSqlQuery::InitCon());
 
     if (query.isConnected())
     {
-        QString sSQL = QString("SELECT count( %1 ) FROM %2")
-                       .arg( sColumn ).arg( GetTableName( sColumn ) );
-
-        if ( sKey.length() )
-            sSQL += " WHERE " + sColumn + " = :KEY";
-
         query.prepare( sSQL );
         if ( sKey.length() )
             query.bindValue( ":KEY", sKey );
 
-        if (query.exec() && query.next())
+        if (!query.exec() || !query.next())
         {
-            nCount = query.value(0).toInt();
+            MythDB::DBError("UPnpCDSExtension::GetCachedCount", query);
+            return 0;
+        }
+
+        nCount = query.value(0).toInt();
+
+        if (bCache)
+        {
+            QMutexLocker locker(&m_countCacheLock);
+            m_countCache.insert(sCacheKey, nCount);
         }
-        LOG(VB_UPNP, LOG_DEBUG, "UPnpCDSExtension::GetCount() - " +
-                                sSQL + " = " + QString::number(nCount));
     }
 
     return( nCount );
@@ -1306,6 +1425,16 @@ int UPnpCDSExtension::GetCount( const QString &sColumn, const QString &sKey )
 //
 /////////////////////////////////////////////////////////////////////////////
 
+void UPnpCDSExtension::InvalidateCountCache()
+{
+    QMutexLocker locker(&m_countCacheLock);
+    m_countCache.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 void UPnpCDSExtension::CreateItems( UPnpCDSRequest          *pRequest,
                                     UPnpCDSExtensionResults *pResults,
                                     int                      nNodeIdx,
@@ -1324,7 +1453,11 @@ void UPnpCDSExtension::CreateItems( UPnpCDSRequest          *pRequest,
     pResults->m_nUpdateID     = 1;
 
     if (pRequest->m_nRequestedCount == 0)
-        pRequest->m_nRequestedCount = SHRT_MAX;
+        pRequest->m_nRequestedCount = INT_MAX;
+
+    // Nothing to fetch when a renderer pages past the end.
+    if (pRequest->m_nStartingIndex >= pResults->m_nTotalMatches)
+        return;
 
     MSqlQuery query(MSqlQuery::InitCon());
 
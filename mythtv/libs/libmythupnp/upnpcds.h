@@ -15,6 +15,7 @@
 
 #include <QList>
 #include <QMap>
+#include <QMutex>
 #include <QObject>
 
 #include "upnp.h"
@@ -71,8 +72,8 @@ class UPNP_PUBLIC UPnpCDSRequest
 
         QString           m_sContainerID;
         QString           m_sFilter;
-        short             m_nStartingIndex;
-        short             m_nRequestedCount;
+        int               m_nStartingIndex;
+        int               m_nRequestedCount;
         QString           m_sSortCriteria;
 
         // Browse specific properties
@@ -111,7 +112,7 @@ class UPNP_PUBLIC UPnpCDSExtensionResults
         UPnPResultCode          m_eErrorCode;
         QString                 m_sErrorDesc;
 
-        short                   m_nTotalMatches;
+        int                     m_nTotalMatches;
         short                   m_nUpdateID;
 
     public:
@@ -132,6 +133,7 @@ class UPNP_PUBLIC UPnpCDSExtensionResults
 
         void    Add         ( CDSObject *pObject );
         QString GetResultXML(FilterMap &filter);
+        void    GetResultXML(QTextStream &os, FilterMap &filter);
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -154,8 +156,23 @@ class UPNP_PUBLIC UPnpCDSExtension
         QString     m_sName;
         QString     m_sClass;
 
+    private:
+
+        // Cache of COUNT() query results keyed by SQL & bound key.
+        // Flushed by InvalidateCountCache() whenever the SystemUpdateID
+        // changes, so deep paging doesn't re-run the GROUP BY counts.
+
+        QMutex              m_countCacheLock;
+        QMap<QString, int>  m_countCache;
+
     protected:
 
+        int     GetCachedCount( const QString &sSQL, const QString &sKey = "" );
+
+        // Extensions whose tables change without a list change event
+        // being sent should return false so their counts stay live.
+        virtual bool CacheCounts() const { return true; }
+
         QString RemoveToken ( const QString &sToken, const QString &sStr, int num );
 
         virtual UPnpCDSExtensionResults *ProcessRoot     ( UPnpCDSRequest          *pRequest, 
@@ -224,6 +241,8 @@ class UPNP_PUBLIC UPnpCDSExtension
 
         virtual ~UPnpCDSExtension() {}
 
+        void InvalidateCountCache();
+
         virtual UPnpCDSExtensionResults *Browse( UPnpCDSRequest *pRequest );
         virtual UPnpCDSExtensionResults *Search( UPnpCDSRequest *pRequest );
 
@@ -251,6 +270,8 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         QString                m_sServiceDescFileName;
         QString                m_sControlUrl;
 
+        int                    m_nUpdateIDTimerId;
+
     private:
 
         UPnpCDSMethod       GetMethod              ( const QString &sURI  );
@@ -262,9 +283,13 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         void            HandleGetSortCapabilities  ( HTTPRequest *pRequest );
         void            HandleGetSystemUpdateID    ( HTTPRequest *pRequest );
         void            DetermineClient            ( HTTPRequest *pRequest, UPnpCDSRequest *pCDSRequest );
+        void            IncrementSystemUpdateID    ( void );
 
     protected:
 
+        virtual void customEvent( QEvent *e );
+        virtual void timerEvent ( QTimerEvent *e );
+
         // Implement UPnpServiceImpl methods that we can
 
         virtual QString GetServiceType      () { return "urn:schemas-upnp-org:service:ContentDirectory:1"; }
@@ -289,7 +289,6 @@ void CDSObject::toXml(QTextStream &os, FilterMap &filter) const
     // ----------------------------------------------------------------------
 
     os << sEndTag;
-    os << flush;
 }
 
 
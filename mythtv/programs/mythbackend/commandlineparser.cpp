@@ -18,6 +18,7 @@ void MythBackendCommandLineParser::LoadArguments(void)
     addSettingsOverride();
     addUPnP();
     addLogging();
+    addStartupTrace();
     addPIDFile();
 
     CommandLineArg::AllowOneOf(QList<CommandLineArg*>()
@@ -23,6 +23,7 @@
 #include "backendcontext.h"
 #include "main_helpers.h"
 #include "mythmiscutil.h"
+#include "mythstartuptimer.h"
 #include "storagegroup.h"
 #include "housekeeper.h"
 #include "mediaserver.h"
@@ -73,6 +74,8 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_OK;
     }
 
+    MythStartupTimer::Enable(cmdline.toBool("startuptrace"));
+
 #ifndef _WIN32
     for (int i = UNUSED_FILENO; i < sysconf(_SC_OPEN_MAX) - 1; ++i)
         close(i);
@@ -98,6 +101,8 @@ int main(int argc, char **argv)
         // Don't listen to console input if daemonized
         close(0);
 
+    MythStartupTimer::Mark("Application and logging");
+
     CleanupGuard callCleanup(cleanup);
 
 #ifndef _WIN32
@@ -115,6 +120,8 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_NO_MYTHCONTEXT;
     }
 
+    MythStartupTimer::Mark("MythContext");
+
     setHttpProxy();
 
     cmdline.ApplySettingsOverride();
@@ -17,6 +17,7 @@
 #include <cerrno>
 
 #include <QCoreApplication>
+#include <QRunnable>
 #include <QFileInfo>
 #include <QRegExp>
 #include <QFile>
@@ -50,7 +51,9 @@
 #include "backendcontext.h"
 #include "mythtranslation.h"
 #include "mythtimezone.h"
+#include "mythstartuptimer.h"
 #include "signalhandling.h"
+#include "mthreadpool.h"
 
 #include "mediaserver.h"
 #include "httpstatus.h"
@@ -530,6 +533,18 @@ void print_warnings(const MythBackendCommandLineParser &cmdline)
     }
 }
 
+/// Checks the storage group directories off the main thread, since the
+/// check only logs problems and may touch slow or sleeping disks.
+class StorageGroupDirCheck : public QRunnable
+{
+  public:
+    virtual void run(void)
+    {
+        MythStartupTimer timer("Storage group directory check");
+        StorageGroup::CheckAllStorageGroupDirs();
+    }
+};
+
 int run_backend(MythBackendCommandLineParser &cmdline)
 {
     if (!DBUtil::CheckTimeZoneSupport())
@@ -549,6 +564,8 @@ int run_backend(MythBackendCommandLineParser &cmdline)
         return GENERIC_EXIT_DB_OUTOFDATE;
     }
 
+    MythStartupTimer::Mark("Schema check");
+
     MythTranslation::load("mythfrontend");
 
     if (!ismaster)
@@ -556,6 +573,7 @@ int run_backend(MythBackendCommandLineParser &cmdline)
         int ret = connect_to_master();
         if (ret != GENERIC_EXIT_OK)
             return ret;
+        MythStartupTimer::Mark("Connect to master");
     }
 
     int     port = gCoreContext->GetNumSetting("BackendServerPort", 6543);
@@ -589,6 +607,8 @@ int run_backend(MythBackendCommandLineParser &cmdline)
         return GENERIC_EXIT_SETUP_ERROR;
     }
 
+    MythStartupTimer::Mark("Capture cards");
+
     Scheduler *sched = NULL;
     if (ismaster)
     {
@@ -622,6 +642,8 @@ int run_backend(MythBackendCommandLineParser &cmdline)
     if (!cmdline.toBool("nojobqueue"))
         jobqueue = new JobQueue(ismaster);
 
+    MythStartupTimer::Mark("Scheduler, housekeeper, expirer and job queue");
+
     // ----------------------------------------------------------------------
     //
     // ----------------------------------------------------------------------
@@ -633,6 +655,8 @@ int run_backend(MythBackendCommandLineParser &cmdline)
         g_pUPnp->Init(ismaster, cmdline.toBool("noupnp"));
     }
 
+    MythStartupTimer::Mark("UPnP");
+
     // ----------------------------------------------------------------------
     // Setup status server
     // ----------------------------------------------------------------------
@@ -663,11 +687,16 @@ int run_backend(MythBackendCommandLineParser &cmdline)
     if (httpStatus && mainServer)
         httpStatus->SetMainServer(mainServer);
 
-    StorageGroup::CheckAllStorageGroupDirs();
+    MythStartupTimer::Mark("Main server");
+
+    MThreadPool::globalInstance()->start(
+        new StorageGroupDirCheck(), "StorageGroupDirCheck");
 
     if (gCoreContext->IsMasterBackend())
         gCoreContext->SendSystemEvent("MASTER_STARTED");
 
+    MythStartupTimer::Mark("Ready");
+
     ///////////////////////////////
     ///////////////////////////////
     exitCode = qApp->exec();
@@ -71,6 +71,7 @@ using namespace std;
 #include "videoutils.h"
 #include "mythlogging.h"
 #include "filesysteminfo.h"
+#include "services/serviceUtil.h"
 
 /** Milliseconds to wait for an existing thread from
  *  process request thread pool.
@@ -833,6 +834,14 @@ void MainServer::customEvent(QEvent *e)
 
         QString message = me->Message();
         QString error;
+
+        // Services API results shared between requests depend on these.
+        if (message.startsWith("RECORDING_LIST_CHANGE") ||
+            message == "SCHEDULE_CHANGE")
+        {
+            IncrementContentGeneration();
+        }
+
         if ((message == "PREVIEW_SUCCESS" || message == "PREVIEW_QUEUED") &&
             me->ExtraDataCount() >= 5)
         {
@@ -1068,7 +1077,16 @@ void MainServer::customEvent(QEvent *e)
         }
 
         if (me->Message() == "CLEAR_SETTINGS_CACHE")
-            gCoreContext->ClearSettingsCache();
+        {
+            QStringList keys = me->ExtraDataList();
+            if (keys.empty() || keys[0] == "empty")
+                gCoreContext->ClearSettingsCache();
+            else
+            {
+                for (int i = 0; i < keys.size(); ++i)
+                    gCoreContext->ClearSettingsCache(keys[i]);
+            }
+        }
 
         if (me->Message().left(14) == "RESET_IDLETIME" && m_sched)
             m_sched->ResetIdleTime();
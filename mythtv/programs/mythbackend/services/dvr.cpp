@@ -25,6 +25,8 @@
 
 #include <QMap>
 #include <QRegExp>
+#include <QMutex>
+#include <QTime>
 
 #include "dvr.h"
 
@@ -45,6 +47,30 @@
 extern QMap<int, EncoderLink *> tvList;
 extern AutoExpire  *expirer;
 
+// Recorded list shared by GetRecordedList/GetFilteredRecordedList calls.
+// The list is always held in ascending start time order.
+
+class RecordedListCache
+{
+  public:
+    RecordedListCache() : m_nGeneration(0) {}
+
+    bool IsValid(void) const
+    {
+        return m_nGeneration == GetContentGeneration() &&
+               m_loaded.elapsed() < kMaxAgeMS;
+    }
+
+    static const int kMaxAgeMS = 60 * 1000;
+
+    QMutex       m_lock;
+    uint         m_nGeneration;
+    QTime        m_loaded;
+    ProgramList  m_list;
+};
+
+static RecordedListCache s_recListCache;
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -64,26 +90,40 @@ DTC::ProgramList* Dvr::GetFilteredRecordedList( bool           bDescending,
                                                 const QString &sRecGroup,
                                                 const QString &sStorageGroup )
 {
-    QMap< QString, ProgramInfo* > recMap;
+    // ----------------------------------------------------------------------
+    // Loading the recorded list is by far the most expensive part of this
+    // call, and clients page through it (or poll it) far more often than it
+    // changes, so the loaded list is shared between requests until the
+    // content generation changes or it gets too old to trust the in-use
+    // and job flags.
+    // ----------------------------------------------------------------------
+
+    QMutexLocker locker( &s_recListCache.m_lock );
+
+    if (!s_recListCache.IsValid())
+    {
+        QMap< QString, ProgramInfo* > recMap;
 
-    if (gCoreContext->GetScheduler())
-        recMap = gCoreContext->GetScheduler()->GetRecording();
+        if (gCoreContext->GetScheduler())
+            recMap = gCoreContext->GetScheduler()->GetRecording();
 
-    QMap< QString, uint32_t > inUseMap    = ProgramInfo::QueryInUseMap();
-    QMap< QString, bool >     isJobRunning= ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
+        QMap< QString, uint32_t > inUseMap    = ProgramInfo::QueryInUseMap();
+        QMap< QString, bool >     isJobRunning= ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
 
-    ProgramList progList;
+        s_recListCache.m_nGeneration = GetContentGeneration();
+        s_recListCache.m_loaded.start();
 
-    int desc = 0;
-    if (bDescending)
-        desc = -1;
+        LoadFromRecorded( s_recListCache.m_list, false, inUseMap,
+                          isJobRunning, recMap, 1 );
 
-    LoadFromRecorded( progList, false, inUseMap, isJobRunning, recMap, desc );
+        QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
 
-    QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
+        for (; mit != recMap.end(); mit = recMap.erase(mit))
+            delete *mit;
+    }
 
-    for (; mit != recMap.end(); mit = recMap.erase(mit))
-        delete *mit;
+    const ProgramList &progList = s_recListCache.m_list;
+    int                nSize    = progList.size();
 
     // ----------------------------------------------------------------------
     // Build Response
@@ -92,20 +132,22 @@ DTC::ProgramList* Dvr::GetFilteredRecordedList( bool           bDescending,
     DTC::ProgramList *pPrograms = new DTC::ProgramList();
     int nAvailable = 0;
 
+    nStartIndex = max( nStartIndex, 0 );
+
     if ((sTitleRegEx.isEmpty()) &&
         (sRecGroup.isEmpty()) &&
         (sStorageGroup.isEmpty()))
     {
-        nStartIndex   = min( nStartIndex, (int)progList.size() );
-        nCount        = (nCount > 0) ? min( nCount, (int)progList.size() ) : progList.size();
-        int nEndIndex = min((nStartIndex + nCount), (int)progList.size() );
+        nStartIndex   = min( nStartIndex, nSize );
+        nCount        = (nCount > 0) ? min( nCount, nSize ) : nSize;
+        int nEndIndex = min((nStartIndex + nCount), nSize );
         nCount        = nEndIndex - nStartIndex;
 
-        nAvailable = progList.size();
+        nAvailable = nSize;
 
         for( int n = nStartIndex; n < nEndIndex; n++)
         {
-            ProgramInfo *pInfo = progList[ n ];
+            ProgramInfo *pInfo = progList[ bDescending ? nSize - 1 - n : n ];
             if (pInfo->GetRecordingGroup() != "Deleted")
             {
                 DTC::Program *pProgram = pPrograms->AddNewProgram();
@@ -123,19 +165,17 @@ DTC::ProgramList* Dvr::GetFilteredRecordedList( bool           bDescending,
 
         QRegExp rTitleRegEx        = QRegExp(sTitleRegEx, Qt::CaseInsensitive);
 
-        for( unsigned int n = 0; n < progList.size(); n++)
+        for( int n = 0; n < nSize; n++)
         {
-            ProgramInfo *pInfo = progList[ n ];
+            ProgramInfo *pInfo = progList[ bDescending ? nSize - 1 - n : n ];
 
-            if ((!sTitleRegEx.isEmpty() && !pInfo->GetTitle().contains(rTitleRegEx)) ||
-                (!sRecGroup.isEmpty() && sRecGroup != pInfo->GetRecordingGroup()) ||
-                (!sStorageGroup.isEmpty() && sStorageGroup != pInfo->GetStorageGroup()))
+            if ((!sRecGroup.isEmpty() && sRecGroup != pInfo->GetRecordingGroup()) ||
+                (!sStorageGroup.isEmpty() && sStorageGroup != pInfo->GetStorageGroup()) ||
+                (!sTitleRegEx.isEmpty() && !pInfo->GetTitle().contains(rTitleRegEx)))
                 continue;
 
-            ++nAvailable;
-
-            if ((nAvailable < nStartIndex) ||
-                (nCount >= nMax))
+            if ((nAvailable++ < nStartIndex) ||
+                ((nMax > 0) && (nCount >= nMax)))
                 continue;
 
             ++nCount;
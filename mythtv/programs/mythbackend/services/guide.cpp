@@ -25,6 +25,11 @@
 
 #include <math.h>
 
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTime>
+
 #include "guide.h"
 
 #include "compat.h"
@@ -33,10 +38,105 @@
 #include "scheduler.h"
 #include "autoexpire.h"
 #include "channelutil.h"
+#include "serviceUtil.h"
 
 extern AutoExpire  *expirer;
 extern Scheduler   *sched;
 
+// Pending schedule and recently requested guide pages, shared between
+// requests.  Everything is dropped once the content generation changes
+// (new schedule or recordings) or the data gets too old.  Lists are
+// handed out as shared pointers so requests can use them without holding
+// the lock while another request replaces or evicts them.
+
+typedef QSharedPointer<ProgramList> ProgramListPtr;
+
+class GuideCache
+{
+  public:
+    GuideCache() : m_nGeneration(0) {}
+
+    // Returns the pending schedule and the generation it belongs to
+    ProgramListPtr GetSchedule(uint &nGeneration)
+    {
+        QMutexLocker locker(&m_lock);
+
+        Validate();
+
+        nGeneration = m_nGeneration;
+        return m_pSchedList;
+    }
+
+    // Returns a cached guide page, or NULL along with the schedule needed
+    // to build it
+    ProgramListPtr GetGuide(const QString &sKey, ProgramListPtr &pSchedList,
+                            uint &nGeneration)
+    {
+        QMutexLocker locker(&m_lock);
+
+        Validate();
+
+        pSchedList  = m_pSchedList;
+        nGeneration = m_nGeneration;
+
+        ProgramListPtr pProgList = m_guides.value(sKey);
+        if (pProgList)
+        {
+            m_guideOrder.removeOne(sKey);
+            m_guideOrder.append(sKey);
+        }
+
+        return pProgList;
+    }
+
+    // Remembers a page built from the schedule of nGeneration, evicting
+    // the least recently used page when full
+    void AddGuide(const QString &sKey, ProgramListPtr pProgList,
+                  uint nGeneration)
+    {
+        QMutexLocker locker(&m_lock);
+
+        if (nGeneration != m_nGeneration || m_guides.contains(sKey))
+            return;
+
+        while (m_guides.size() >= kMaxGuides && !m_guideOrder.isEmpty())
+            m_guides.remove(m_guideOrder.takeFirst());
+
+        m_guides.insert(sKey, pProgList);
+        m_guideOrder.append(sKey);
+    }
+
+  private:
+    void Validate(void)
+    {
+        if (m_pSchedList && m_nGeneration == GetContentGeneration() &&
+            m_loaded.elapsed() < kMaxAgeMS)
+            return;
+
+        m_guides.clear();
+        m_guideOrder.clear();
+
+        bool hasConflicts;
+        m_pSchedList = ProgramListPtr(new ProgramList());
+        LoadFromScheduler(*m_pSchedList, hasConflicts);
+
+        m_nGeneration = GetContentGeneration();
+        m_loaded.start();
+    }
+
+    static const int kMaxAgeMS   = 5 * 60 * 1000;
+    static const int kMaxGuides  = 16;
+
+    QMutex                          m_lock;
+    uint                            m_nGeneration;
+    QTime                           m_loaded;
+    ProgramListPtr                  m_pSchedList;
+    QMap<QString, ProgramListPtr>   m_guides;
+    QStringList                     m_guideOrder; ///< least recent first
+};
+
+static GuideCache s_guideCache;
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -83,41 +183,64 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
     query.last();   nEndChanId   = query.value(0).toInt();
 
     // ----------------------------------------------------------------------
-    // Build SQL statement for Program Listing
+    // Reuse the listing if the same page was requested since the last
+    // schedule change.  Otherwise build it without holding the cache lock,
+    // so other requests aren't held up by the program query.
     // ----------------------------------------------------------------------
 
-    ProgramList  progList;
-    ProgramList  schedList;
-    MSqlBindings bindings;
+    QString sKey = QString( "%1 %2 %3 %4" )
+                      .arg( dtStartTime.toString( Qt::ISODate ))
+                      .arg( dtEndTime.toString( Qt::ISODate ))
+                      .arg( nStartChanId ).arg( nEndChanId );
 
-    QString      sSQL = "WHERE program.chanid >= :StartChanId "
-                         "AND program.chanid <= :EndChanId "
-                         "AND program.endtime >= :StartDate "
-                         "AND program.starttime <= :EndDate "
-                        "GROUP BY program.starttime, channel.channum, "
-                         "channel.callsign, program.title "
-                        "ORDER BY program.chanid ";
+    ProgramListPtr pSchedList;
+    uint           nGeneration;
+    ProgramListPtr pProgList = s_guideCache.GetGuide( sKey, pSchedList,
+                                                      nGeneration );
 
-    bindings[":StartChanId"] = nStartChanId;
-    bindings[":EndChanId"  ] = nEndChanId;
-    bindings[":StartDate"  ] = dtStartTime;
-    bindings[":EndDate"    ] = dtEndTime;
+    if (!pProgList)
+    {
+        // ------------------------------------------------------------------
+        // Build SQL statement for Program Listing
+        // ------------------------------------------------------------------
 
-    // ----------------------------------------------------------------------
-    // Get all Pending Scheduled Programs
-    // ----------------------------------------------------------------------
+        MSqlBindings bindings;
 
-    bool hasConflicts;
-    LoadFromScheduler(schedList, hasConflicts);
+        QString      sSQL = "WHERE program.chanid >= :StartChanId "
+                             "AND program.chanid <= :EndChanId "
+                             "AND program.endtime >= :StartDate "
+                             "AND program.starttime <= :EndDate "
+                            "GROUP BY program.starttime, channel.channum, "
+                             "channel.callsign, program.title "
+                            "ORDER BY program.chanid ";
 
-    // ----------------------------------------------------------------------
+        bindings[":StartChanId"] = nStartChanId;
+        bindings[":EndChanId"  ] = nEndChanId;
+        bindings[":StartDate"  ] = dtStartTime;
+        bindings[":EndDate"    ] = dtEndTime;
 
-    LoadFromProgram( progList, sSQL, bindings, schedList );
+        pProgList = ProgramListPtr( new ProgramList() );
 
-    // ----------------------------------------------------------------------
-    // Build Response
-    // ----------------------------------------------------------------------
+        LoadFromProgram( *pProgList, sSQL, bindings, *pSchedList );
+
+        s_guideCache.AddGuide( sKey, pProgList, nGeneration );
+    }
 
+    return BuildProgramGuide( *pProgList, dtStartTime, dtEndTime,
+                              nStartChanId, nEndChanId, bDetails );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+DTC::ProgramGuide *Guide::BuildProgramGuide( const ProgramList &progList,
+                                             const QDateTime   &dtStartTime,
+                                             const QDateTime   &dtEndTime,
+                                             int                nStartChanId,
+                                             int                nEndChanId,
+                                             bool               bDetails )
+{
     DTC::ProgramGuide *pGuide = new DTC::ProgramGuide();
 
     int               nChanCount = 0;
@@ -191,15 +314,11 @@ DTC::Program* Guide::GetProgramDetails( int              nChanId,
 
     // Get all Pending Scheduled Programs
 
-    ProgramList  schedList;
-    bool hasConflicts;
-    LoadFromScheduler(schedList, hasConflicts);
-
-    // ----------------------------------------------------------------------
-
-    ProgramList progList;
+    ProgramList    progList;
+    uint           nGeneration;
+    ProgramListPtr pSchedList = s_guideCache.GetSchedule( nGeneration );
 
-    LoadFromProgram( progList, sSQL, bindings, schedList );
+    LoadFromProgram( progList, sSQL, bindings, *pSchedList );
 
     if ( progList.size() == 0)
         throw( "Error Reading Program Info" );
@@ -43,6 +43,15 @@ class Guide : public GuideServices
     
         Q_INVOKABLE Guide( QObject *parent = 0 ) {}
 
+    protected:
+
+        DTC::ProgramGuide*  BuildProgramGuide   ( const ProgramList &progList,
+                                                  const QDateTime   &dtStartTime,
+                                                  const QDateTime   &dtEndTime,
+                                                  int                nStartChanId,
+                                                  int                nEndChanId,
+                                                  bool               bDetails );
+
     public:
 
         
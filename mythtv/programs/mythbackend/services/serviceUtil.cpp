@@ -24,6 +24,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include <QUrl>
+#include <QAtomicInt>
 
 #include "serviceUtil.h"
 
@@ -358,3 +359,23 @@ void FillVideoMetadataInfo (
         }
     }
 }
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+static QAtomicInt s_contentGeneration(1);
+
+uint GetContentGeneration( void )
+{
+    return (uint)(int)s_contentGeneration;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void IncrementContentGeneration( void )
+{
+    s_contentGeneration.fetchAndAddOrdered(1);
+}
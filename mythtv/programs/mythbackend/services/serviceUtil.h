@@ -55,4 +55,11 @@ void FillVideoMetadataInfo (
                       DTC::VideoMetadataInfo *pVideoMetadataInfo,
                       VideoMetadataListManager::VideoMetadataPtr pMetadata,
                       bool          bDetails);
+
+// Bumped whenever recordings or the schedule change; services use it to
+// decide when results shared between requests have gone stale.
+
+uint GetContentGeneration      ( void );
+void IncrementContentGeneration( void );
+
 #endif
@@ -28,6 +28,10 @@ class UPnpCDSMusic : public UPnpCDSExtension
 
     protected:
 
+        // The music scanner doesn't announce library changes, so cached
+        // counts would hide newly scanned tracks until a restart.
+        virtual bool             CacheCounts() const { return false; }
+
         virtual bool             IsBrowseRequestForUs( UPnpCDSRequest *pRequest );
         virtual bool             IsSearchRequestForUs( UPnpCDSRequest *pRequest );
 
@@ -213,18 +213,7 @@ bool UPnpCDSVideo::IsSearchRequestForUs( UPnpCDSRequest *pRequest )
 
 int UPnpCDSVideo::GetDistinctCount( UPnpCDSRootInfo *pInfo )
 {
-    int nCount = 0;
-
-    MSqlQuery query(MSqlQuery::InitCon());
-
-    query.prepare("SELECT COUNT(*) FROM videometadata");
-
-    if (query.exec() && query.next())
-    {
-        nCount = query.value(0).toInt();
-    }
-
-    return nCount;
+    return GetCachedCount( "SELECT COUNT(*) FROM videometadata" );
 }
 
 
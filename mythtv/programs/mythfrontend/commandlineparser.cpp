@@ -21,6 +21,7 @@ void MythFrontendCommandLineParser::LoadArguments(void)
     addDisplay();
     addUPnP();
     addLogging();
+    addStartupTrace();
 
     add(QStringList( QStringList() << "-r" << "--reset" ), "reset", false,
         "Resets appearance, settings, and language.", "");
@@ -12,11 +12,13 @@ using namespace std;
 #include <QCoreApplication>
 #include <QKeyEvent>
 #include <QDateTime>
+#include <QRunnable>
 
 // myth
 #include "mythcorecontext.h"
 #include "mythdbcon.h"
 #include "mythlogging.h"
+#include "mthreadpool.h"
 #include "dbchannelinfo.h"
 #include "programinfo.h"
 #include "recordingrule.h"
@@ -38,6 +40,9 @@ QWaitCondition epgIsVisibleCond;
 #define LOC_ERR  QString("GuideGrid, Error: ")
 #define LOC_WARN QString("GuideGrid, Warning: ")
 
+/// How long to gather GUIDE_TILES_LOADED events before refilling rows
+const int kLoadedTilesDelay = 100; // ms
+
 const QString kUnknownTitle = QObject::tr("Unknown");
 const QString kUnknownCategory = QObject::tr("Unknown");
 
@@ -164,6 +169,281 @@ bool JumpToChannel::Update(void)
     }
 }
 
+/// Loads one time window of guide data for a set of channels
+class GuideTileLoader : public QRunnable
+{
+  public:
+    GuideTileLoader(GuideDataCache *cache, uint tile,
+                    const GuideChannelMap &channels, uint generation) :
+        m_cache(cache), m_tile(tile), m_channels(channels),
+        m_generation(generation)
+    {
+    }
+
+    void run(void)
+    {
+        m_cache->LoaderDone(
+            m_cache->LoadTile(m_tile, m_channels, m_generation));
+    }
+
+  private:
+    GuideDataCache  *m_cache;
+    uint             m_tile;
+    GuideChannelMap  m_channels;
+    uint             m_generation;
+};
+
+GuideDataCache::GuideDataCache(QObject *listener) :
+    m_listener(listener), m_generation(1), m_loaders(0),
+    m_schedGeneration(0)
+{
+}
+
+GuideDataCache::~GuideDataCache()
+{
+    QMutexLocker locker(&m_lock);
+
+    m_listener = NULL;
+    while (m_loaders)
+        m_loadersDone.wait(&m_lock);
+
+    QHash<quint64, GuideTile*>::iterator it = m_tiles.begin();
+    for (; it != m_tiles.end(); ++it)
+        delete *it;
+    m_tiles.clear();
+    m_lru.clear();
+}
+
+/** \fn GuideDataCache::GetPrograms(uint, const QDateTime&, const QDateTime&, ProgramList&)
+ *  \brief Appends copies of the cached programs on a channel between
+ *         start and end to proglist.
+ *  \return true if every tile covering the time span was present and
+ *          up to date, false if some are still to be loaded.
+ */
+bool GuideDataCache::GetPrograms(uint chanid, const QDateTime &start,
+                                 const QDateTime &end, ProgramList &proglist)
+{
+    QMutexLocker locker(&m_lock);
+
+    bool complete = true;
+    QDateTime laststart;
+    uint last = TileIndex(end);
+    for (uint tile = TileIndex(start); tile <= last; ++tile)
+    {
+        quint64 key = TileKey(chanid, tile);
+        QHash<quint64, GuideTile*>::iterator it = m_tiles.find(key);
+        if (it == m_tiles.end())
+        {
+            complete = false;
+            continue;
+        }
+
+        if ((*it)->m_generation != m_generation)
+            complete = false;
+
+        m_lru.removeOne(key);
+        m_lru.prepend(key);
+
+        // Programs crossing a tile boundary are in both tiles
+        ProgramList::const_iterator pit = (*it)->m_programs.begin();
+        for (; pit != (*it)->m_programs.end(); ++pit)
+        {
+            const ProgramInfo *pginfo = *pit;
+            if (pginfo->GetScheduledEndTime() < start ||
+                pginfo->GetScheduledStartTime() > end)
+                continue;
+            if (laststart.isValid() &&
+                pginfo->GetScheduledStartTime() <= laststart)
+                continue;
+
+            proglist.push_back(new ProgramInfo(*pginfo));
+            laststart = pginfo->GetScheduledStartTime();
+        }
+    }
+
+    return complete;
+}
+
+/** \fn GuideDataCache::Request(const GuideChannelMap&, const QDateTime&, const QDateTime&)
+ *  \brief Starts background loads for any missing or stale tiles
+ *         covering the channels between start and end.
+ */
+void GuideDataCache::Request(const GuideChannelMap &channels,
+                             const QDateTime &start, const QDateTime &end)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_listener)
+        return;
+
+    uint last = TileIndex(end);
+    for (uint tile = TileIndex(start); tile <= last; ++tile)
+    {
+        GuideChannelMap missing;
+        GuideChannelMap::const_iterator it = channels.begin();
+        for (; it != channels.end(); ++it)
+        {
+            quint64 key = TileKey(it.key(), tile);
+            if (m_pending.contains(key))
+                continue;
+
+            QHash<quint64, GuideTile*>::const_iterator tit = m_tiles.find(key);
+            if (tit != m_tiles.end() && (*tit)->m_generation == m_generation)
+                continue;
+
+            missing[it.key()] = *it;
+            m_pending.insert(key);
+        }
+
+        if (missing.empty())
+            continue;
+
+        m_loaders++;
+        MThreadPool::globalInstance()->start(
+            new GuideTileLoader(this, tile, missing, m_generation),
+            "GuideTileLoader");
+    }
+}
+
+/** \fn GuideDataCache::Load(const GuideChannelMap&, const QDateTime&, const QDateTime&)
+ *  \brief Loads the tiles covering the channels between start and end
+ *         in the calling thread.
+ */
+void GuideDataCache::Load(const GuideChannelMap &channels,
+                          const QDateTime &start, const QDateTime &end)
+{
+    m_lock.lock();
+    uint generation = m_generation;
+    m_lock.unlock();
+
+    uint last = TileIndex(end);
+    for (uint tile = TileIndex(start); tile <= last; ++tile)
+        LoadTile(tile, channels, generation);
+}
+
+/** \fn GuideDataCache::Invalidate(void)
+ *  \brief Marks every tile as stale and reloads the schedule before the
+ *         next query, so recording status is picked up again.
+ */
+void GuideDataCache::Invalidate(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_generation++;
+}
+
+/** \fn GuideDataCache::LoadTile(uint, const GuideChannelMap&, uint)
+ *  \brief Loads one time window for the channels into the cache.
+ *  \return The keys of the tiles loaded.
+ */
+QStringList GuideDataCache::LoadTile(uint tile,
+                                     const GuideChannelMap &channels,
+                                     uint generation)
+{
+    QStringList keys;
+    if (channels.empty())
+        return keys;
+
+    QDateTime tilestart = MythDate::fromTime_t(tile * kTileSecs);
+    QDateTime tileend   = tilestart.addSecs(kTileSecs);
+
+    QStringList chanids;
+    QHash<QString, uint> chanbynum;
+    QHash<uint, GuideTile*> tiles;
+    GuideChannelMap::const_iterator it = channels.begin();
+    for (; it != channels.end(); ++it)
+    {
+        chanids << QString::number(it.key());
+        chanbynum[*it] = it.key();
+        tiles[it.key()] = new GuideTile(generation);
+    }
+
+    QTime timer;
+    timer.start();
+
+    ProgramList proglist;
+    {
+        QMutexLocker locker(&m_schedLock);
+
+        if (m_schedGeneration < generation)
+        {
+            LoadFromScheduler(m_schedList);
+            m_schedGeneration = generation;
+        }
+
+        MSqlBindings bindings;
+        QString querystr = QString(
+            "WHERE program.chanid IN (%1) "
+            "  AND program.endtime >= :STARTTS "
+            "  AND program.starttime <= :ENDTS "
+            "  AND program.manualid = 0 ").arg(chanids.join(","));
+        bindings[":STARTTS"] = tilestart;
+        bindings[":ENDTS"]   = tileend;
+
+        LoadFromProgram(proglist, querystr, bindings, m_schedList);
+    }
+
+    // Hand the programs over to the per channel tiles
+    proglist.setAutoDelete(false);
+    ProgramList::iterator pit = proglist.begin();
+    for (; pit != proglist.end(); ++pit)
+    {
+        // A program which is recording elsewhere has its chanid
+        // replaced by the recording channel's, fall back to channum.
+        uint chanid = (*pit)->GetChanID();
+        if (!tiles.contains(chanid))
+            chanid = chanbynum.value((*pit)->GetChanNum(), 0);
+
+        if (tiles.contains(chanid))
+            tiles[chanid]->m_programs.push_back(*pit);
+        else
+            delete *pit;
+    }
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Loaded guide data for %1 channels from %2 in %3 ms")
+            .arg(channels.size())
+            .arg(MythDate::toString(tilestart, MythDate::kDateTimeShort))
+            .arg(timer.elapsed()));
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<uint, GuideTile*>::iterator tit = tiles.begin();
+    for (; tit != tiles.end(); ++tit)
+    {
+        quint64 key = TileKey(tit.key(), tile);
+        m_pending.remove(key);
+        keys << QString::number(key);
+
+        GuideTile *old = m_tiles.value(key, NULL);
+        if (old)
+        {
+            delete old;
+            m_lru.removeOne(key);
+        }
+        m_tiles[key] = *tit;
+        m_lru.prepend(key);
+    }
+
+    while (m_lru.size() > kMaxTiles)
+        delete m_tiles.take(m_lru.takeLast());
+
+    return keys;
+}
+
+void GuideDataCache::LoaderDone(const QStringList &keys)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_listener && !keys.empty())
+    {
+        QCoreApplication::postEvent(
+            m_listener, new MythEvent("GUIDE_TILES_LOADED", keys));
+    }
+
+    m_loaders--;
+    m_loadersDone.wakeAll();
+}
+
 void GuideGrid::RunProgramGuide(uint chanid, const QString &channum,
                     TV *player, bool embedVideo, bool allowFinder, int changrpid)
 {
@@ -223,6 +503,9 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
                      bool allowFinder, int changrpid)
          : ScheduleCommon(parent, "guidegrid"),
     m_allowFinder(allowFinder),
+    m_guideCache(new GuideDataCache(this)),
+    m_pageWaiting(false),
+    m_loadedTilesTimer(new QTimer(this)),
     m_player(player),
     m_usingNullVideo(false), m_embedVideo(embedVideo),
     m_previewVideoRefreshTimer(new QTimer(this)),
@@ -233,6 +516,10 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
     connect(m_previewVideoRefreshTimer, SIGNAL(timeout()),
             this,                     SLOT(refreshVideo()));
 
+    m_loadedTilesTimer->setSingleShot(true);
+    connect(m_loadedTilesTimer, SIGNAL(timeout()),
+            this,               SLOT(refillLoadedRows()));
+
     m_channelCount = 5;
     m_timeCount = 30;
     m_currentStartChannel = 0;
@@ -309,27 +596,15 @@ bool GuideGrid::Create()
 
 void GuideGrid::Load(void)
 {
-    LoadFromScheduler(m_recList);
     fillChannelInfos();
 
     int maxchannel = max((int)GetChannelCount() - 1, 0);
     setStartChannel((int)(m_currentStartChannel) - (int)(m_channelCount / 2));
     m_channelCount = min(m_channelCount, maxchannel + 1);
 
-    for (int y = 0; y < m_channelCount; ++y)
-    {
-        int chanNum = y + m_currentStartChannel;
-        if (chanNum >= (int) m_channelInfos.size())
-            chanNum -= (int) m_channelInfos.size();
-        if (chanNum >= (int) m_channelInfos.size())
-            continue;
-
-        if (chanNum < 0)
-            chanNum = 0;
-
-        delete m_programs[y];
-        m_programs[y] = getProgramListFromProgram(chanNum);
-    }
+    // Load the first page up front, everything else comes from the cache
+    m_guideCache->Load(GetPageChannels(m_currentStartChannel),
+                       m_currentStartTime, m_currentEndTime);
 }
 
 void GuideGrid::Init(void)
@@ -341,7 +616,7 @@ void GuideGrid::Init(void)
 
     updateChannels();
 
-    fillProgramInfos(true);
+    fillProgramInfos();
     updateInfo();
 
     m_updateTimer = new QTimer(this);
@@ -355,13 +630,17 @@ void GuideGrid::Init(void)
     if (m_changroupname)
         m_changroupname->SetText(changrpname);
 
-    gCoreContext->addListener(this);
+    gCoreContext->addListener(
+        this, QStringList() << "SCHEDULE_CHANGE" << "SYSTEM_EVENT");
 }
 
 GuideGrid::~GuideGrid()
 {
     gCoreContext->removeListener(this);
 
+    delete m_guideCache;
+    m_guideCache = NULL;
+
     while (!m_programs.empty())
     {
         if (m_programs.back())
@@ -1056,46 +1335,164 @@ void GuideGrid::fillTimeInfos()
     m_currentEndTime = starttime;
 }
 
-void GuideGrid::fillProgramInfos(bool useExistingData)
+void GuideGrid::fillProgramInfos(void)
 {
+    QTime timer;
+    timer.start();
+
     m_guideGrid->ResetData();
 
+    // every row is laid out from what the cache has now
+    m_loadedTiles.clear();
+    m_waitingRows.clear();
     for (int y = 0; y < m_channelCount; ++y)
     {
-        fillProgramRowInfos(y, useExistingData);
+        if (!fillProgramRowInfos(y))
+            m_waitingRows.insert(y);
     }
+
+    requestProgramInfos();
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Filled guide page in %1 ms, %2 of %3 rows cached")
+            .arg(timer.elapsed())
+            .arg(m_channelCount - m_waitingRows.size())
+            .arg(m_channelCount));
+
+    updatePageWaiting();
 }
 
-ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
+/** \fn GuideGrid::refillLoadedRows(void)
+ *  \brief Lays out again only the visible rows covered by the tiles
+ *         loaded in the last kLoadedTilesDelay ms.
+ */
+void GuideGrid::refillLoadedRows(void)
 {
-    ProgramList *proglist = new ProgramList();
+    QSet<quint64> loaded = m_loadedTiles;
+    m_loadedTiles.clear();
+
+    if (loaded.empty() || !m_guideGrid)
+        return;
+
+    uint first = GuideDataCache::TileIndex(m_currentStartTime);
+    uint last  = GuideDataCache::TileIndex(m_currentEndTime);
 
-    if (proglist)
+    bool refilled = false;
+    bool currentRow = false;
+    for (int y = 0; y < m_channelCount; ++y)
     {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.manualid = 0 ";
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] =
-            m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":ENDTS"] =
-            m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+        int chanNum = GetStartChannelOffset(y);
+        const DBChannel *chinfo = (chanNum < 0) ? NULL :
+            GetChannelInfo(chanNum);
+        if (!chinfo)
+            continue;
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
+        bool changed = false;
+        for (uint tile = first; tile <= last && !changed; ++tile)
+            changed = loaded.contains(
+                GuideDataCache::TileKey(chinfo->chanid, tile));
+
+        if (!changed)
+            continue;
+
+        if (fillProgramRowInfos(y))
+            m_waitingRows.remove(y);
+        else
+            m_waitingRows.insert(y);
+
+        refilled = true;
+        if (y == m_currentRow)
+            currentRow = true;
     }
 
-    return proglist;
+    if (!refilled)
+        return;
+
+    m_guideGrid->SetRedraw();
+    if (currentRow)
+        updateInfo();
+
+    updatePageWaiting();
+}
+
+/// Times how long the holes in a page take to fill in
+void GuideGrid::updatePageWaiting(void)
+{
+    if (!m_waitingRows.empty())
+    {
+        if (!m_pageWaiting)
+        {
+            m_pageWaiting = true;
+            m_pageTimer.start();
+        }
+    }
+    else if (m_pageWaiting)
+    {
+        m_pageWaiting = false;
+        LOG(VB_GUI, LOG_DEBUG, LOC +
+            QString("Guide page complete %1 ms after it was first shown")
+                .arg(m_pageTimer.elapsed()));
+    }
 }
 
-void GuideGrid::fillProgramRowInfos(unsigned int row, bool useExistingData)
+/** \fn GuideGrid::GetPageChannels(int) const
+ *  \brief Returns the channels shown on a page starting at startChannel.
+ */
+GuideChannelMap GuideGrid::GetPageChannels(int startChannel) const
+{
+    GuideChannelMap channels;
+
+    int count = (int) m_channelInfos.size();
+    if (!count)
+        return channels;
+
+    for (int y = 0; y < m_channelCount; ++y)
+    {
+        int chanNum = (startChannel + y) % count;
+        if (chanNum < 0)
+            chanNum += count;
+
+        const DBChannel *chinfo = GetChannelInfo(chanNum);
+        if (chinfo)
+            channels[chinfo->chanid] = chinfo->channum;
+    }
+
+    return channels;
+}
+
+/** \fn GuideGrid::requestProgramInfos(void)
+ *  \brief Asks the guide cache for the visible page, then for the pages
+ *         either side of it so paging finds them already loaded.
+ */
+void GuideGrid::requestProgramInfos(void)
+{
+    int span = m_currentStartTime.secsTo(m_currentEndTime);
+    GuideChannelMap page = GetPageChannels(m_currentStartChannel);
+
+    m_guideCache->Request(page, m_currentStartTime, m_currentEndTime);
+    m_guideCache->Request(page, m_currentEndTime,
+                          m_currentEndTime.addSecs(span));
+    m_guideCache->Request(page, m_currentStartTime.addSecs(-span),
+                          m_currentStartTime);
+    m_guideCache->Request(
+        GetPageChannels(m_currentStartChannel + m_channelCount),
+        m_currentStartTime, m_currentEndTime);
+    m_guideCache->Request(
+        GetPageChannels((int)m_currentStartChannel - m_channelCount),
+        m_currentStartTime, m_currentEndTime);
+}
+
+/** \fn GuideGrid::fillProgramRowInfos(unsigned int)
+ *  \brief Lays out a row from the guide cache.
+ *  \return false if some of the row's guide data is still being loaded.
+ */
+bool GuideGrid::fillProgramRowInfos(unsigned int row)
 {
     m_guideGrid->ResetRow(row);
 
     // never divide by zero..
     if (!m_guideGrid->getChannelCount() || !m_timeCount)
-        return;
+        return true;
 
     for (int x = 0; x < m_timeCount; ++x)
     {
@@ -1103,26 +1500,27 @@ void GuideGrid::fillProgramRowInfos(unsigned int row, bool useExistingData)
     }
 
     if (m_channelInfos.empty())
-        return;
+        return true;
 
     int chanNum = row + m_currentStartChannel;
     if (chanNum >= (int) m_channelInfos.size())
         chanNum -= (int) m_channelInfos.size();
     if (chanNum >= (int) m_channelInfos.size())
-        return;
+        return true;
 
     if (chanNum < 0)
         chanNum = 0;
 
-    if (!useExistingData)
-    {
-        delete m_programs[row];
-        m_programs[row] = getProgramListFromProgram(chanNum);
-    }
+    // The grid sets spread and startCol on each program, so every row
+    // works on its own copies of the cached programs.
+    delete m_programs[row];
+    ProgramList *proglist = m_programs[row] = new ProgramList();
 
-    ProgramList *proglist = m_programs[row];
-    if (!proglist)
-        return;
+    bool complete = m_guideCache->GetPrograms(
+        GetChannelInfo(chanNum)->chanid,
+        m_currentStartTime.addSecs(0 - m_currentStartTime.time().second()),
+        m_currentEndTime.addSecs(0 - m_currentEndTime.time().second()),
+        *proglist);
 
     QDateTime ts = m_currentStartTime;
 
@@ -1346,6 +1744,8 @@ void GuideGrid::fillProgramRowInfos(unsigned int row, bool useExistingData)
 
         lastprog = pginfo->GetScheduledStartTime();
     }
+
+    return complete;
 }
 
 void GuideGrid::customEvent(QEvent *event)
@@ -1355,12 +1755,24 @@ void GuideGrid::customEvent(QEvent *event)
         MythEvent *me = (MythEvent *)event;
         QString message = me->Message();
 
-        if (message == "SCHEDULE_CHANGE")
+        if (message == "SCHEDULE_CHANGE" ||
+            message.startsWith("SYSTEM_EVENT MYTHFILLDATABASE_RAN"))
         {
-            LoadFromScheduler(m_recList);
+            m_guideCache->Invalidate();
             fillProgramInfos();
             updateInfo();
         }
+        else if (message == "GUIDE_TILES_LOADED")
+        {
+            // gather the loads for a moment and refill the rows once
+            QStringList keys = me->ExtraDataList();
+            QStringList::const_iterator it = keys.begin();
+            for (; it != keys.end(); ++it)
+                m_loadedTiles.insert((*it).toULongLong());
+
+            if (!m_loadedTilesTimer->isActive())
+                m_loadedTilesTimer->start(kLoadedTilesDelay);
+        }
         else if (message == "STOP_VIDEO_REFRESH_TIMER")
         {
             m_previewVideoRefreshTimer->stop();
@@ -1662,7 +2074,6 @@ void GuideGrid::generateListings()
     maxchannel = max((int)GetChannelCount() - 1, 0);
     m_channelCount = min(m_guideGrid->getChannelCount(), maxchannel + 1);
 
-    LoadFromScheduler(m_recList);
     fillProgramInfos();
 }
 
@@ -1984,8 +2395,9 @@ void GuideGrid::quickRecord()
     ri.ToggleRecord();
     *pginfo = ri;
 
-    LoadFromScheduler(m_recList);
-    fillProgramInfos();
+    // The guide is redrawn once the new recording status has been loaded
+    m_guideCache->Invalidate();
+    requestProgramInfos();
     updateInfo();
 }
 
@@ -10,6 +10,14 @@ using namespace std;
 #include <QString>
 #include <QDateTime>
 #include <QEvent>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QTime>
+#include <QWaitCondition>
 
 // myth
 #include "mythscreentype.h"
@@ -34,6 +42,74 @@ class MythUIGuideGrid;
 typedef vector<DBChannel>   db_chan_list_t;
 typedef vector<db_chan_list_t> db_chan_list_list_t;
 
+/// Channels to load guide data for, chanid -> channum
+typedef QMap<uint, QString> GuideChannelMap;
+
+class GuideTileLoader;
+
+/** \class GuideDataCache
+ *  \brief Guide listings kept in (channel x time window) tiles.
+ *
+ *  Missing tiles are loaded in the background, with one query per time
+ *  window covering every requested channel. Once a load completes the
+ *  listener is sent a "GUIDE_TILES_LOADED" MythEvent, with the keys of the
+ *  tiles loaded as its extra data. Tiles are expired
+ *  in least recently used order and are marked stale by Invalidate(),
+ *  stale tiles are still returned until their replacement arrives.
+ */
+class GuideDataCache
+{
+    friend class GuideTileLoader;
+
+  public:
+    GuideDataCache(QObject *listener);
+   ~GuideDataCache();
+
+    bool GetPrograms(uint chanid, const QDateTime &start,
+                     const QDateTime &end, ProgramList &proglist);
+    void Request(const GuideChannelMap &channels,
+                 const QDateTime &start, const QDateTime &end);
+    void Load(const GuideChannelMap &channels,
+              const QDateTime &start, const QDateTime &end);
+    void Invalidate(void);
+
+    static quint64 TileKey(uint chanid, uint tile)
+        { return ((quint64)chanid << 32) | tile; }
+    static uint TileIndex(const QDateTime &dt)
+        { return dt.toTime_t() / kTileSecs; }
+
+    static const uint kTileSecs = 3 * 60 * 60;
+    static const int  kMaxTiles = 1024;
+
+  private:
+    class GuideTile
+    {
+      public:
+        GuideTile(uint generation) : m_generation(generation) {}
+        ProgramList m_programs;
+        uint        m_generation;
+    };
+
+    QStringList LoadTile(uint tile, const GuideChannelMap &channels,
+                         uint generation);
+    void LoaderDone(const QStringList &keys);
+
+    QObject               *m_listener;
+
+    QMutex                 m_lock;
+    QWaitCondition         m_loadersDone;
+    QHash<quint64, GuideTile*> m_tiles;
+    QList<quint64>         m_lru;     ///< most recently used first
+    QSet<quint64>          m_pending;
+    uint                   m_generation;
+    uint                   m_loaders;
+
+    /// Held while querying, so a schedule reload never races a query
+    QMutex                 m_schedLock;
+    ProgramList            m_schedList;
+    uint                   m_schedGeneration;
+};
+
 class JumpToChannel;
 class JumpToChannelListener
 {
@@ -145,6 +221,7 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     void updateInfo(void);
     void updateChannels(void);
     void updateJumpToChannel(void);
+    void refillLoadedRows(void);
 
   private:
 
@@ -174,9 +251,11 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
 
     void fillChannelInfos(bool gotostartchannel = true);
     void fillTimeInfos(void);
-    void fillProgramInfos(bool useExistingData = false);
-    void fillProgramRowInfos(unsigned int row, bool useExistingData = false);
-    ProgramList *getProgramListFromProgram(int chanNum);
+    void fillProgramInfos(void);
+    bool fillProgramRowInfos(unsigned int row);
+    void updatePageWaiting(void);
+    GuideChannelMap GetPageChannels(int startChannel) const;
+    void requestProgramInfos(void);
 
     void setStartChannel(int newStartChannel);
 
@@ -199,7 +278,14 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
 
     vector<ProgramList*> m_programs;
     ProgramInfo *m_programInfos[MAX_DISPLAY_CHANS][MAX_DISPLAY_TIMES];
-    ProgramList  m_recList;
+    GuideDataCache *m_guideCache;
+
+    QTime     m_pageTimer;
+    bool      m_pageWaiting;
+    QSet<int> m_waitingRows;      ///< rows still missing guide data
+
+    QSet<quint64> m_loadedTiles;  ///< loaded since the rows were refilled
+    QTimer   *m_loadedTilesTimer;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
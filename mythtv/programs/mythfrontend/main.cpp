@@ -16,6 +16,7 @@ using namespace std;
 #include <QWidget>
 #include <QApplication>
 #include <QTimer>
+#include <QRunnable>
 
 #include "previewgeneratorqueue.h"
 #include "referencecounter.h"
@@ -62,6 +63,8 @@ using namespace std;
 #include "lcddevice.h"
 #include "langsettings.h"
 #include "mythtranslation.h"
+#include "mythstartuptimer.h"
+#include "mthreadpool.h"
 #include "commandlineparser.h"
 #include "channelgroupsettings.h"
 
@@ -108,6 +111,11 @@ static MythThemedMenu *menu;
 static QString         logfile;
 static MediaRenderer  *g_pUPnp   = NULL;
 static MythPluginManager *pmanager = NULL;
+static MediaMonitor   *g_mediaMonitor = NULL;
+
+// Delay after entering the event loop before starting the parts of the
+// frontend that are not needed to show the main menu, in ms
+static const int kDeferredStartupDelay = 250;
 
 static void handleExit(bool prompt);
 static void resetAllKeys(void);
@@ -271,6 +279,87 @@ namespace
         SignalHandler::Done();
     }
 
+    class HardwareProfileTask : public QRunnable
+    {
+      public:
+        virtual void run(void)
+        {
+            MythStartupTimer timer("Hardware profile");
+
+            HardwareProfile profile;
+            if (profile.NeedsUpdate())
+                profile.SubmitProfile();
+        }
+    };
+
+    /// Starts the parts of the frontend that the main menu does not need,
+    /// so they do not delay it being shown.
+    class DeferredStartup : public QObject
+    {
+        Q_OBJECT
+
+      public:
+        static void Create(bool upnp, bool plugins)
+        {
+            new DeferredStartup(upnp, plugins);
+        }
+
+      private:
+        DeferredStartup(bool upnp, bool plugins) :
+            m_upnp(upnp), m_plugins(plugins)
+        {
+            QTimer::singleShot(kDeferredStartupDelay, this, SLOT(Run()));
+        }
+
+        ~DeferredStartup() {}
+
+      private slots:
+        void Run(void)
+        {
+            if (m_plugins && !pmanager)
+            {
+                MythStartupTimer timer("Plugins");
+                pmanager = new MythPluginManager();
+                gContext->SetPluginManager(pmanager);
+            }
+
+            if (m_upnp && !g_pUPnp)
+            {
+                MythStartupTimer timer("UPnP");
+                g_pUPnp = new MediaRenderer();
+                if (!g_pUPnp->initialized())
+                {
+                    delete g_pUPnp;
+                    g_pUPnp = NULL;
+                }
+            }
+
+            {
+                MythStartupTimer timer("Media monitor");
+                g_mediaMonitor = MediaMonitor::GetMediaMonitor();
+                if (g_mediaMonitor)
+                {
+                    g_mediaMonitor->StartMonitoring();
+                    GetMythMainWindow()->installEventFilter(g_mediaMonitor);
+                }
+            }
+
+#ifdef __linux__
+#ifdef CONFIG_BINDINGS_PYTHON
+            // Submitting the profile runs an external script
+            MThreadPool::globalInstance()->start(
+                new HardwareProfileTask(), "HardwareProfile");
+#endif
+#endif
+
+            deleteLater();
+        }
+
+      private:
+        bool m_upnp;
+        bool m_plugins;
+    };
+
     class CleanupGuard
     {
       public:
@@ -1279,6 +1368,15 @@ static void setDebugShowNames(void)
         GetMythMainWindow()->GetMainStack()->GetTopScreen()->SetRedraw();
 }
 
+static void setDebugShowCacheStats(void)
+{
+    MythPainter *p = GetMythPainter();
+    p->SetShowCacheStats(!p->ShowCacheStats());
+
+    if (GetMythMainWindow()->GetMainStack()->GetTopScreen())
+        GetMythMainWindow()->GetMainStack()->GetTopScreen()->SetRedraw();
+}
+
 static void InitJumpPoints(void)
 {
      REG_JUMP(QT_TRANSLATE_NOOP("MythControls", "Reload Theme"),
@@ -1334,6 +1432,9 @@ static void InitJumpPoints(void)
          "", "", setDebugShowBorders, false);
      REG_JUMPEX(QT_TRANSLATE_NOOP("MythControls", "Toggle Show Widget Names"),
          "", "", setDebugShowNames, false);
+     REG_JUMPEX(QT_TRANSLATE_NOOP("MythControls",
+         "Toggle Show Image Cache Statistics"),
+         "", "", setDebugShowCacheStats, false);
      REG_JUMPEX(QT_TRANSLATE_NOOP("MythControls", "Reset All Keys"),
          QT_TRANSLATE_NOOP("MythControls", "Reset all keys to defaults"),
          "", resetAllKeys, false);
@@ -1465,6 +1566,8 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_OK;
     }
 
+    MythStartupTimer::Enable(cmdline.toBool("startuptrace"));
+
     CleanupGuard callCleanup(cleanup);
 
 #ifdef Q_WS_MACX
@@ -1489,6 +1592,8 @@ int main(int argc, char **argv)
     if ((retval = cmdline.ConfigureLogging()) != GENERIC_EXIT_OK)
         return retval;
 
+    MythStartupTimer::Mark("Application and logging");
+
     bool ResetSettings = false;
 
     if (cmdline.toBool("prompt"))
@@ -1519,6 +1624,8 @@ int main(int argc, char **argv)
 
     cmdline.ApplySettingsOverride();
 
+    MythStartupTimer::Mark("MythContext");
+
     if (!GetMythDB()->HaveSchema())
     {
         if (!InitializeMythSchema())
@@ -1528,16 +1635,6 @@ int main(int argc, char **argv)
     if (cmdline.toBool("reset"))
         ResetSettings = true;
 
-    if (!cmdline.toBool("noupnp"))
-    {
-        g_pUPnp  = new MediaRenderer();
-        if (!g_pUPnp->initialized())
-        {
-            delete g_pUPnp;
-            g_pUPnp = NULL;
-        }
-    }
-
     QString fileprefix = GetConfDir();
 
     QDir dir(fileprefix);
@@ -1588,6 +1685,8 @@ int main(int argc, char **argv)
     if (LCD *lcd = LCD::Get())
         lcd->setupLEDs(RemoteGetRecordingMask);
 
+    MythStartupTimer::Mark("Network services and LCD");
+
     MythTranslation::load("mythfrontend");
 
     QString themename = gCoreContext->GetSetting("Theme", DEFAULT_UI_THEME);
@@ -1619,6 +1718,8 @@ int main(int argc, char **argv)
 #endif
     mainWindow->setWindowTitle(QObject::tr("MythTV Frontend"));
 
+    MythStartupTimer::Mark("Theme settings and main window");
+
     // We must reload the translation after a language change and this
     // also means clearing the cached/loaded theme strings, so reload the
     // theme which also triggers a translation reload
@@ -1635,6 +1736,8 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_DB_OUTOFDATE;
     }
 
+    MythStartupTimer::Mark("Schema check");
+
     WriteDefaults();
 
     // Refresh Global/Main Menu keys after DB update in case there was no DB
@@ -1652,14 +1755,17 @@ int main(int argc, char **argv)
 
     setHttpProxy();
 
-    pmanager = new MythPluginManager();
-    gContext->SetPluginManager(pmanager);
+    MythStartupTimer::Mark("Keys, jump points and defaults");
 
-    MediaMonitor *mon = MediaMonitor::GetMediaMonitor();
-    if (mon)
+    // Plugins are only needed before the menu is shown when starting in
+    // one of them or at one of their jump points.
+    bool deferPlugins = !cmdline.toBool("runplugin") &&
+                        !cmdline.toBool("jumppoint");
+    if (!deferPlugins)
     {
-        mon->StartMonitoring();
-        mainWindow->installEventFilter(mon);
+        pmanager = new MythPluginManager();
+        gContext->SetPluginManager(pmanager);
+        MythStartupTimer::Mark("Plugins");
     }
 
     NetworkControl *networkControl = NULL;
@@ -1673,20 +1779,15 @@ int main(int argc, char **argv)
                    .arg(port));
     }
 
-#ifdef __linux__
-#ifdef CONFIG_BINDINGS_PYTHON
-    HardwareProfile *profile = new HardwareProfile();
-    if (profile && profile->NeedsUpdate())
-        profile->SubmitProfile();
-    delete profile;
-#endif
-#endif
-
     if (!RunMenu(themedir, themename) && !resetTheme(themedir, themename))
     {
         return GENERIC_EXIT_NO_THEME;
     }
 
+    MythStartupTimer::Mark("Main menu");
+
+    DeferredStartup::Create(!cmdline.toBool("noupnp"), deferPlugins);
+
     ThemeUpdateChecker *themeUpdateChecker = NULL;
     if (gCoreContext->GetNumSetting("ThemeUpdateNofications", 1))
         themeUpdateChecker = new ThemeUpdateChecker();
@@ -1735,6 +1836,8 @@ int main(int argc, char **argv)
         }
     }
 
+    MythStartupTimer::Mark("Ready");
+
     int ret = qApp->exec();
 
     PreviewGeneratorQueue::TeardownPreviewGeneratorQueue();
@@ -1744,10 +1847,11 @@ int main(int argc, char **argv)
 
     delete sysEventHandler;
 
-    pmanager->DestroyAllPlugins();
+    if (pmanager)
+        pmanager->DestroyAllPlugins();
 
-    if (mon)
-        mon->deleteLater();
+    if (g_mediaMonitor)
+        g_mediaMonitor->deleteLater();
 
     delete networkControl;
 
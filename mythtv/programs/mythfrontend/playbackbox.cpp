@@ -7,6 +7,7 @@
 #include <QDateTime>
 #include <QLocale>
 #include <QTimer>
+#include <QTime>
 #include <QMap>
 
 // MythTV
@@ -198,6 +199,49 @@ static bool comp_season_rev_less_than(
     return comp_season_rev(a, b) < 0;
 }
 
+/// Order of the "All Programs" list, which is built from the cache order
+static bool comp_recstartts_less_than(
+    const ProgramInfo *a, const ProgramInfo *b)
+{
+    if (a->GetRecordingStartTime() == b->GetRecordingStartTime())
+        return a->GetChanID() < b->GetChanID();
+    return a->GetRecordingStartTime() < b->GetRecordingStartTime();
+}
+
+static bool comp_recstartts_rev_less_than(
+    const ProgramInfo *a, const ProgramInfo *b)
+{
+    return comp_recstartts_less_than(b, a);
+}
+
+typedef bool (*ProgramCompare)(const ProgramInfo*, const ProgramInfo*);
+
+static ProgramCompare get_episode_comparator(
+    const QString &episodeSort, bool reverse)
+{
+    if (episodeSort == "OrigAirDate")
+    {
+        return reverse ? comp_originalAirDate_rev_less_than :
+                         comp_originalAirDate_less_than;
+    }
+    if (episodeSort == "Id")
+    {
+        return reverse ? comp_programid_rev_less_than :
+                         comp_programid_less_than;
+    }
+    if (episodeSort == "Date")
+    {
+        return reverse ? comp_recordDate_rev_less_than :
+                         comp_recordDate_less_than;
+    }
+    if (episodeSort == "Season")
+    {
+        return reverse ? comp_season_rev_less_than :
+                         comp_season_less_than;
+    }
+    return NULL;
+}
+
 static const uint s_artDelay[] =
     { kArtworkFanTimeout, kArtworkBannerTimeout, kArtworkCoverTimeout,};
 
@@ -1557,6 +1601,9 @@ static void restore_position(
 
 bool PlaybackBox::UpdateUILists(void)
 {
+    QTime timer;
+    timer.start();
+
     m_isFilling = true;
 
     // Save selection, including next few items & groups
@@ -1600,16 +1647,15 @@ bool PlaybackBox::UpdateUILists(void)
     ViewTitleSort titleSort = (ViewTitleSort)gCoreContext->GetNumSetting(
                                 "DisplayGroupTitleSort", TitleSortAlphabetical);
 
-    QMap<QString, QString> sortedList;
-    QMap<int, QString> searchRule;
     QMap<int, int> recidEpisodes;
 
+    m_groupTitles.clear();
+    m_searchRules.clear();
+
     m_programInfoCache.Refresh();
 
     if (!m_programInfoCache.empty())
     {
-        QString sTitle;
-
         if ((m_viewMask & VIEW_SEARCHES))
         {
             MSqlQuery query(MSqlQuery::InitCon());
@@ -1623,7 +1669,7 @@ bool PlaybackBox::UpdateUILists(void)
                 {
                     QString tmpTitle = query.value(1).toString();
                     tmpTitle.remove(m_titleChaff);
-                    searchRule[query.value(0).toInt()] = tmpTitle;
+                    m_searchRules[query.value(0).toInt()] = tmpTitle;
                 }
             }
         }
@@ -1643,91 +1689,23 @@ bool PlaybackBox::UpdateUILists(void)
             if (p->GetTitle().isEmpty())
                 p->SetTitle(tr("_NO_TITLE_"));
 
-            if ((((p->GetRecordingGroup() == m_recGroup) ||
-                  ((m_recGroup == "All Programs") &&
-                   (p->GetRecordingGroup() != "Deleted") &&
-                   (p->GetRecordingGroup() != "LiveTV")) ||
-                  (p->GetRecordingGroup() == "LiveTV" &&
-                   (m_viewMask & VIEW_LIVETVGRP))) &&
-                 (m_recGroupPwCache[m_recGroup] == m_curGroupPassword)) ||
-                ((m_recGroupType[m_recGroup] == "category") &&
-                 ((p->GetCategory() == m_recGroup ) ||
-                  ((p->GetCategory().isEmpty()) &&
-                   (m_recGroup == tr("Unknown")))) &&
-                 ( !m_recGroupPwCache.contains(p->GetRecordingGroup()))))
+            if (IsInRecGroupView(p))
             {
                 if ((!(m_viewMask & VIEW_WATCHED)) && p->IsWatched())
                     continue;
 
-                if (m_viewMask != VIEW_NONE &&
-                    (p->GetRecordingGroup() != "LiveTV" ||
-                     m_recGroup == "LiveTV"))
-                {
-                    m_progLists[""].push_front(p);
-                }
-
                 asKey = p->MakeUniqueKey();
                 if (asCache.contains(asKey))
                     p->SetAvailableStatus(asCache[asKey], "UpdateUILists");
                 else
                     p->SetAvailableStatus(asAvailable,  "UpdateUILists");
 
-                if (m_recGroup != "LiveTV" &&
-                    (p->GetRecordingGroup() == "LiveTV") &&
-                    (m_viewMask & VIEW_LIVETVGRP))
-                {
-                    QString tmpTitle = tr("Live TV");
-                    sortedList[tmpTitle.toLower()] = tmpTitle;
-                    m_progLists[tmpTitle.toLower()].push_front(p);
-                    m_progLists[tmpTitle.toLower()].setAutoDelete(false);
-                    continue;
-                }
-
-                if ((m_viewMask & VIEW_TITLES) && // Show titles
-                    ((p->GetRecordingGroup() != "LiveTV") ||
-                     (m_recGroup == "LiveTV")))
+                QStringList groups = GetGroupKeys(p, titleSort);
+                QStringList::const_iterator git = groups.begin();
+                for (; git != groups.end(); ++git)
                 {
-                    sTitle = construct_sort_title(
-                        p->GetTitle(), m_viewMask, titleSort,
-                        p->GetRecordingPriority(), m_prefixes);
-                    sTitle = sTitle.toLower().simplified();
-
-                    if (!sortedList.contains(sTitle))
-                        sortedList[sTitle] = p->GetTitle();
-                    m_progLists[sortedList[sTitle].toLower()].push_front(p);
-                    m_progLists[sortedList[sTitle].toLower()].setAutoDelete(false);
-                }
-
-                if ((m_viewMask & VIEW_RECGROUPS) &&
-                    !p->GetRecordingGroup().isEmpty() &&
-                    p->GetRecordingGroup() != "LiveTV") // Show recording groups
-                {
-                    sortedList[p->GetRecordingGroup().toLower()] =
-                        p->GetRecordingGroup();
-                    m_progLists[p->GetRecordingGroup().toLower()]
-                        .push_front(p);
-                    m_progLists[p->GetRecordingGroup().toLower()]
-                        .setAutoDelete(false);
-                }
-
-                if ((m_viewMask & VIEW_CATEGORIES) &&
-                    !p->GetCategory().isEmpty()) // Show categories
-                {
-                    QString catl = p->GetCategory().toLower();
-                    sortedList[catl] = p->GetCategory();
-                    m_progLists[catl].push_front(p);
-                    m_progLists[catl].setAutoDelete(false);
-                }
-
-                if ((m_viewMask & VIEW_SEARCHES) &&
-                    !searchRule[p->GetRecordingRuleID()].isEmpty() &&
-                    p->GetTitle() != searchRule[p->GetRecordingRuleID()])
-                {   // Show search rules
-                    QString tmpTitle = QString("(%1)")
-                        .arg(searchRule[p->GetRecordingRuleID()]);
-                    sortedList[tmpTitle.toLower()] = tmpTitle;
-                    m_progLists[tmpTitle.toLower()].push_front(p);
-                    m_progLists[tmpTitle.toLower()].setAutoDelete(false);
+                    m_progLists[*git].push_front(p);
+                    m_progLists[*git].setAutoDelete(false);
                 }
 
                 if ((m_viewMask & VIEW_WATCHLIST) &&
@@ -1770,7 +1748,7 @@ bool PlaybackBox::UpdateUILists(void)
         }
     }
 
-    if (sortedList.empty())
+    if (m_groupTitles.empty())
     {
         LOG(VB_GENERAL, LOG_WARNING, LOC + "SortedList is Empty");
         m_progLists[""];
@@ -1781,62 +1759,17 @@ bool PlaybackBox::UpdateUILists(void)
         return false;
     }
 
-    QString episodeSort = gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date");
+    ProgramCompare episodeComp = get_episode_comparator(
+        gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date"),
+        m_listOrder == 0 || m_type == kDeleteBox);
 
-    if (episodeSort == "OrigAirDate")
+    if (episodeComp)
     {
-        QMap<QString, ProgramList>::Iterator Iprog;
-        for (Iprog = m_progLists.begin(); Iprog != m_progLists.end(); ++Iprog)
-        {
-            if (!Iprog.key().isEmpty())
-            {
-                std::stable_sort((*Iprog).begin(), (*Iprog).end(),
-                                 (m_listOrder == 0 || m_type == kDeleteBox) ?
-                                 comp_originalAirDate_rev_less_than :
-                                 comp_originalAirDate_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Id")
-    {
-        QMap<QString, ProgramList>::Iterator Iprog;
-        for (Iprog = m_progLists.begin(); Iprog != m_progLists.end(); ++Iprog)
-        {
-            if (!Iprog.key().isEmpty())
-            {
-                std::stable_sort((*Iprog).begin(), (*Iprog).end(),
-                                 (m_listOrder == 0 || m_type == kDeleteBox) ?
-                                 comp_programid_rev_less_than :
-                                 comp_programid_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Date")
-    {
-        QMap<QString, ProgramList>::iterator it;
+        ProgramMap::iterator it;
         for (it = m_progLists.begin(); it != m_progLists.end(); ++it)
         {
             if (!it.key().isEmpty())
-            {
-                std::stable_sort((*it).begin(), (*it).end(),
-                                 (!m_listOrder || m_type == kDeleteBox) ?
-                                 comp_recordDate_rev_less_than :
-                                 comp_recordDate_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Season")
-    {
-        QMap<QString, ProgramList>::iterator it;
-        for (it = m_progLists.begin(); it != m_progLists.end(); ++it)
-        {
-            if (!it.key().isEmpty())
-            {
-                std::stable_sort((*it).begin(), (*it).end(),
-                                 (!m_listOrder || m_type == kDeleteBox) ?
-                                 comp_season_rev_less_than :
-                                 comp_season_less_than);
-            }
+                std::stable_sort((*it).begin(), (*it).end(), episodeComp);
         }
     }
 
@@ -2086,9 +2019,9 @@ bool PlaybackBox::UpdateUILists(void)
     if (m_progLists[m_watchGroupLabel].size() > 0)
         m_titleList << m_watchGroupName;
     if ((m_progLists["livetv"].size() > 0) &&
-        (!sortedList.values().contains(tr("Live TV"))))
+        (!m_groupTitles.values().contains(tr("Live TV"))))
         m_titleList << tr("Live TV");
-    m_titleList << sortedList.values();
+    m_titleList << m_groupTitles.values();
 
     // Populate list of recording groups
     if (!m_programInfoCache.empty())
@@ -2144,6 +2077,202 @@ bool PlaybackBox::UpdateUILists(void)
 
     m_isFilling = false;
 
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Rebuilt %1 groups from %2 recordings in %3 ms")
+            .arg(m_titleList.size()).arg(m_progsInDB).arg(timer.elapsed()));
+
+    return true;
+}
+
+/** \brief Returns true if the recording is shown in the currently
+ *         selected recording group or category.
+ */
+bool PlaybackBox::IsInRecGroupView(const ProgramInfo *p)
+{
+    return ((((p->GetRecordingGroup() == m_recGroup) ||
+              ((m_recGroup == "All Programs") &&
+               (p->GetRecordingGroup() != "Deleted") &&
+               (p->GetRecordingGroup() != "LiveTV")) ||
+              (p->GetRecordingGroup() == "LiveTV" &&
+               (m_viewMask & VIEW_LIVETVGRP))) &&
+             (m_recGroupPwCache[m_recGroup] == m_curGroupPassword)) ||
+            ((m_recGroupType[m_recGroup] == "category") &&
+             ((p->GetCategory() == m_recGroup ) ||
+              ((p->GetCategory().isEmpty()) &&
+               (m_recGroup == tr("Unknown")))) &&
+             ( !m_recGroupPwCache.contains(p->GetRecordingGroup()))));
+}
+
+/** \brief Returns the keys of the m_progLists groups a recording in the
+ *         current view belongs to, other than the Watch List.
+ *
+ *  The display names of any groups seen for the first time are added
+ *  to m_groupTitles.
+ */
+QStringList PlaybackBox::GetGroupKeys(const ProgramInfo *p,
+                                      ViewTitleSort titleSort)
+{
+    QStringList groups;
+
+    if (m_viewMask != VIEW_NONE &&
+        (p->GetRecordingGroup() != "LiveTV" || m_recGroup == "LiveTV"))
+    {
+        groups << "";
+    }
+
+    if (m_recGroup != "LiveTV" &&
+        (p->GetRecordingGroup() == "LiveTV") &&
+        (m_viewMask & VIEW_LIVETVGRP))
+    {
+        QString tmpTitle = tr("Live TV");
+        m_groupTitles[tmpTitle.toLower()] = tmpTitle;
+        groups << tmpTitle.toLower();
+        return groups;
+    }
+
+    if ((m_viewMask & VIEW_TITLES) && // Show titles
+        ((p->GetRecordingGroup() != "LiveTV") || (m_recGroup == "LiveTV")))
+    {
+        QString sTitle = construct_sort_title(
+            p->GetTitle(), m_viewMask, titleSort,
+            p->GetRecordingPriority(), m_prefixes);
+        sTitle = sTitle.toLower().simplified();
+
+        if (!m_groupTitles.contains(sTitle))
+            m_groupTitles[sTitle] = p->GetTitle();
+        groups << m_groupTitles[sTitle].toLower();
+    }
+
+    if ((m_viewMask & VIEW_RECGROUPS) &&
+        !p->GetRecordingGroup().isEmpty() &&
+        p->GetRecordingGroup() != "LiveTV") // Show recording groups
+    {
+        m_groupTitles[p->GetRecordingGroup().toLower()] =
+            p->GetRecordingGroup();
+        groups << p->GetRecordingGroup().toLower();
+    }
+
+    if ((m_viewMask & VIEW_CATEGORIES) &&
+        !p->GetCategory().isEmpty()) // Show categories
+    {
+        QString catl = p->GetCategory().toLower();
+        m_groupTitles[catl] = p->GetCategory();
+        groups << catl;
+    }
+
+    QString rule = m_searchRules.value(p->GetRecordingRuleID());
+    if ((m_viewMask & VIEW_SEARCHES) &&
+        !rule.isEmpty() && p->GetTitle() != rule)
+    {   // Show search rules
+        QString tmpTitle = QString("(%1)").arg(rule);
+        m_groupTitles[tmpTitle.toLower()] = tmpTitle;
+        groups << tmpTitle.toLower();
+    }
+
+    return groups;
+}
+
+/** \brief Inserts one recording into the already sorted group lists,
+ *         and into the recording list if its group is on screen.
+ *
+ *  This avoids rebuilding and resorting every group when a single
+ *  recording is added or moved.
+ *
+ *  \return false if the recording would create a new group or change
+ *          the Watch List, in which case UpdateUILists() must be used.
+ */
+bool PlaybackBox::InsertIntoUILists(ProgramInfo *p)
+{
+    if (m_isFilling || m_progLists.isEmpty() || m_titleList.size() <= 1)
+        return false;
+
+    QTime timer;
+    timer.start();
+
+    if (p->GetTitle().isEmpty())
+        p->SetTitle(tr("_NO_TITLE_"));
+
+    if (p->IsDeletePending() || !IsInRecGroupView(p) ||
+        ((!(m_viewMask & VIEW_WATCHED)) && p->IsWatched()))
+    {
+        return true;
+    }
+
+    // Watch List scores depend on the other episodes of the recording
+    // rule, so any change to it needs a full rebuild.
+    if ((m_viewMask & VIEW_WATCHLIST) &&
+        p->GetRecordingGroup() != "LiveTV" &&
+        p->GetRecordingGroup() != "Deleted")
+    {
+        return false;
+    }
+
+    ViewTitleSort titleSort = (ViewTitleSort)gCoreContext->GetNumSetting(
+                                "DisplayGroupTitleSort", TitleSortAlphabetical);
+    QStringList groups = GetGroupKeys(p, titleSort);
+
+    QStringList::const_iterator it = groups.begin();
+    for (; it != groups.end(); ++it)
+    {
+        if (!m_progLists.contains(*it))
+            return false;
+    }
+
+    ProgramCompare allComp = ((0 == m_allOrder) || (kDeleteBox == m_type)) ?
+        comp_recstartts_less_than : comp_recstartts_rev_less_than;
+    ProgramCompare episodeComp = get_episode_comparator(
+        gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date"),
+        m_listOrder == 0 || m_type == kDeleteBox);
+    if (!episodeComp)
+        episodeComp = allComp;
+
+    p->SetAvailableStatus(asAvailable, "InsertIntoUILists");
+
+    MythUIButtonListItem *sel_item = m_groupList->GetItemCurrent();
+    QString groupname;
+    if (sel_item)
+        groupname = sel_item->GetData().toString();
+
+    for (it = groups.begin(); it != groups.end(); ++it)
+    {
+        ProgramList &progList = m_progLists[*it];
+        ProgramList::iterator pos = std::upper_bound(
+            progList.begin(), progList.end(), p,
+            it->isEmpty() ? allComp : episodeComp);
+
+        // Items pending deletion are not shown, so count the visible
+        // items in front of the insertion point.
+        int listPos = 0;
+        ProgramList::iterator pit = progList.begin();
+        for (; pit != pos; ++pit)
+        {
+            if ((*pit)->GetAvailableStatus() != asPendingDelete &&
+                (*pit)->GetAvailableStatus() != asDeleted)
+                listPos++;
+        }
+
+        progList.insert(pos, p);
+
+        if (*it == groupname)
+        {
+            new PlaybackBoxListItem(this, m_recordingList, p, listPos);
+            if (m_noRecordingsText)
+                m_noRecordingsText->SetVisible(false);
+        }
+
+        MythUIButtonListItem *group_item =
+            m_groupList->GetItemByData(qVariantFromValue(*it));
+        if (group_item)
+        {
+            group_item->SetText(QString::number(progList.size()),
+                                "reccount");
+        }
+    }
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Inserted '%1' into %2 groups in %3 ms")
+            .arg(p->GetTitle()).arg(groups.size()).arg(timer.elapsed()));
+
     return true;
 }
 
@@ -4202,6 +4331,16 @@ void PlaybackBox::HandleRecordingRemoveEvent(
         return;
     }
 
+    RemoveFromUILists(chanid, recstartts);
+
+    m_helper.ForceFreeSpaceUpdate();
+}
+
+/** \brief Removes a recording from every group list, and from the
+ *         recording list if its group is on screen.
+ */
+void PlaybackBox::RemoveFromUILists(uint chanid, const QDateTime &recstartts)
+{
     MythUIButtonListItem *sel_item = m_groupList->GetItemCurrent();
     QString groupname;
     if (sel_item)
@@ -4265,14 +4404,30 @@ void PlaybackBox::HandleRecordingRemoveEvent(
             ++git;
         }
     }
-
-    m_helper.ForceFreeSpaceUpdate();
 }
 
 void PlaybackBox::HandleRecordingAddEvent(const ProgramInfo &evinfo)
 {
+    ProgramInfo *dst = FindProgramInUILists(evinfo);
+
     m_programInfoCache.Add(evinfo);
-    ScheduleUpdateUIList();
+
+    if (dst)
+    {
+        UpdateUIListItem(dst, true);
+        return;
+    }
+
+    ProgramInfo *pginfo = m_programInfoCache.GetProgramInfo(
+        evinfo.GetChanID(), evinfo.GetRecordingStartTime());
+
+    if (!pginfo || m_programInfoCache.IsLoadInProgress())
+        return;
+
+    m_progsInDB++;
+
+    if (!InsertIntoUILists(pginfo))
+        ScheduleUpdateUIList();
 }
 
 void PlaybackBox::HandleUpdateProgramInfoEvent(const ProgramInfo &evinfo)
@@ -4283,8 +4438,8 @@ void PlaybackBox::HandleUpdateProgramInfoEvent(const ProgramInfo &evinfo)
     if (!m_programInfoCache.Update(evinfo))
         return;
 
-    // If the recording group has changed, reload lists from the recently
-    // updated cache; if not, only update UI for the updated item
+    // If the recording group has changed, move the item to the groups
+    // for its new recording group; if not, only update UI for the item
     if (evinfo.GetRecordingGroup() == old_recgroup)
     {
         ProgramInfo *dst = FindProgramInUILists(evinfo);
@@ -4293,7 +4448,16 @@ void PlaybackBox::HandleUpdateProgramInfoEvent(const ProgramInfo &evinfo)
         return;
     }
 
-    ScheduleUpdateUIList();
+    ProgramInfo *pginfo = m_programInfoCache.GetProgramInfo(
+        evinfo.GetChanID(), evinfo.GetRecordingStartTime());
+
+    if (!pginfo)
+        return;
+
+    RemoveFromUILists(evinfo.GetChanID(), evinfo.GetRecordingStartTime());
+
+    if (!InsertIntoUILists(pginfo))
+        ScheduleUpdateUIList();
 }
 
 void PlaybackBox::HandleUpdateProgramInfoFileSizeEvent(
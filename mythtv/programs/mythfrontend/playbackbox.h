@@ -268,6 +268,10 @@ class PlaybackBox : public ScheduleCommon
 
   private:
     bool UpdateUILists(void);
+    bool IsInRecGroupView(const ProgramInfo *p);
+    QStringList GetGroupKeys(const ProgramInfo *p, ViewTitleSort titleSort);
+    bool InsertIntoUILists(ProgramInfo *p);
+    void RemoveFromUILists(uint chanid, const QDateTime &recstartts);
     void UpdateUIGroupList(const QStringList &groupPreferences);
     void UpdateUIRecGroupList(void);
 
@@ -403,6 +407,10 @@ class PlaybackBox : public ScheduleCommon
     // Main Recording List support
     QStringList         m_titleList;  ///< list of pages
     ProgramMap          m_progLists;  ///< lists of programs by page
+    /// group display names by sort key
+    QMap<QString,QString> m_groupTitles;
+    /// search rule titles by recording rule id
+    QMap<int,QString>   m_searchRules;
     int                 m_progsInDB;  ///< total number of recordings in DB
     bool                m_isFilling;
 
@@ -102,7 +102,7 @@ void ProgFinder::Init(void)
 
     initAlphabetList();
 
-    gCoreContext->addListener(this);
+    gCoreContext->addListener(this, QStringList("SCHEDULE_CHANGE"));
 
     connect(m_timesList, SIGNAL(itemSelected(MythUIButtonListItem*)),
             SLOT(updateInfo()));
@@ -179,7 +179,8 @@ bool ProgLister::Create()
     if (m_schedText)
         m_schedText->SetText(value);
 
-    gCoreContext->addListener(this);
+    gCoreContext->addListener(
+        this, QStringList() << "SCHEDULE_CHANGE" << "CHOOSE_VIEW");
 
     LoadInBackground();
 
@@ -992,6 +992,16 @@ bool VideoDialog::Create()
     UIUtilW::Assign(this, m_banner, "banner");
     UIUtilW::Assign(this, m_fanart, "fanart");
 
+    // have new artwork scaled to fit while it is being downloaded
+    if (m_coverImage)
+        m_metadataFactory->SetDisplaySize(kArtworkCoverart,
+                                          m_coverImage->GetForceSize(),
+                                          m_coverImage->GetPreserveAspect());
+    if (m_banner)
+        m_metadataFactory->SetDisplaySize(kArtworkBanner,
+                                          m_banner->GetForceSize(),
+                                          m_banner->GetPreserveAspect());
+
     UIUtilW::Assign(this, m_trailerState, "trailerstate");
     UIUtilW::Assign(this, m_parentalLevelState, "parentallevel");
     UIUtilW::Assign(this, m_watchedState, "watchedstate");
@@ -49,7 +49,7 @@ ViewScheduled::ViewScheduled(MythScreenStack *parent, TV* player, bool showTV)
     m_defaultGroup = QDate();
     m_currentGroup = m_defaultGroup;
 
-    gCoreContext->addListener(this);
+    gCoreContext->addListener(this, QStringList("SCHEDULE_CHANGE"));
 }
 
 ViewScheduled::~ViewScheduled()